@@ -11,17 +11,26 @@
 #include "movement/movement.h"
 #include "kz/kz.h"
 #include "kz/db/kz_db.h"
+#include "kz/beam/kz_beam.h"
 #include "kz/hud/kz_hud.h"
 #include "kz/mode/kz_mode.h"
 #include "kz/spec/kz_spec.h"
 #include "kz/goto/kz_goto.h"
 #include "kz/style/kz_style.h"
 #include "kz/quiet/kz_quiet.h"
+#include "kz/racing/kz_racing.h"
+#include "kz/saveloc/kz_saveloc.h"
+#include "kz/telemetry/kz_telemetry.h"
 #include "kz/tip/kz_tip.h"
 #include "kz/option/kz_option.h"
+#include "kz/profiler/kz_profiler.h"
 #include "kz/language/kz_language.h"
 #include "kz/mappingapi/kz_mappingapi.h"
 #include "kz/global/kz_global.h"
+#include "kz/jumpstats/kz_jumpstats.h"
+#include "kz/jumpstats/jump_export.h"
+#include "kz/anticheat/strafe_analysis.h"
+#include "kz/watchdog/kz_watchdog.h"
 
 #include "version.h"
 
@@ -51,7 +60,9 @@ bool KZPlugin::Load(PluginId id, ISmmAPI *ismm, char *error, size_t maxlen, bool
 	movement::InitDetours();
 	KZCheckpointService::Init();
 	KZTimerService::Init();
+	KZJumpstatsService::InitLeaderboards();
 	KZSpecService::Init();
+	KZRacingService::Init();
 	KZGotoService::Init();
 	KZHUDService::Init();
 	KZLanguageService::Init();
@@ -70,7 +81,12 @@ bool KZPlugin::Load(PluginId id, ISmmAPI *ismm, char *error, size_t maxlen, bool
 	KZ::mode::DisableReplicatedModeCvars();
 
 	KZOptionService::InitOptions();
+	KZSavelocService::Init();
+	KZTelemetryService::Init();
 	KZTipService::Init();
+	KZ::watchdog::Init();
+	KZ::jumpexport::Init();
+	KZ::strafeanalysis::Init();
 	if (late)
 	{
 		g_steamAPI.Init();
@@ -91,8 +107,16 @@ bool KZPlugin::Unload(char *error, size_t maxlen)
 	g_pKZModeManager->Cleanup();
 	g_pKZStyleManager->Cleanup();
 	g_pPlayerManager->Cleanup();
+	KZBeamService::Cleanup();
+	KZOptionService::FlushPrefs(true);
+	KZSavelocService::Cleanup();
 	KZDatabaseService::Cleanup();
 	KZGlobalService::Cleanup();
+	KZ::jumpexport::Cleanup();
+	movement::tracerecorder::Cleanup();
+	KZTelemetryService::Cleanup();
+	KZ::strafeanalysis::Cleanup();
+	KZ::profiler::Cleanup();
 	ConVar_Unregister();
 	return true;
 }
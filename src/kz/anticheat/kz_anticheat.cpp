@@ -1,6 +1,9 @@
+#include <cfloat>
+
 #include "../kz.h"
 #include "kz_anticheat.h"
 #include "kz/language/kz_language.h"
+#include "kz/option/kz_option.h"
 #include "kz/timer/kz_timer.h"
 #include "utils/ctimer.h"
 
@@ -11,8 +14,75 @@ extern IClientCvarValue *g_pClientCvarValue;
 #define INTEGRITY_CHECK_MIN_INTERVAL 1.0f
 #define INTEGRITY_CHECK_MAX_INTERVAL 5.0f
 #define KICK_DELAY                   5.0f
-#define MINIMUM_FPS_MAX              64.0f
-#define MAXIMUM_M_YAW                0.3f
+// Cvar queries issued per server tick across all players.
+#define CVAR_QUERIES_PER_TICK        4
+#define CVAR_MAX_PENDING_QUERIES     128
+// Seconds before an unanswered query is dropped so the player gets checked again.
+#define CVAR_QUERY_TIMEOUT           10.0
+
+struct CvarRule
+{
+	CUtlString name;
+	f64 min = -DBL_MAX;
+	f64 max = DBL_MAX;
+	// Accept 0 regardless of the bounds, e.g. fps_max 0 is unlimited.
+	bool allowZero {};
+	// Shown to the player before they are kicked. The console variant is the same phrase with " (Console)" appended.
+	CUtlString phrase;
+};
+
+struct PendingCvarQuery
+{
+	bool active;
+	// Incremented every time the entry is reused, so a late answer can't complete a newer query.
+	u32 generation;
+	i32 slot;
+	i32 ruleIndex;
+	f64 issueTime;
+};
+
+static_global struct
+{
+	CUtlVector<CvarRule> rules;
+	// Config snapshot the rules were loaded from, they are reloaded when it changes.
+	const KZServerConfig *rulesConfig;
+	PendingCvarQuery queries[CVAR_MAX_PENDING_QUERIES];
+	i32 pendingCount;
+	// Player slot the scheduler continues from on the next tick.
+	i32 cursor;
+} cvarChecks;
+
+static_function void AddCvarRule(const char *name, f64 min, f64 max, bool allowZero, const char *phrase)
+{
+	CvarRule &rule = cvarChecks.rules[cvarChecks.rules.AddToTail()];
+	rule.name = name;
+	rule.min = min;
+	rule.max = max;
+	rule.allowZero = allowZero;
+	rule.phrase = phrase;
+}
+
+static_function void LoadCvarRules()
+{
+	cvarChecks.rulesConfig = &KZOptionService::GetConfig();
+	cvarChecks.rules.RemoveAll();
+
+	KeyValues *section = KZOptionService::GetOptionKV("cvarRules");
+	if (!section)
+	{
+		AddCvarRule("m_yaw", -DBL_MAX, 0.3, false, "Kick Player m_yaw");
+		AddCvarRule("fps_max", 64.0, DBL_MAX, true, "Kick Player fps_max");
+		return;
+	}
+
+	for (KeyValues *kv = section->GetFirstSubKey(); kv; kv = kv->GetNextKey())
+	{
+		f64 min = kv->FindKey("min") ? kv->GetFloat("min") : -DBL_MAX;
+		f64 max = kv->FindKey("max") ? kv->GetFloat("max") : DBL_MAX;
+		const char *allowZero = kv->GetString("allowZero", "false");
+		AddCvarRule(kv->GetName(), min, max, KZ_STREQI(allowZero, "true") || atoi(allowZero) != 0, kv->GetString("phrase", ""));
+	}
+}
 
 static_function f64 KickPlayerInvalidSettings(CPlayerUserId userID)
 {
@@ -24,52 +94,196 @@ static_function f64 KickPlayerInvalidSettings(CPlayerUserId userID)
 	return 0.0f;
 }
 
-static_function void ValidateCvar(CPlayerSlot nSlot, ECvarValueStatus eStatus, const char *pszCvarName, const char *pszCvarValue)
+void KZAnticheatService::ValidateCvar(i32 ruleIndex, const char *value)
+{
+	if (!cvarChecks.rules.IsValidIndex(ruleIndex) || !this->hasValidCvars)
+	{
+		return;
+	}
+	const CvarRule &rule = cvarChecks.rules[ruleIndex];
+	f64 number = atof(value);
+	if ((rule.allowZero && number == 0.0) || (number >= rule.min && number <= rule.max))
+	{
+		return;
+	}
+
+	if (rule.phrase.IsEmpty())
+	{
+		this->player->languageService->PrintChat(true, false, "Kick Player Invalid Cvar", rule.name.Get());
+		this->player->languageService->PrintConsole(false, false, "Kick Player Invalid Cvar (Console)", rule.name.Get());
+	}
+	else
+	{
+		CUtlString consolePhrase = rule.phrase;
+		consolePhrase.Append(" (Console)");
+		this->player->languageService->PrintChat(true, false, rule.phrase.Get());
+		this->player->languageService->PrintConsole(false, false, consolePhrase.Get());
+	}
+	this->MarkHasInvalidCvars();
+	this->player->timerService->TimerStop();
+	StartTimer<CPlayerUserId>(KickPlayerInvalidSettings, this->player->GetClient()->GetUserID(), KICK_DELAY, true, true);
+}
+
+void KZAnticheatService::OnCvarQueryAnswered(i32 queryIndex, u32 generation, bool valueIntact, const char *value)
 {
-	if (eStatus != ECvarValueStatus::ValueIntact)
+	PendingCvarQuery &query = cvarChecks.queries[queryIndex];
+	if (!query.active || query.generation != generation)
 	{
 		return;
 	}
-	KZPlayer *player = g_pKZPlayerManager->ToPlayer(nSlot);
-	if (KZ_STREQI(pszCvarName, "m_yaw"))
+	query.active = false;
+	cvarChecks.pendingCount--;
+
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(CPlayerSlot(query.slot));
+	player->anticheatService->cvarCheck.pendingQueries--;
+	if (valueIntact)
+	{
+		player->anticheatService->ValidateCvar(query.ruleIndex, value);
+	}
+}
+
+void KZAnticheatService::ExpireCvarQueries(f64 currentTime)
+{
+	for (i32 i = 0; i < CVAR_MAX_PENDING_QUERIES && cvarChecks.pendingCount > 0; i++)
+	{
+		PendingCvarQuery &query = cvarChecks.queries[i];
+		if (query.active && currentTime - query.issueTime > CVAR_QUERY_TIMEOUT)
+		{
+			query.active = false;
+			cvarChecks.pendingCount--;
+			g_pKZPlayerManager->ToPlayer(CPlayerSlot(query.slot))->anticheatService->cvarCheck.pendingQueries--;
+		}
+	}
+}
+
+void KZAnticheatService::CancelCvarQueries()
+{
+	i32 slot = this->player->GetPlayerSlot().Get();
+	for (i32 i = 0; i < CVAR_MAX_PENDING_QUERIES && this->cvarCheck.pendingQueries > 0; i++)
 	{
-		if (atof(pszCvarValue) > MAXIMUM_M_YAW)
+		PendingCvarQuery &query = cvarChecks.queries[i];
+		if (query.active && query.slot == slot)
 		{
-			player->languageService->PrintChat(true, false, "Kick Player m_yaw");
-			player->languageService->PrintConsole(false, false, "Kick Player m_yaw (Console)");
-			player->anticheatService->MarkHasInvalidCvars();
-			player->timerService->TimerStop();
-			StartTimer<CPlayerUserId>(KickPlayerInvalidSettings, player->GetClient()->GetUserID(), KICK_DELAY, true, true);
+			query.active = false;
+			cvarChecks.pendingCount--;
+			this->cvarCheck.pendingQueries--;
 		}
 	}
-	else if (KZ_STREQI(pszCvarName, "fps_max"))
+}
+
+void KZAnticheatService::CancelAllCvarQueries()
+{
+	for (i32 i = 0; i < CVAR_MAX_PENDING_QUERIES; i++)
 	{
-		if (atof(pszCvarValue) != 0.0f && atof(pszCvarValue) < MINIMUM_FPS_MAX)
+		cvarChecks.queries[i].active = false;
+	}
+	cvarChecks.pendingCount = 0;
+	for (i32 i = 0; i < MAXPLAYERS + 1; i++)
+	{
+		KZPlayer *player = g_pKZPlayerManager->ToPlayer(CPlayerSlot(i));
+		player->anticheatService->cvarCheck.pendingQueries = 0;
+		player->anticheatService->cvarCheck.nextRule = 0;
+	}
+}
+
+i32 KZAnticheatService::IssueCvarQueries(f64 currentTime, i32 budget)
+{
+	if (!this->cvarCheck.enabled || !this->hasValidCvars)
+	{
+		this->cvarCheck.nextRule = 0;
+		return 0;
+	}
+	// Start a new round once the previous one is answered or timed out.
+	if (this->cvarCheck.nextRule == 0 && (currentTime < this->cvarCheck.nextCheckTime || this->cvarCheck.pendingQueries > 0))
+	{
+		return 0;
+	}
+
+	i32 issued = 0;
+	i32 queryIndex = 0;
+	while (issued < budget && this->cvarCheck.nextRule < cvarChecks.rules.Count())
+	{
+		while (queryIndex < CVAR_MAX_PENDING_QUERIES && cvarChecks.queries[queryIndex].active)
+		{
+			queryIndex++;
+		}
+		// Table is full, continue on a later tick.
+		if (queryIndex == CVAR_MAX_PENDING_QUERIES)
 		{
-			player->languageService->PrintChat(true, false, "Kick Player fps_max");
-			player->languageService->PrintConsole(false, false, "Kick Player fps_max (Console)");
-			player->anticheatService->MarkHasInvalidCvars();
-			player->timerService->TimerStop();
-			StartTimer<CPlayerUserId>(KickPlayerInvalidSettings, player->GetClient()->GetUserID(), KICK_DELAY, true, true);
+			return issued;
 		}
+
+		PendingCvarQuery &query = cvarChecks.queries[queryIndex];
+		query.active = true;
+		query.generation++;
+		query.slot = this->player->GetPlayerSlot().Get();
+		query.ruleIndex = this->cvarCheck.nextRule;
+		query.issueTime = currentTime;
+		cvarChecks.pendingCount++;
+		this->cvarCheck.pendingQueries++;
+
+		// clang-format off
+		g_pClientCvarValue->QueryCvarValue(this->player->GetPlayerSlot(), cvarChecks.rules[this->cvarCheck.nextRule].name.Get(),
+			[queryIndex, generation = query.generation](CPlayerSlot nSlot, ECvarValueStatus eStatus, const char *pszCvarName, const char *pszCvarValue)
+			{
+				KZAnticheatService::OnCvarQueryAnswered(queryIndex, generation, eStatus == ECvarValueStatus::ValueIntact, pszCvarValue);
+			});
+		// clang-format on
+
+		this->cvarCheck.nextRule++;
+		issued++;
 	}
+
+	if (this->cvarCheck.nextRule >= cvarChecks.rules.Count())
+	{
+		this->cvarCheck.nextRule = 0;
+		this->cvarCheck.nextCheckTime = currentTime + RandomFloat(INTEGRITY_CHECK_MIN_INTERVAL, INTEGRITY_CHECK_MAX_INTERVAL);
+	}
+	return issued;
 }
 
-static_function f64 CheckClientCvars(CPlayerUserId userID)
+void KZAnticheatService::OnGameFrame()
 {
-	KZPlayer *player = g_pKZPlayerManager->ToPlayer(userID);
-	if (!player || !g_pClientCvarValue || !player->anticheatService->ShouldCheckClientCvars())
+	if (!g_pClientCvarValue)
+	{
+		return;
+	}
+	if (cvarChecks.rulesConfig != &KZOptionService::GetConfig())
 	{
-		return 0.0f;
+		CancelAllCvarQueries();
+		LoadCvarRules();
 	}
-	g_pClientCvarValue->QueryCvarValue(player->GetPlayerSlot(), "m_yaw", ValidateCvar);
-	g_pClientCvarValue->QueryCvarValue(player->GetPlayerSlot(), "fps_max", ValidateCvar);
-	return RandomFloat(INTEGRITY_CHECK_MIN_INTERVAL, INTEGRITY_CHECK_MAX_INTERVAL);
+
+	f64 currentTime = g_pKZUtils->GetServerGlobals()->realtime;
+	ExpireCvarQueries(currentTime);
+
+	i32 budget = CVAR_QUERIES_PER_TICK;
+	for (i32 i = 0; i < MAXPLAYERS + 1 && budget > 0; i++)
+	{
+		KZPlayer *player = g_pKZPlayerManager->ToPlayer(CPlayerSlot(cvarChecks.cursor));
+		budget -= player->anticheatService->IssueCvarQueries(currentTime, budget);
+		// Out of budget in the middle of this player's round, resume with them next tick.
+		if (player->anticheatService->cvarCheck.nextRule != 0)
+		{
+			break;
+		}
+		cvarChecks.cursor = (cvarChecks.cursor + 1) % (MAXPLAYERS + 1);
+	}
+}
+
+void KZAnticheatService::Reset()
+{
+	this->CancelCvarQueries();
+	this->hasValidCvars = true;
+	this->strafeAnomalies = 0;
+	this->cvarCheck = {};
 }
 
 void KZAnticheatService::OnPlayerFullyConnect()
 {
 	this->hasValidCvars = true;
-	StartTimer<CPlayerUserId>(CheckClientCvars, this->player->GetClient()->GetUserID(),
-							  RandomFloat(INTEGRITY_CHECK_MIN_INTERVAL, INTEGRITY_CHECK_MAX_INTERVAL), true, true);
+	this->cvarCheck.enabled = true;
+	this->cvarCheck.nextRule = 0;
+	this->cvarCheck.nextCheckTime =
+		g_pKZUtils->GetServerGlobals()->realtime + RandomFloat(INTEGRITY_CHECK_MIN_INTERVAL, INTEGRITY_CHECK_MAX_INTERVAL);
 }
@@ -2,6 +2,14 @@
 #include "../kz.h"
 class KZBaseService;
 
+/*
+	Client cvars are validated against the rules in the "cvarRules" section of the server config.
+
+	A single scheduler walks over the players every tick and issues a bounded number of queries,
+	so checks are spread out instead of every player firing their own timer.
+	Outstanding queries are kept in a fixed size table, and answers to queries that timed out are ignored.
+*/
+
 class KZAnticheatService : public KZBaseService
 {
 public:
@@ -9,8 +17,34 @@ public:
 
 private:
 	bool hasValidCvars = true;
+	// KZ::strafeanalysis::Anomaly flags raised this session.
+	u32 strafeAnomalies {};
+
+	struct
+	{
+		bool enabled;
+		f64 nextCheckTime;
+		// Rule to query next, non-zero while a round of queries is spread over several ticks.
+		i32 nextRule;
+		i32 pendingQueries;
+	} cvarCheck {};
+
+	// Returns the number of queries issued, at most `budget`.
+	i32 IssueCvarQueries(f64 currentTime, i32 budget);
+	void CancelCvarQueries();
+	void ValidateCvar(i32 ruleIndex, const char *value);
+
+	static void OnCvarQueryAnswered(i32 queryIndex, u32 generation, bool valueIntact, const char *value);
+	static void ExpireCvarQueries(f64 currentTime);
+	// Drops every outstanding query and restarts the rounds in progress, their rule indices don't survive a rule reload.
+	static void CancelAllCvarQueries();
 
 public:
+	// Issues the queries that are due this tick and drops timed out ones.
+	static void OnGameFrame();
+
+	virtual void Reset() override;
+
 	bool ShouldCheckClientCvars()
 	{
 		return hasValidCvars;
@@ -22,4 +56,14 @@ public:
 	}
 
 	void OnPlayerFullyConnect();
+
+	void AddStrafeAnomaly(u32 anomaly)
+	{
+		strafeAnomalies |= anomaly;
+	}
+
+	u32 GetStrafeAnomalies()
+	{
+		return strafeAnomalies;
+	}
 };
@@ -0,0 +1,378 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <unordered_map>
+
+#include "../kz.h"
+#include "kz_anticheat.h"
+#include "strafe_analysis.h"
+#include "../jumpstats/kz_jumpstats.h"
+#include "../option/kz_option.h"
+#include "utils/mpscqueue.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace KZ::strafeanalysis;
+
+// Strafes past this are not analyzed.
+#define ANALYSIS_MAX_STRAFES         32
+#define ANALYSIS_QUEUE_SIZE          256
+#define ANALYSIS_RESULT_QUEUE_SIZE   64
+// How long the analysis thread sleeps when there is nothing to analyze.
+#define ANALYSIS_IDLE_TIME           std::chrono::milliseconds(100)
+// Shorter strafes have trivially perfect stats and are ignored.
+#define ANALYSIS_MIN_STRAFE_DURATION 0.05f
+// Profiles are evaluated and restarted every this many strafes, so old behaviour doesn't dilute new behaviour.
+#define ANALYSIS_WINDOW_STRAFES      256
+// The least recently updated profile is dropped past this to keep memory bounded on long running servers.
+#define ANALYSIS_MAX_PROFILES        4096
+
+// Consecutive jumps of at least two strafes where every strafe has at least this much sync.
+#define PERFECT_SYNC                 0.995
+#define PERFECT_SYNC_STREAK          20
+// High average sync alone is fine, high average sync that barely varies is not.
+#define SYNC_VARIANCE_MIN_MEAN       0.9
+#define SYNC_VARIANCE_MIN_STDDEV     0.01
+// Angle ratios range from -100 to 100 and even very good players are spread over a few units around 0.
+#define RATIO_VARIANCE_MAX_MEAN      5.0
+#define RATIO_VARIANCE_MIN_STDDEV    2.0
+// Gain efficiency histogram over [0, 1], flagged when its normalized entropy is below the threshold.
+#define GAIN_BINS                    20
+#define GAIN_MIN_ENTROPY             0.15
+
+struct AnalysisStrafe
+{
+	f32 duration;
+	f32 sync;
+	f32 gainEfficiency;
+	f32 ratioAverage;
+	bool gainAvailable;
+	bool ratioAvailable;
+};
+
+struct AnalysisJump
+{
+	u64 steamID64;
+	i32 strafeCount;
+	AnalysisStrafe strafes[ANALYSIS_MAX_STRAFES];
+};
+
+struct AnalysisResult
+{
+	u64 steamID64;
+	Anomaly anomaly;
+	// The statistic that tripped the test and the number of samples it is based on.
+	f64 value;
+	u32 samples;
+};
+
+// Welford's online algorithm, numerically stable without keeping the samples around.
+struct OnlineStats
+{
+	u32 count;
+	f64 mean;
+	f64 m2;
+
+	void Add(f64 value)
+	{
+		this->count++;
+		f64 delta = value - this->mean;
+		this->mean += delta / this->count;
+		this->m2 += delta * (value - this->mean);
+	}
+
+	f64 GetStdDev() const
+	{
+		return this->count > 1 ? sqrt(this->m2 / (this->count - 1)) : 0.0;
+	}
+};
+
+struct StrafeProfile
+{
+	OnlineStats sync;
+	OnlineStats ratio;
+	u32 gainBins[GAIN_BINS];
+	u32 gainCount;
+	u32 strafeCount;
+	u32 perfectSyncStreak;
+	// Anomalies already reported, each is only reported once per profile.
+	u32 reported;
+	// Number of jumps analyzed in total when this profile was last updated.
+	u64 lastUpdate;
+};
+
+static_global struct
+{
+	std::thread worker;
+	std::atomic<bool> running;
+	std::atomic<u64> analyzed;
+	std::atomic<u64> dropped;
+	std::atomic<u64> anomalies;
+	MPSCQueue<AnalysisJump, ANALYSIS_QUEUE_SIZE> jumps;
+	MPSCQueue<AnalysisResult, ANALYSIS_RESULT_QUEUE_SIZE> results;
+	// Only touched by the analysis thread.
+	std::unordered_map<u64, StrafeProfile> profiles;
+	u64 updateCount;
+	// Config snapshot the worker was started or stopped for, checked again when it changes.
+	const KZServerConfig *config;
+} analysis;
+
+static_function const char *GetAnomalyDescription(Anomaly anomaly)
+{
+	switch (anomaly)
+	{
+		case ANOMALY_PERFECT_SYNC_STREAK:
+			return "perfect sync streak";
+		case ANOMALY_SYNC_VARIANCE:
+			return "sync standard deviation";
+		case ANOMALY_ANGLE_RATIO_VARIANCE:
+			return "angle ratio standard deviation";
+		case ANOMALY_GAIN_DISTRIBUTION:
+			return "gain efficiency entropy";
+		default:
+			return "unknown";
+	}
+}
+
+static_function void Report(u64 steamID64, StrafeProfile &profile, Anomaly anomaly, f64 value, u32 samples)
+{
+	if (profile.reported & anomaly)
+	{
+		return;
+	}
+	profile.reported |= anomaly;
+	// Unlike jumps, anomalies are rare enough that a full queue means the main thread is stuck, try again on the next window.
+	if (!analysis.results.TryPush(AnalysisResult {steamID64, anomaly, value, samples}))
+	{
+		profile.reported &= ~anomaly;
+	}
+}
+
+static_function f64 GetGainEntropy(const StrafeProfile &profile)
+{
+	f64 entropy = 0.0;
+	for (u32 i = 0; i < GAIN_BINS; i++)
+	{
+		if (profile.gainBins[i] == 0)
+		{
+			continue;
+		}
+		f64 p = (f64)profile.gainBins[i] / profile.gainCount;
+		entropy -= p * log(p);
+	}
+	return entropy / log((f64)GAIN_BINS);
+}
+
+// Run the distribution tests over a full window and start a new one.
+static_function void EvaluateWindow(u64 steamID64, StrafeProfile &profile)
+{
+	if (profile.sync.mean >= SYNC_VARIANCE_MIN_MEAN && profile.sync.GetStdDev() < SYNC_VARIANCE_MIN_STDDEV)
+	{
+		Report(steamID64, profile, ANOMALY_SYNC_VARIANCE, profile.sync.GetStdDev(), profile.sync.count);
+	}
+	if (profile.ratio.count >= ANALYSIS_WINDOW_STRAFES / 2 && fabs(profile.ratio.mean) < RATIO_VARIANCE_MAX_MEAN
+		&& profile.ratio.GetStdDev() < RATIO_VARIANCE_MIN_STDDEV)
+	{
+		Report(steamID64, profile, ANOMALY_ANGLE_RATIO_VARIANCE, profile.ratio.GetStdDev(), profile.ratio.count);
+	}
+	if (profile.gainCount >= ANALYSIS_WINDOW_STRAFES / 2)
+	{
+		f64 entropy = GetGainEntropy(profile);
+		if (entropy < GAIN_MIN_ENTROPY)
+		{
+			Report(steamID64, profile, ANOMALY_GAIN_DISTRIBUTION, entropy, profile.gainCount);
+		}
+	}
+
+	profile.sync = {};
+	profile.ratio = {};
+	memset(profile.gainBins, 0, sizeof(profile.gainBins));
+	profile.gainCount = 0;
+	profile.strafeCount = 0;
+}
+
+static_function void Analyze(const AnalysisJump &jump)
+{
+	if (analysis.profiles.size() >= ANALYSIS_MAX_PROFILES && analysis.profiles.find(jump.steamID64) == analysis.profiles.end())
+	{
+		auto oldest = analysis.profiles.begin();
+		for (auto it = analysis.profiles.begin(); it != analysis.profiles.end(); ++it)
+		{
+			if (it->second.lastUpdate < oldest->second.lastUpdate)
+			{
+				oldest = it;
+			}
+		}
+		analysis.profiles.erase(oldest);
+	}
+	StrafeProfile &profile = analysis.profiles[jump.steamID64];
+	profile.lastUpdate = ++analysis.updateCount;
+
+	i32 strafeCount = 0;
+	bool perfectSync = true;
+	for (i32 i = 0; i < MIN(jump.strafeCount, ANALYSIS_MAX_STRAFES); i++)
+	{
+		const AnalysisStrafe &strafe = jump.strafes[i];
+		if (strafe.duration < ANALYSIS_MIN_STRAFE_DURATION)
+		{
+			continue;
+		}
+		strafeCount++;
+		perfectSync &= strafe.sync >= PERFECT_SYNC;
+		profile.sync.Add(strafe.sync);
+		if (strafe.ratioAvailable)
+		{
+			profile.ratio.Add(strafe.ratioAverage);
+		}
+		if (strafe.gainAvailable)
+		{
+			u32 bin = (u32)(Clamp(strafe.gainEfficiency, 0.0f, 1.0f) * (GAIN_BINS - 1) + 0.5f);
+			profile.gainBins[bin]++;
+			profile.gainCount++;
+		}
+		if (++profile.strafeCount >= ANALYSIS_WINDOW_STRAFES)
+		{
+			EvaluateWindow(jump.steamID64, profile);
+		}
+	}
+
+	if (strafeCount >= 2)
+	{
+		profile.perfectSyncStreak = perfectSync ? profile.perfectSyncStreak + 1 : 0;
+		if (profile.perfectSyncStreak >= PERFECT_SYNC_STREAK)
+		{
+			Report(jump.steamID64, profile, ANOMALY_PERFECT_SYNC_STREAK, PERFECT_SYNC, profile.perfectSyncStreak);
+		}
+	}
+	analysis.analyzed.fetch_add(1, std::memory_order_relaxed);
+}
+
+static_function void AnalyzeJumps()
+{
+	AnalysisJump *jump = new AnalysisJump();
+	while (analysis.running.load(std::memory_order_acquire))
+	{
+		if (!analysis.jumps.TryPop(*jump))
+		{
+			std::this_thread::sleep_for(ANALYSIS_IDLE_TIME);
+			continue;
+		}
+		do
+		{
+			Analyze(*jump);
+		} while (analysis.jumps.TryPop(*jump));
+	}
+	delete jump;
+}
+
+void KZ::strafeanalysis::Init()
+{
+	analysis.config = &KZOptionService::GetConfig();
+	if (!analysis.config->strafeAnalysis)
+	{
+		return;
+	}
+	analysis.running.store(true, std::memory_order_release);
+	analysis.worker = std::thread(AnalyzeJumps);
+}
+
+void KZ::strafeanalysis::Cleanup()
+{
+	if (!analysis.worker.joinable())
+	{
+		return;
+	}
+	analysis.running.store(false, std::memory_order_release);
+	analysis.worker.join();
+}
+
+void KZ::strafeanalysis::Submit(Jump *jump)
+{
+	if (!analysis.running.load(std::memory_order_relaxed) || !jump->IsValid())
+	{
+		return;
+	}
+	KZPlayer *player = jump->GetJumpPlayer();
+	if (player->IsFakeClient())
+	{
+		return;
+	}
+
+	// Stays alive for the whole session, records are too big to build on the stack every jump.
+	static_persist AnalysisJump record;
+	record.steamID64 = player->GetSteamId64();
+	record.strafeCount = MIN(jump->strafes.Count(), ANALYSIS_MAX_STRAFES);
+	for (i32 i = 0; i < record.strafeCount; i++)
+	{
+		Strafe &strafe = jump->strafes[i];
+		AnalysisStrafe &out = record.strafes[i];
+		out.duration = strafe.GetStrafeDuration();
+		out.sync = out.duration > 0.0f ? strafe.GetSync() : 0.0f;
+		out.gainAvailable = strafe.GetMaxGain() > 0.0f;
+		out.gainEfficiency = out.gainAvailable ? strafe.GetGain() / strafe.GetMaxGain() : 0.0f;
+		out.ratioAvailable = strafe.arStats.available;
+		out.ratioAverage = strafe.arStats.available ? strafe.arStats.average : 0.0f;
+	}
+
+	if (!analysis.jumps.TryPush(record))
+	{
+		analysis.dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void KZ::strafeanalysis::OnGameFrame()
+{
+	// Follow "strafeAnalysis" across kz_reload_config.
+	if (analysis.config != &KZOptionService::GetConfig())
+	{
+		bool enable = KZOptionService::GetConfig().strafeAnalysis;
+		if (enable && !analysis.worker.joinable())
+		{
+			KZ::strafeanalysis::Init();
+		}
+		else if (!enable)
+		{
+			KZ::strafeanalysis::Cleanup();
+		}
+		analysis.config = &KZOptionService::GetConfig();
+	}
+
+	AnalysisResult result;
+	while (analysis.results.TryPop(result))
+	{
+		analysis.anomalies.fetch_add(1, std::memory_order_relaxed);
+		KZPlayer *player = g_pKZPlayerManager->SteamIdToPlayer(result.steamID64);
+		META_CONPRINTF("[KZ::Anticheat] Strafe anomaly for %s (%llu): %s %.4f over %u samples\n", player ? player->GetName() : "<disconnected>",
+					   result.steamID64, GetAnomalyDescription(result.anomaly), result.value, result.samples);
+		if (player)
+		{
+			player->anticheatService->AddStrafeAnomaly(result.anomaly);
+		}
+	}
+}
+
+CON_COMMAND_F(kz_strafe_analysis_stats, "Print strafe analysis status and the anomalies of connected players", FCVAR_NONE)
+{
+	META_CONPRINTF("[KZ::Anticheat] Strafe analysis %s, analyzed: %llu, dropped: %llu, anomalies: %llu\n",
+				   analysis.running.load(std::memory_order_relaxed) ? "running" : "disabled", analysis.analyzed.load(std::memory_order_relaxed),
+				   analysis.dropped.load(std::memory_order_relaxed), analysis.anomalies.load(std::memory_order_relaxed));
+	for (i32 i = 1; i < MAXPLAYERS + 1; i++)
+	{
+		KZPlayer *player = g_pKZPlayerManager->ToPlayer(i);
+		u32 anomalies = player->anticheatService->GetStrafeAnomalies();
+		if (!player->IsInGame() || !anomalies)
+		{
+			continue;
+		}
+		META_CONPRINTF("  %s (%llu):", player->GetName(), player->GetSteamId64());
+		for (u32 anomaly = ANOMALY_PERFECT_SYNC_STREAK; anomaly <= ANOMALY_GAIN_DISTRIBUTION; anomaly <<= 1)
+		{
+			if (anomalies & anomaly)
+			{
+				META_CONPRINTF(" [%s]", GetAnomalyDescription((Anomaly)anomaly));
+			}
+		}
+		META_CONPRINTF("\n");
+	}
+}
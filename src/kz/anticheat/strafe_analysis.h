@@ -0,0 +1,31 @@
+#pragma once
+#include "common.h"
+
+class Jump;
+
+/*
+	Looks for strafing that is too consistent to be human, such as perfect sync over many jumps.
+
+	The game thread only copies the strafe stats of each ended jump into a lock-free queue. A background thread keeps rolling
+	per-player profiles with online mean and variance plus a few distribution tests, and posts anomalies back through
+	another queue that is drained every GameFrame. Anomalies are logged and kept on the anticheat service, nobody is kicked.
+	kz_strafe_analysis_stats lists the anomalies of connected players.
+	Enabled by the "strafeAnalysis" server option, which is picked up again by kz_reload_config.
+*/
+
+namespace KZ::strafeanalysis
+{
+	enum Anomaly : u32
+	{
+		ANOMALY_PERFECT_SYNC_STREAK = 1 << 0,
+		ANOMALY_SYNC_VARIANCE = 1 << 1,
+		ANOMALY_ANGLE_RATIO_VARIANCE = 1 << 2,
+		ANOMALY_GAIN_DISTRIBUTION = 1 << 3,
+	};
+
+	void Init();
+	void Cleanup();
+	void Submit(Jump *jump);
+	// Hand the anomalies found by the analysis thread to the players. Called every GameFrame.
+	void OnGameFrame();
+} // namespace KZ::strafeanalysis
@@ -6,6 +6,7 @@
 
 #include "utils/simplecmds.h"
 #include "utils/ctimer.h"
+#include "kz/watchdog/kz_watchdog.h"
 
 using namespace KZ::beam;
 
@@ -19,8 +20,8 @@ static_global class KZOptionServiceEventListener_Beam : public KZOptionServiceEv
 
 void KZBeamService::OnPlayerPreferencesLoaded()
 {
-	this->SetBeamType(this->player->optionService->GetPreferenceInt("desiredBeamType"));
-	this->playerBeamOffset = this->player->optionService->GetPreferenceVector("beamOffset", KZBeamService::defaultOffset);
+	this->SetBeamType(this->player->optionService->GetPreference(KZ::pref::desiredBeamType));
+	this->playerBeamOffset = this->player->optionService->GetPreference(KZ::pref::beamOffset, KZBeamService::defaultOffset);
 }
 
 SCMD(kz_beam, SCFL_MISC | SCFL_PREFERENCE)
@@ -69,7 +70,7 @@ SCMD(kz_beam, SCFL_MISC | SCFL_PREFERENCE)
 			break;
 		}
 	}
-	player->optionService->SetPreferenceInt("desiredBeamType", player->beamService->desiredBeamType);
+	player->optionService->SetPreference(KZ::pref::desiredBeamType, player->beamService->desiredBeamType);
 	return MRES_HANDLED;
 }
 
@@ -84,7 +85,7 @@ SCMD(kz_beamoffset, SCFL_MISC | SCFL_PREFERENCE)
 	}
 	player->beamService->playerBeamOffset = Vector(atof(args->Arg(1)), atof(args->Arg(2)), atof(args->Arg(3)));
 
-	player->optionService->SetPreferenceVector("beamOffset", player->beamService->playerBeamOffset);
+	player->optionService->SetPreference(KZ::pref::beamOffset, player->beamService->playerBeamOffset);
 	return MRES_HANDLED;
 }
 
@@ -102,6 +103,152 @@ static_function CBaseModelEntity *CreateGrenadeEnt(i32 team)
 	return beamEnt;
 }
 
+struct PooledBeam
+{
+	CEntityHandle handle;
+	bool leased;
+	// Tick when the entity was last leased or returned, used for reuse delay and LRU eviction.
+	i32 lastUsedTick;
+};
+
+static_global CUtlVector<PooledBeam> beamPool;
+static_global BeamPoolStats beamPoolStats;
+
+static_function void PruneBeamPool()
+{
+	// Entities might have been removed behind our back, for example on round restart or map change.
+	FOR_EACH_VEC_BACK(beamPool, i)
+	{
+		if (!beamPool[i].handle.Get())
+		{
+			beamPool.Remove(i);
+		}
+	}
+}
+
+CEntityHandle KZ::beam::LeaseBeamEntity(i32 team)
+{
+	PruneBeamPool();
+	beamPoolStats.leases++;
+
+	i32 currentTick = g_pKZUtils->GetServerGlobals()->tickcount;
+	i32 lruIndex = -1;
+	FOR_EACH_VEC(beamPool, i)
+	{
+		if (beamPool[i].leased)
+		{
+			continue;
+		}
+		if (lruIndex == -1 || beamPool[i].lastUsedTick < beamPool[lruIndex].lastUsedTick)
+		{
+			lruIndex = i;
+		}
+	}
+
+	if (lruIndex != -1)
+	{
+		PooledBeam &entry = beamPool[lruIndex];
+		// The tick count resets on map change, never hold an entity forever because of that.
+		bool ready = currentTick - entry.lastUsedTick >= beamPoolReuseDelayTicks || currentTick < entry.lastUsedTick;
+		if (ready)
+		{
+			beamPoolStats.hits++;
+			CBaseModelEntity *ent = static_cast<CBaseModelEntity *>(entry.handle.Get());
+			ent->m_iTeamNum(team);
+			entry.leased = true;
+			entry.lastUsedTick = currentTick;
+			return entry.handle;
+		}
+	}
+
+	if (beamPool.Count() >= beamPoolMaxEntities)
+	{
+		if (lruIndex == -1)
+		{
+			beamPoolStats.rejected++;
+			return CEntityHandle();
+		}
+		// Make room by removing the least recently used idle entity, the new one is guaranteed to start a fresh trail.
+		g_pKZUtils->RemoveEntity(beamPool[lruIndex].handle.Get());
+		beamPool.Remove(lruIndex);
+		beamPoolStats.evictions++;
+	}
+
+	beamPoolStats.misses++;
+	PooledBeam *entry = beamPool.AddToTailGetPtr();
+	entry->handle = CreateGrenadeEnt(team)->GetRefEHandle();
+	entry->leased = true;
+	entry->lastUsedTick = currentTick;
+	return entry->handle;
+}
+
+void KZ::beam::ReturnBeamEntity(CEntityHandle handle)
+{
+	FOR_EACH_VEC(beamPool, i)
+	{
+		if (beamPool[i].handle != handle)
+		{
+			continue;
+		}
+		CBaseModelEntity *ent = static_cast<CBaseModelEntity *>(handle.Get());
+		if (!ent)
+		{
+			beamPool.Remove(i);
+			return;
+		}
+		ent->Teleport(nullptr, nullptr, &vec3_origin);
+		beamPool[i].leased = false;
+		beamPool[i].lastUsedTick = g_pKZUtils->GetServerGlobals()->tickcount;
+		return;
+	}
+	// Not from the pool, get rid of it the old way.
+	if (handle.Get())
+	{
+		g_pKZUtils->RemoveEntity(handle.Get());
+	}
+}
+
+void KZBeamService::Cleanup()
+{
+	FOR_EACH_VEC(beamPool, i)
+	{
+		if (beamPool[i].handle.Get())
+		{
+			g_pKZUtils->RemoveEntity(beamPool[i].handle.Get());
+		}
+	}
+	beamPool.RemoveAll();
+}
+
+BeamPoolStats KZ::beam::GetBeamPoolStats()
+{
+	PruneBeamPool();
+	BeamPoolStats stats = beamPoolStats;
+	stats.idle = 0;
+	stats.leased = 0;
+	FOR_EACH_VEC(beamPool, i)
+	{
+		if (beamPool[i].leased)
+		{
+			stats.leased++;
+		}
+		else
+		{
+			stats.idle++;
+		}
+	}
+	return stats;
+}
+
+CON_COMMAND_F(kz_beam_pool_stats, "Print beam entity pool statistics", FCVAR_NONE)
+{
+	BeamPoolStats stats = KZ::beam::GetBeamPoolStats();
+	f64 hitRate = stats.leases ? (f64)stats.hits / (f64)stats.leases * 100.0 : 0.0;
+	META_CONPRINTF("[KZ::Beam] Pool: %i leased, %i idle, %i max\n", stats.leased, stats.idle, beamPoolMaxEntities);
+	META_CONPRINTF("[KZ::Beam] Leases: %llu, hits: %llu (%.1f%%), misses: %llu, evictions: %llu, rejected: %llu\n", stats.leases, stats.hits,
+				   hitRate, stats.misses, stats.evictions, stats.rejected);
+}
+
 void KZBeamService::Update()
 {
 	KZPlayer *newTarget = this->player->IsAlive() ? this->player : this->player->specService->GetSpectatedPlayer();
@@ -179,9 +326,13 @@ void KZBeamService::UpdatePlayerBeam()
 	}
 	if (!this->playerBeam.handle.Get())
 	{
-		this->playerBeam.handle = CreateGrenadeEnt(CS_TEAM_CT);
+		this->playerBeam.handle = LeaseBeamEntity(CS_TEAM_CT);
 	}
 	CBaseModelEntity *ent = static_cast<CBaseModelEntity *>(playerBeam.handle.Get());
+	if (!ent)
+	{
+		return;
+	}
 	BeamOrigin origin;
 	this->buffer.Peek(&origin, originHistorySize - 1);
 	origin += this->playerBeamOffset;
@@ -194,9 +345,14 @@ void KZBeamService::UpdatePlayerBeam()
 	{
 		if (!playerBeam.moving || origin.forceRecreate)
 		{
-			g_pKZUtils->RemoveEntity(playerBeam.handle.Get());
-			playerBeam.handle = CreateGrenadeEnt(ent->m_iTeamNum())->GetRefEHandle();
+			ReturnBeamEntity(playerBeam.handle);
+			playerBeam.handle = LeaseBeamEntity(CS_TEAM_CT);
 			playerBeam.moving = true;
+			ent = static_cast<CBaseModelEntity *>(playerBeam.handle.Get());
+			if (!ent)
+			{
+				return;
+			}
 		}
 		playerBeam.lastOrigin = origin;
 		ent->Teleport(&origin, nullptr, &vec3_origin);
@@ -205,6 +361,7 @@ void KZBeamService::UpdatePlayerBeam()
 
 void KZBeamService::Reset()
 {
+	ReturnBeamEntity(this->playerBeam.handle);
 	this->playerBeam = {};
 	this->playerBeamOffset = KZBeamService::defaultOffset;
 	this->target = {};
@@ -216,11 +373,7 @@ void KZBeamService::Reset()
 	this->teleportedThisTick = false;
 	FOR_EACH_VEC(this->instantBeams, i)
 	{
-		KZ::beam::InstantBeam *beam = &this->instantBeams[i];
-		if (beam->handle.Get())
-		{
-			g_pKZUtils->RemoveEntity(beam->handle.Get());
-		}
+		ReturnBeamEntity(this->instantBeams[i].handle);
 	}
 	this->instantBeams.RemoveAll();
 }
@@ -232,6 +385,10 @@ void KZBeamService::UpdateBeams()
 	{
 		sv_grenade_trajectory_prac_trailtime.Set(4.0f);
 	}
+	if (!KZ::watchdog::ShouldRun(KZ::watchdog::DEGRADE_BEAMS))
+	{
+		return;
+	}
 	for (i32 i = 0; i < MAXPLAYERS + 1; i++)
 	{
 		KZPlayer *player = g_pKZPlayerManager->ToPlayer(i);
@@ -246,9 +403,14 @@ void KZBeamService::UpdateBeams()
 
 void KZBeamService::AddInstantBeam(const Vector &start, const Vector &end, u32 lifetime)
 {
+	CEntityHandle handle = LeaseBeamEntity(CS_TEAM_T);
+	CBaseModelEntity *ent = static_cast<CBaseModelEntity *>(handle.Get());
+	if (!ent)
+	{
+		return;
+	}
 	KZ::beam::InstantBeam *beam = this->instantBeams.AddToTailGetPtr();
-	CBaseModelEntity *ent = CreateGrenadeEnt(CS_TEAM_T);
-	beam->handle = ent->GetRefEHandle();
+	beam->handle = handle;
 	beam->start = start;
 	beam->end = end;
 	beam->tickRemaining = lifetime;
@@ -270,7 +432,7 @@ void KZBeamService::UpdateInstantBeams()
 
 		if (beam->tickLingered > beam->maxLingerTicks)
 		{
-			g_pKZUtils->RemoveEntity(beam->handle.Get());
+			ReturnBeamEntity(beam->handle);
 			this->instantBeams.Remove(i);
 			i--;
 			continue;
@@ -46,6 +46,32 @@ namespace KZ::beam
 		return lhs.handle == rhs.handle;
 	}
 
+	/*
+	 Server-wide pool of beam entities.
+
+	 Beam entities are leased from the pool and returned once they are no longer needed instead of being spawned and removed every time.
+	 Idle entities are not transmitted to anyone, and are only reused after a short delay so clients drop them first,
+	 which means the trail never connects the old and new position of a recycled entity.
+	*/
+	constexpr i32 beamPoolMaxEntities = 64;
+	constexpr i32 beamPoolReuseDelayTicks = 8;
+
+	struct BeamPoolStats
+	{
+		u64 leases;
+		u64 hits;
+		u64 misses;
+		u64 evictions;
+		u64 rejected;
+		i32 idle;
+		i32 leased;
+	};
+
+	// Returns an invalid handle if the pool is at capacity and nothing can be evicted.
+	CEntityHandle LeaseBeamEntity(i32 team);
+	void ReturnBeamEntity(CEntityHandle handle);
+	BeamPoolStats GetBeamPoolStats();
+
 } // namespace KZ::beam
 
 class KZBeamService : public KZBaseService
@@ -55,6 +81,8 @@ public:
 
 	virtual void Reset();
 	static void UpdateBeams();
+	// Removes every pooled beam entity, called on unload.
+	static void Cleanup();
 	void Update();
 	KZ::beam::PlayerBeam playerBeam;
 
@@ -75,6 +75,25 @@ void KZCheckpointService::ResetCheckpoints(bool playSound, bool resetTeleports)
 	this->checkpoints.Purge();
 }
 
+void KZCheckpointService::CaptureCheckpoint(Checkpoint &cp)
+{
+	CCSPlayerPawn *pawn = this->player->GetPlayerPawn();
+	if (!pawn)
+	{
+		return;
+	}
+	this->player->GetOrigin(&cp.origin);
+	this->player->GetAngles(&cp.angles);
+	cp.slopeDropHeight = pawn->m_flSlopeDropHeight();
+	cp.slopeDropOffset = pawn->m_flSlopeDropOffset();
+	if (this->player->GetMoveServices())
+	{
+		cp.ladderNormal = this->player->GetMoveServices()->m_vecLadderNormal();
+		cp.onLadder = pawn->m_MoveType() == MOVETYPE_LADDER;
+	}
+	cp.groundEnt = pawn->m_hGroundEntity();
+}
+
 void KZCheckpointService::SetCheckpoint()
 {
 	CCSPlayerPawn *pawn = this->player->GetPlayerPawn();
@@ -106,16 +125,7 @@ void KZCheckpointService::SetCheckpoint()
 	}
 
 	Checkpoint cp = {};
-	this->player->GetOrigin(&cp.origin);
-	this->player->GetAngles(&cp.angles);
-	cp.slopeDropHeight = pawn->m_flSlopeDropHeight();
-	cp.slopeDropOffset = pawn->m_flSlopeDropOffset();
-	if (this->player->GetMoveServices())
-	{
-		cp.ladderNormal = this->player->GetMoveServices()->m_vecLadderNormal();
-		cp.onLadder = pawn->m_MoveType() == MOVETYPE_LADDER;
-	}
-	cp.groundEnt = pawn->m_hGroundEntity();
+	this->CaptureCheckpoint(cp);
 	this->checkpoints.AddToTail(cp);
 	// newest checkpoints aren't deleted after using prev cp.
 	this->currentCpIndex = this->checkpoints.Count() - 1;
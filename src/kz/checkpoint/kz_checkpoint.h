@@ -47,6 +47,8 @@ private:
 public:
 	void OnPlayerPreferencesLoaded();
 	void ResetCheckpoints(bool playSound = false, bool resetTeleports = true);
+	// Fill the checkpoint with the player's current position and ground state.
+	void CaptureCheckpoint(Checkpoint &cp);
 	void SetCheckpoint();
 
 	void UndoTeleport();
@@ -32,6 +32,8 @@ void KZDatabaseService::Cleanup()
 {
 	if (databaseConnection)
 	{
+		// Writes flushed on unload are only queued, whether they land before the connection goes away is up to sql_mm.
+		// Waiting here doesn't help, the transaction callbacks run on this thread. The last flush is best-effort.
 		databaseConnection->Destroy();
 		databaseConnection = NULL;
 	}
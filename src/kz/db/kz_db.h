@@ -3,6 +3,12 @@
 #include "kz/jumpstats/kz_jumpstats.h"
 #include "kz/timer/kz_timer.h"
 
+// Jumpstats are stored as fixed point integers.
+#define KZ_DB_JS_DISTANCE_PRECISION 10000
+#define KZ_DB_JS_SYNC_PRECISION     100
+#define KZ_DB_JS_SPEED_PRECISION    100
+#define KZ_DB_JS_AIRTIME_PRECISION  10000
+
 class ISQLConnection;
 class ISQLQuery;
 typedef std::function<void(std::vector<ISQLQuery *>)> TransactionSuccessCallbackFunc;
@@ -100,6 +106,10 @@ public:
 
 private:
 	static void CheckMigrations(std::vector<ISQLQuery *> queries);
+	// Runs the migrations in [from, to) in a single transaction.
+	static void ApplyMigrations(u32 from, u32 to, std::function<void()> onSuccess, std::function<void()> onFailure);
+	// Re-encodes run metadata still stored as JSON, a batch at a time, and calls onFinished once no legacy rows are left.
+	static void ConvertLegacyRunMetadata(std::function<void()> onFinished, std::function<void()> onFailure);
 
 public:
 	static bool IsMapSetUp();
@@ -117,7 +127,9 @@ public:
 
 	// Client/Player
 	void SetupClient();
+	// Only queues the write, FlushPrefs sends every queued write in one transaction.
 	void SavePrefs(CUtlString prefs);
+	static void FlushPrefs();
 	bool isCheater {};
 
 private:
@@ -148,6 +160,10 @@ public:
 	static void QueryPBRankless(u64 steamID64, CUtlString mapName, CUtlString courseName, u32 modeID, u64 styleIDFlags,
 								TransactionSuccessCallbackFunc onSuccess, TransactionFailureCallbackFunc onFailure);
 
+	// Jumpstats
+	void SaveJumpstat(JumpType jumpType, i32 modeID, f64 distance, u32 block, u32 strafes, f32 sync, f32 pre, f32 max, f32 airTime);
+	static void QueryAllJumpstatPBs(TransactionSuccessCallbackFunc onSuccess, TransactionFailureCallbackFunc onFailure);
+
 	static void QueryAllRecords(CUtlString mapName, TransactionSuccessCallbackFunc onSuccess, TransactionFailureCallbackFunc onFailure);
 	static void QueryRecords(CUtlString mapName, CUtlString courseName, u32 modeID, u32 count, u32 offset, TransactionSuccessCallbackFunc onSuccess,
 							 TransactionFailureCallbackFunc onFailure);
@@ -1,5 +1,6 @@
 #include "kz_db.h"
 #include "kz/option/kz_option.h"
+#include "kz/timer/run_metadata.h"
 
 #include <regex>
 #include "checksum_crc.h"
@@ -10,6 +11,7 @@
 #include "queries/maps.h"
 #include "queries/modes.h"
 #include "queries/players.h"
+#include "queries/savelocs.h"
 #include "queries/styles.h"
 #include "queries/startpos.h"
 #include "queries/times.h"
@@ -20,6 +22,12 @@
 
 using namespace KZ::Database;
 
+// Number of Times rows converted to the binary metadata format per transaction.
+#define METADATA_CONVERSION_BATCH_SIZE 500
+// Index of sql_times_legacymetadata_converted in the migration lists.
+// It is only recorded once ConvertLegacyRunMetadata went through every legacy row, so the conversion runs once.
+#define MIGRATION_LEGACY_METADATA      11
+
 static_global bool localDBConnected = false;
 
 std::string trimString(const char *str)
@@ -41,6 +49,10 @@ static_global const std::string mysqlMigrations[] =
 	trimString(mysql_times_create),
 	trimString(mysql_jumpstats_create),
 	trimString(mysql_startpos_create),
+	trimString(mysql_savelocs_create),
+	trimString(mysql_jumpstats_deduplicate),
+	trimString(sql_jumpstats_create_pbindex),
+	trimString(sql_times_legacymetadata_converted),
 };
 
 static_global const std::string sqliteMigrations[] = 
@@ -53,6 +65,10 @@ static_global const std::string sqliteMigrations[] =
 	trimString(sqlite_times_create),
 	trimString(sqlite_jumpstats_create),
 	trimString(sqlite_startpos_create),
+	trimString(sqlite_savelocs_create),
+	trimString(sqlite_jumpstats_deduplicate),
+	trimString(sql_jumpstats_create_pbindex),
+	trimString(sql_times_legacymetadata_converted),
 };
 
 // clang-format on
@@ -151,8 +167,21 @@ void KZDatabaseService::CheckMigrations(std::vector<ISQLQuery *> queries)
 		databaseConnection = nullptr;
 	};
 
+	// Legacy run metadata has to be converted before its migration is recorded, the migrations after it wait for the conversion.
+	if (current <= MIGRATION_LEGACY_METADATA && max > MIGRATION_LEGACY_METADATA)
+	{
+		auto onConverted = [max, onSuccess, onFailure]() { ApplyMigrations(MIGRATION_LEGACY_METADATA, max, onSuccess, onFailure); };
+		ApplyMigrations(current, MIGRATION_LEGACY_METADATA, [onConverted, onFailure]() { ConvertLegacyRunMetadata(onConverted, onFailure); },
+						onFailure);
+		return;
+	}
+	ApplyMigrations(current, max, onSuccess, onFailure);
+}
+
+void KZDatabaseService::ApplyMigrations(u32 from, u32 to, std::function<void()> onSuccess, std::function<void()> onFailure)
+{
 	// If there's no migration needed, the database is already fully setup.
-	if (current == max)
+	if (from == to)
 	{
 		onSuccess();
 		return;
@@ -160,7 +189,7 @@ void KZDatabaseService::CheckMigrations(std::vector<ISQLQuery *> queries)
 
 	Transaction txn;
 	char query[1024];
-	for (u32 i = current; i < max; i++)
+	for (u32 i = from; i < to; i++)
 	{
 		switch (KZDatabaseService::GetDatabaseType())
 		{
@@ -186,6 +215,64 @@ void KZDatabaseService::CheckMigrations(std::vector<ISQLQuery *> queries)
 		txn, [onSuccess](std::vector<ISQLQuery *> queries) { onSuccess(); }, [onFailure](std::string error, int failIndex) { onFailure(); });
 }
 
+void KZDatabaseService::ConvertLegacyRunMetadata(std::function<void()> onFinished, std::function<void()> onFailure)
+{
+	char query[1024];
+	V_snprintf(query, sizeof(query), sql_times_getlegacymetadata, METADATA_CONVERSION_BATCH_SIZE);
+	Transaction txn;
+	txn.queries.push_back(query);
+
+	auto onQuerySuccess = [onFinished, onFailure](std::vector<ISQLQuery *> queries)
+	{
+		ISQLResult *result = queries[0]->GetResultSet();
+		if (!GetDatabaseConnection())
+		{
+			return;
+		}
+		if (!result || result->GetRowCount() == 0)
+		{
+			onFinished();
+			return;
+		}
+
+		bool fullBatch = result->GetRowCount() >= METADATA_CONVERSION_BATCH_SIZE;
+		Transaction updateTxn;
+		std::vector<f64> times;
+		u8 splitCount, cpCount, stageCount;
+		std::string update;
+		while (result->FetchRow())
+		{
+			std::string metadata;
+			if (KZ::runmetadata::Decode(result->GetString(1), times, splitCount, cpCount, stageCount))
+			{
+				metadata = KZ::runmetadata::Encode(times.data(), splitCount, times.data() + splitCount, cpCount,
+												   times.data() + splitCount + cpCount, stageCount);
+			}
+			// Rows that can't be decoded are cleared, otherwise they would be picked up again by every batch.
+			update.resize(metadata.size() + 256);
+			V_snprintf(update.data(), update.size(), sql_times_updatemetadata, metadata.c_str(), result->GetInt64(0));
+			updateTxn.queries.push_back(update.c_str());
+		}
+		META_CONPRINTF("[KZ::DB] Converting %llu times to the binary metadata format.\n", (u64)updateTxn.queries.size());
+
+		GetDatabaseConnection()->ExecuteTransaction(
+			updateTxn,
+			[fullBatch, onFinished, onFailure](std::vector<ISQLQuery *> queries)
+			{
+				if (fullBatch)
+				{
+					KZDatabaseService::ConvertLegacyRunMetadata(onFinished, onFailure);
+				}
+				else
+				{
+					onFinished();
+				}
+			},
+			[onFailure](std::string error, int failIndex) { onFailure(); });
+	};
+	GetDatabaseConnection()->ExecuteTransaction(txn, onQuerySuccess, [onFailure](std::string error, int failIndex) { onFailure(); });
+}
+
 bool KZDatabaseService::IsReady()
 {
 	return localDBConnected;
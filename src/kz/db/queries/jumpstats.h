@@ -40,9 +40,73 @@ constexpr char mysql_jumpstats_create[] = R"(
         ON UPDATE CASCADE ON DELETE CASCADE)
 )";
 
-constexpr char sql_jumpstats_insert[] = R"(
+// Only the best jump per player, jump type, mode and block/no-block is kept.
+constexpr char sqlite_jumpstats_deduplicate[] = R"(
+    DELETE FROM Jumpstats 
+        WHERE EXISTS ( 
+            SELECT 1 
+                FROM Jumpstats b 
+                WHERE 
+                    b.SteamID64 = Jumpstats.SteamID64 AND 
+                    b.JumpType = Jumpstats.JumpType AND 
+                    b.Mode = Jumpstats.Mode AND 
+                    b.IsBlockJump = Jumpstats.IsBlockJump AND 
+                    (b.Block > Jumpstats.Block OR 
+                    (b.Block = Jumpstats.Block AND b.Distance > Jumpstats.Distance) OR 
+                    (b.Block = Jumpstats.Block AND b.Distance = Jumpstats.Distance AND b.ID > Jumpstats.ID)) 
+        )
+)";
+
+constexpr char mysql_jumpstats_deduplicate[] = R"(
+    DELETE j 
+        FROM Jumpstats j 
+        INNER JOIN Jumpstats b ON 
+            b.SteamID64 = j.SteamID64 AND 
+            b.JumpType = j.JumpType AND 
+            b.Mode = j.Mode AND 
+            b.IsBlockJump = j.IsBlockJump AND 
+            (b.Block > j.Block OR 
+            (b.Block = j.Block AND b.Distance > j.Distance) OR 
+            (b.Block = j.Block AND b.Distance = j.Distance AND b.ID > j.ID))
+)";
+
+constexpr char sql_jumpstats_create_pbindex[] = R"(
+    CREATE UNIQUE INDEX UQ_Jumpstats_PB 
+        ON Jumpstats (SteamID64, JumpType, Mode, IsBlockJump)
+)";
+
+// The stored row is only replaced by a better jump, the in-memory PB cache might not be loaded yet or be stale on a shared database.
+constexpr char sqlite_jumpstats_insert[] = R"(
+    INSERT INTO Jumpstats (SteamID64, JumpType, Mode, Distance, IsBlockJump, Block, Strafes, Sync, Pre, Max, Airtime) 
+        VALUES (%llu, %d, %d, %d, %d, %d, %d, %d, %d, %d, %d)
+        ON CONFLICT(SteamID64, JumpType, Mode, IsBlockJump) DO UPDATE SET
+            Distance = excluded.Distance, 
+            Block = excluded.Block, 
+            Strafes = excluded.Strafes, 
+            Sync = excluded.Sync, 
+            Pre = excluded.Pre, 
+            Max = excluded.Max, 
+            Airtime = excluded.Airtime, 
+            Created = CURRENT_TIMESTAMP 
+        WHERE 
+            excluded.Block > Jumpstats.Block OR 
+            (excluded.Block = Jumpstats.Block AND excluded.Distance > Jumpstats.Distance)
+)";
+
+// MySQL applies the assignments left to right and later ones see the updated values,
+// so Distance and Block come last and Block, which the Distance check depends on, is the very last.
+constexpr char mysql_jumpstats_insert[] = R"(
     INSERT INTO Jumpstats (SteamID64, JumpType, Mode, Distance, IsBlockJump, Block, Strafes, Sync, Pre, Max, Airtime) 
-        VALUES (%d, %d, %d, %d, %d, %d, %d, %d, %d, %d, %d)
+        VALUES (%llu, %d, %d, %d, %d, %d, %d, %d, %d, %d, %d)
+        ON DUPLICATE KEY UPDATE 
+            Strafes = IF(VALUES(Block) > Block OR (VALUES(Block) = Block AND VALUES(Distance) > Distance), VALUES(Strafes), Strafes), 
+            Sync = IF(VALUES(Block) > Block OR (VALUES(Block) = Block AND VALUES(Distance) > Distance), VALUES(Sync), Sync), 
+            Pre = IF(VALUES(Block) > Block OR (VALUES(Block) = Block AND VALUES(Distance) > Distance), VALUES(Pre), Pre), 
+            Max = IF(VALUES(Block) > Block OR (VALUES(Block) = Block AND VALUES(Distance) > Distance), VALUES(Max), Max), 
+            Airtime = IF(VALUES(Block) > Block OR (VALUES(Block) = Block AND VALUES(Distance) > Distance), VALUES(Airtime), Airtime), 
+            Created = IF(VALUES(Block) > Block OR (VALUES(Block) = Block AND VALUES(Distance) > Distance), CURRENT_TIMESTAMP, Created), 
+            Distance = IF(VALUES(Block) > Block OR (VALUES(Block) = Block AND VALUES(Distance) > Distance), VALUES(Distance), Distance), 
+            Block = IF(VALUES(Block) > Block, VALUES(Block), Block)
 )";
 
 constexpr char sql_jumpstats_update[] = R"(
@@ -231,3 +295,11 @@ constexpr char sql_jumpstats_ranking_getblockpbs[] = R"(
         WHERE b.SteamID64=c.SteamID64 AND b.Mode=c.Mode AND c.IsBlockJump 
         ORDER BY c.JumpType
 )";
+
+constexpr char sql_jumpstats_getallpbs[] = R"(
+    SELECT j.SteamID64, p.Alias, p.Cheater, j.JumpType, j.Mode, j.IsBlockJump, j.Block, j.Distance, j.Strafes, j.Sync, j.Pre, j.Max, j.Airtime 
+        FROM 
+            Jumpstats j 
+        INNER JOIN 
+            Players p ON p.SteamID64=j.SteamID64
+)";
@@ -0,0 +1,90 @@
+// =====[ SAVELOCS ]=====
+
+constexpr char sqlite_savelocs_create[] = R"(
+    CREATE TABLE IF NOT EXISTS Savelocs ( 
+        ID INTEGER NOT NULL, 
+        SteamID64 INTEGER NOT NULL, 
+        MapID INTEGER NOT NULL, 
+        X REAL NOT NULL, 
+        Y REAL NOT NULL, 
+        Z REAL NOT NULL, 
+        Angle0 REAL NOT NULL, 
+        Angle1 REAL NOT NULL, 
+        VelocityX REAL NOT NULL, 
+        VelocityY REAL NOT NULL, 
+        VelocityZ REAL NOT NULL, 
+        LadderNormalX REAL NOT NULL, 
+        LadderNormalY REAL NOT NULL, 
+        LadderNormalZ REAL NOT NULL, 
+        OnLadder INTEGER NOT NULL, 
+        SlopeDropOffset REAL NOT NULL, 
+        SlopeDropHeight REAL NOT NULL, 
+        Ducked INTEGER NOT NULL, 
+        DuckAmount REAL NOT NULL, 
+        MapCourseID INTEGER NOT NULL, 
+        RunTime REAL NOT NULL, 
+        Created TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP, 
+        CONSTRAINT PK_Savelocs PRIMARY KEY (ID), 
+        CONSTRAINT FK_Savelocs_SteamID64 FOREIGN KEY (SteamID64) REFERENCES Players(SteamID64), 
+        CONSTRAINT FK_Savelocs_MapID FOREIGN KEY (MapID) REFERENCES Maps(ID) 
+        ON UPDATE CASCADE ON DELETE CASCADE)
+)";
+
+constexpr char mysql_savelocs_create[] = R"(
+    CREATE TABLE IF NOT EXISTS Savelocs ( 
+        ID INTEGER UNSIGNED NOT NULL AUTO_INCREMENT, 
+        SteamID64 BIGINT UNSIGNED NOT NULL, 
+        MapID INTEGER UNSIGNED NOT NULL, 
+        X REAL NOT NULL, 
+        Y REAL NOT NULL, 
+        Z REAL NOT NULL, 
+        Angle0 REAL NOT NULL, 
+        Angle1 REAL NOT NULL, 
+        VelocityX REAL NOT NULL, 
+        VelocityY REAL NOT NULL, 
+        VelocityZ REAL NOT NULL, 
+        LadderNormalX REAL NOT NULL, 
+        LadderNormalY REAL NOT NULL, 
+        LadderNormalZ REAL NOT NULL, 
+        OnLadder TINYINT NOT NULL, 
+        SlopeDropOffset REAL NOT NULL, 
+        SlopeDropHeight REAL NOT NULL, 
+        Ducked TINYINT NOT NULL, 
+        DuckAmount REAL NOT NULL, 
+        MapCourseID INTEGER UNSIGNED NOT NULL, 
+        RunTime REAL NOT NULL, 
+        Created TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP, 
+        CONSTRAINT PK_Savelocs PRIMARY KEY (ID), 
+        CONSTRAINT FK_Savelocs_SteamID64 FOREIGN KEY (SteamID64) REFERENCES Players(SteamID64), 
+        CONSTRAINT FK_Savelocs_MapID FOREIGN KEY (MapID) REFERENCES Maps(ID) 
+        ON UPDATE CASCADE ON DELETE CASCADE)
+)";
+
+constexpr char sql_savelocs_insert[] = R"(
+    INSERT INTO Savelocs (SteamID64, MapID, X, Y, Z, Angle0, Angle1, VelocityX, VelocityY, VelocityZ, 
+        LadderNormalX, LadderNormalY, LadderNormalZ, OnLadder, SlopeDropOffset, SlopeDropHeight, Ducked, DuckAmount, MapCourseID, RunTime) 
+        VALUES (%llu, %d, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %d, %f, %f, %d, %f, %d, %.7f)
+)";
+
+// Only keeps the newest savelocs of a player on a map.
+constexpr char sql_savelocs_prune[] = R"(
+    DELETE FROM Savelocs 
+        WHERE SteamID64=%llu AND MapID=%d AND ID NOT IN (
+            SELECT ID FROM (
+                SELECT ID 
+                    FROM Savelocs 
+                    WHERE SteamID64=%llu AND MapID=%d 
+                    ORDER BY ID DESC 
+                    LIMIT %d
+            ) AS Newest
+        )
+)";
+
+constexpr char sql_savelocs_get[] = R"(
+    SELECT X, Y, Z, Angle0, Angle1, VelocityX, VelocityY, VelocityZ, 
+        LadderNormalX, LadderNormalY, LadderNormalZ, OnLadder, SlopeDropOffset, SlopeDropHeight, Ducked, DuckAmount, MapCourseID, RunTime 
+        FROM Savelocs 
+        WHERE SteamID64=%llu AND MapID=%d 
+        ORDER BY ID DESC 
+        LIMIT %d
+)";
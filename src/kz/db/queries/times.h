@@ -46,6 +46,24 @@ constexpr char sql_times_insert[] = R"(
         VALUES (%llu, %d, %d, %llu, %.7f, %llu, '%s')
 )";
 
+constexpr char sql_times_getlegacymetadata[] = R"(
+    SELECT ID, Metadata 
+        FROM Times 
+        WHERE Metadata LIKE '{%%' 
+        LIMIT %d
+)";
+
+constexpr char sql_times_updatemetadata[] = R"(
+    UPDATE Times 
+        SET Metadata='%s' 
+        WHERE ID=%lld
+)";
+
+// Migration marker, does nothing by itself. See ConvertLegacyRunMetadata.
+constexpr char sql_times_legacymetadata_converted[] = R"(
+    SELECT 1
+)";
+
 constexpr char sql_times_delete[] = R"(
     DELETE FROM Times 
         WHERE ID=%d
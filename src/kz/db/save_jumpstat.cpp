@@ -0,0 +1,50 @@
+#include "kz_db.h"
+#include "queries/jumpstats.h"
+#include "vendor/sql_mm/src/public/sql_mm.h"
+
+using namespace KZ::Database;
+
+void KZDatabaseService::SaveJumpstat(JumpType jumpType, i32 modeID, f64 distance, u32 block, u32 strafes, f32 sync, f32 pre, f32 max,
+									 f32 airTime)
+{
+	if (!KZDatabaseService::IsReady() || !this->IsSetup())
+	{
+		return;
+	}
+
+	char query[2048];
+	Transaction txn;
+	u64 steamID64 = this->player->GetSteamId64();
+	// Replaces the previous PB of the same jump type, mode and block/no-block.
+	const char *insert = GetDatabaseType() == DatabaseType::MySQL ? mysql_jumpstats_insert : sqlite_jumpstats_insert;
+	V_snprintf(query, sizeof(query), insert, steamID64, jumpType, modeID, (i32)round(distance * KZ_DB_JS_DISTANCE_PRECISION), block > 0, block,
+			   strafes, (i32)round(sync * KZ_DB_JS_SYNC_PRECISION), (i32)round(pre * KZ_DB_JS_SPEED_PRECISION),
+			   (i32)round(max * KZ_DB_JS_SPEED_PRECISION), (i32)round(airTime * KZ_DB_JS_AIRTIME_PRECISION));
+	txn.queries.push_back(query);
+
+	CPlayerUserId userID = this->player->GetClient()->GetUserID();
+	GetDatabaseConnection()->ExecuteTransaction(
+		txn,
+		[=](std::vector<ISQLQuery *> queries)
+		{
+			KZPlayer *pl = g_pKZPlayerManager->ToPlayer(userID);
+			if (!pl)
+			{
+				return;
+			}
+			CALL_FORWARD(KZDatabaseService::eventListeners, OnJumpstatPB, pl, jumpType, modeID, distance, block, strafes, sync, pre, max, airTime);
+		},
+		OnGenericTxnFailure);
+}
+
+void KZDatabaseService::QueryAllJumpstatPBs(TransactionSuccessCallbackFunc onSuccess, TransactionFailureCallbackFunc onFailure)
+{
+	if (!KZDatabaseService::IsReady())
+	{
+		return;
+	}
+
+	Transaction txn;
+	txn.queries.push_back(sql_jumpstats_getallpbs);
+	GetDatabaseConnection()->ExecuteTransaction(txn, onSuccess, onFailure);
+}
@@ -5,6 +5,14 @@
 
 #include "queries/players.h"
 
+struct PendingPrefs
+{
+	u64 steamID64;
+	CUtlString prefs;
+};
+
+static_global CUtlVector<PendingPrefs> pendingPrefs;
+
 void KZDatabaseService::SavePrefs(CUtlString prefs)
 {
 	if (!KZDatabaseService::IsReady() || !this->IsSetup())
@@ -12,14 +20,36 @@ void KZDatabaseService::SavePrefs(CUtlString prefs)
 		return;
 	}
 	u64 steamID64 = this->player->GetSteamId64();
-	std::string cleanedPrefs = KZDatabaseService::GetDatabaseConnection()->Escape(prefs);
+	std::string cleanedPrefs = KZDatabaseService::GetDatabaseConnection()->Escape(prefs.Get());
+
+	// Only the latest preferences of each player are worth writing.
+	FOR_EACH_VEC(pendingPrefs, i)
+	{
+		if (pendingPrefs[i].steamID64 == steamID64)
+		{
+			pendingPrefs[i].prefs = cleanedPrefs.c_str();
+			return;
+		}
+	}
+	pendingPrefs.AddToTail({steamID64, cleanedPrefs.c_str()});
+}
+
+void KZDatabaseService::FlushPrefs()
+{
+	if (pendingPrefs.Count() == 0 || !KZDatabaseService::IsReady())
+	{
+		return;
+	}
 
 	Transaction txn;
 
 	CUtlString query;
-	query.Format(sql_players_set_prefs, prefs.Get(), steamID64);
-
-	txn.queries.push_back(query.Get());
+	FOR_EACH_VEC(pendingPrefs, i)
+	{
+		query.Format(sql_players_set_prefs, pendingPrefs[i].prefs.Get(), pendingPrefs[i].steamID64);
+		txn.queries.push_back(query.Get());
+	}
+	pendingPrefs.RemoveAll();
 
 	KZDatabaseService::GetDatabaseConnection()->ExecuteTransaction(txn, OnGenericTxnSuccess, OnGenericTxnFailure);
 }
@@ -80,6 +80,7 @@ void KZDatabaseService::SetupClient()
 				bool isCheater = (result->FetchRow() && result->GetInt(0) == 1);
 				const char *prefs = result->GetString(1);
 				this->isSetUp = true;
+				this->isCheater = isCheater;
 				pl->optionService->InitializeLocalPrefs(prefs);
 				CALL_FORWARD(KZDatabaseService::eventListeners, OnClientSetup, pl, pl->GetSteamId64(), isCheater);
 			}
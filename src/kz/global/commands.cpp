@@ -144,3 +144,13 @@ SCMD(kz_globalcheck, SCFL_GLOBAL | SCFL_MAP | SCFL_PLAYER)
 }
 
 SCMD_LINK(kz_gc, kz_globalcheck);
+
+CON_COMMAND_F(kz_global_queue_stats, "Print main thread callback queue metrics of the global service", FCVAR_NONE)
+{
+	KZGlobalService::MainThreadQueueStats stats = KZGlobalService::GetMainThreadQueueStats();
+	META_CONPRINTF("[KZ::Global] Main thread callback queue:\n");
+	META_CONPRINTF("  depth: %u/%u (pending: %u)\n", stats.depth, stats.capacity, stats.pending);
+	META_CONPRINTF("  pushed: %llu, overflowed: %llu, executed: %llu\n", stats.pushed, stats.overflowed, stats.executed);
+	META_CONPRINTF("  drain time: last %lluus, max %lluus, budget %lluus (exceeded on %llu ticks)\n", stats.lastDrainMicroseconds,
+				   stats.maxDrainMicroseconds, stats.drainBudgetMicroseconds, stats.budgetExceededTicks);
+}
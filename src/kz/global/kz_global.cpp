@@ -4,6 +4,7 @@
 #pragma comment(lib, "Crypt32.Lib")
 #endif
 
+#include <algorithm>
 #include <string_view>
 
 #include <ixwebsocket/IXNetSystem.h>
@@ -90,8 +91,10 @@ void KZGlobalService::Init()
 
 	META_CONPRINTF("[KZ::Global] Initializing GlobalService...\n");
 
-	std::string url = KZOptionService::GetOptionStr("apiUrl", "https://api.cs2kz.org");
-	std::string_view key = KZOptionService::GetOptionStr("apiKey");
+	KZGlobalService::mainThreadCallbacks.drainBudgetMicroseconds = MAX(KZOptionService::GetConfig().mainThreadCallbackBudget, 0);
+
+	std::string url = KZOptionService::GetConfig().apiUrl.Get();
+	std::string_view key = KZOptionService::GetConfig().apiKey.Get();
 
 	if (url.empty())
 	{
@@ -171,29 +174,120 @@ void KZGlobalService::Cleanup()
 
 void KZGlobalService::OnServerGamePostSimulate()
 {
-	std::vector<std::function<void()>> callbacks;
+	auto &callbacks = KZGlobalService::mainThreadCallbacks;
+	bool ringUsable = true;
 
 	{
-		std::unique_lock lock(KZGlobalService::mainThreadCallbacks.mutex, std::defer_lock);
+		std::unique_lock lock(callbacks.mutex, std::defer_lock);
 
 		if (lock.try_lock())
 		{
-			KZGlobalService::mainThreadCallbacks.queue.swap(callbacks);
-
-			if (KZGlobalService::state.load() == KZGlobalService::State::HandshakeCompleted)
+			bool connected = KZGlobalService::state.load() == KZGlobalService::State::HandshakeCompleted;
+			if (!callbacks.overflowQueue.empty() || (connected && !callbacks.whenConnectedQueue.empty()))
 			{
-				callbacks.reserve(callbacks.size() + KZGlobalService::mainThreadCallbacks.whenConnectedQueue.size());
-				callbacks.insert(callbacks.end(), KZGlobalService::mainThreadCallbacks.whenConnectedQueue.begin(),
-								 KZGlobalService::mainThreadCallbacks.whenConnectedQueue.end());
-				KZGlobalService::mainThreadCallbacks.whenConnectedQueue.clear();
+				// The ring only holds callbacks queued before the first overflowed one, so the ring goes first.
+				// Callbacks that waited for the connection are merged in by the order they were queued in.
+				std::vector<QueuedCallback> ordered;
+				QueuedCallback queued;
+				while (callbacks.queue.TryPop(queued))
+				{
+					ordered.emplace_back(std::move(queued));
+				}
+				for (QueuedCallback &callback : callbacks.overflowQueue)
+				{
+					ordered.emplace_back(std::move(callback));
+				}
+				callbacks.overflowQueue.clear();
+				callbacks.overflowing.store(false, std::memory_order_release);
+
+				if (connected && !callbacks.whenConnectedQueue.empty())
+				{
+					for (QueuedCallback &callback : callbacks.whenConnectedQueue)
+					{
+						ordered.emplace_back(std::move(callback));
+					}
+					callbacks.whenConnectedQueue.clear();
+					std::stable_sort(ordered.begin(), ordered.end(),
+									 [](const QueuedCallback &a, const QueuedCallback &b) { return a.sequence < b.sequence; });
+				}
+
+				for (QueuedCallback &callback : ordered)
+				{
+					callbacks.pending.emplace_back(std::move(callback.callback));
+				}
 			}
 		}
+		else
+		{
+			// Callbacks in the ring are newer than the overflowed ones we can't get to this tick.
+			ringUsable = !callbacks.overflowing.load(std::memory_order_acquire);
+		}
 	}
 
-	for (const std::function<void()> &callback : callbacks)
+	auto start = std::chrono::steady_clock::now();
+	u64 elapsed = 0;
+	u64 executed = 0;
+	bool outOfBudget = false;
+	MainThreadCallback callback;
+	QueuedCallback queued;
+
+	// Leftovers from previous ticks go first, then whatever got queued since.
+	while (true)
 	{
+		if (executed > 0 && callbacks.drainBudgetMicroseconds > 0 && elapsed >= callbacks.drainBudgetMicroseconds)
+		{
+			outOfBudget = !callbacks.pending.empty() || (ringUsable && callbacks.queue.Size() > 0);
+			break;
+		}
+
+		if (!callbacks.pending.empty())
+		{
+			callback = std::move(callbacks.pending.front());
+			callbacks.pending.pop_front();
+		}
+		else if (ringUsable && callbacks.queue.TryPop(queued))
+		{
+			callback = std::move(queued.callback);
+		}
+		else
+		{
+			break;
+		}
+
 		callback();
+		callback.Reset();
+		executed++;
+		elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
 	}
+
+	if (executed > 0)
+	{
+		callbacks.executed += executed;
+		callbacks.lastDrainMicroseconds = elapsed;
+		callbacks.maxDrainMicroseconds = MAX(callbacks.maxDrainMicroseconds, elapsed);
+	}
+
+	if (outOfBudget)
+	{
+		callbacks.budgetExceededTicks++;
+	}
+}
+
+KZGlobalService::MainThreadQueueStats KZGlobalService::GetMainThreadQueueStats()
+{
+	auto &callbacks = KZGlobalService::mainThreadCallbacks;
+	MainThreadQueueStats stats;
+	stats.depth = callbacks.queue.Size();
+	stats.pending = (u32)callbacks.pending.size();
+	stats.capacity = callbacks.queue.GetCapacity();
+	stats.pushed = callbacks.pushed.load(std::memory_order_relaxed);
+	stats.overflowed = callbacks.overflowed.load(std::memory_order_relaxed);
+	stats.executed = callbacks.executed;
+	stats.budgetExceededTicks = callbacks.budgetExceededTicks;
+	stats.lastDrainMicroseconds = callbacks.lastDrainMicroseconds;
+	stats.maxDrainMicroseconds = callbacks.maxDrainMicroseconds;
+	stats.drainBudgetMicroseconds = callbacks.drainBudgetMicroseconds;
+	return stats;
 }
 
 void KZGlobalService::OnActivateServer()
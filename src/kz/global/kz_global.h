@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <deque>
 #include <mutex>
 #include <string>
 #include <string_view>
@@ -9,7 +10,9 @@
 
 #include <vendor/ixwebsocket/ixwebsocket/IXWebSocket.h>
 
+#include "utils/inplacefunction.h"
 #include "utils/json.h"
+#include "utils/mpscqueue.h"
 
 #include "kz/kz.h"
 #include "kz/global/api.h"
@@ -87,6 +90,30 @@ public:
 	 */
 	static void UpdateRecordCache();
 
+	/**
+	 * Snapshot of the main thread callback queue metrics.
+	 */
+	struct MainThreadQueueStats
+	{
+		u32 depth;
+		u32 pending;
+		u32 capacity;
+		u64 pushed;
+		u64 overflowed;
+		u64 executed;
+		u64 budgetExceededTicks;
+		u64 lastDrainMicroseconds;
+		u64 maxDrainMicroseconds;
+		u64 drainBudgetMicroseconds;
+	};
+
+	/**
+	 * Returns the current main thread callback queue metrics.
+	 *
+	 * Has to be called from the main thread.
+	 */
+	static MainThreadQueueStats GetMainThreadQueueStats();
+
 public:
 	static void Init();
 	static void Cleanup();
@@ -281,19 +308,67 @@ private:
 	 */
 	static inline std::atomic<State> state = State::Uninitialized;
 
+	using MainThreadCallback = InplaceFunction<void(), 64>;
+
+	struct QueuedCallback
+	{
+		/**
+		 * Order in which the callback was queued, used to keep FIFO order across the different queues
+		 */
+		u64 sequence;
+		MainThreadCallback callback;
+	};
+
 	static inline struct
 	{
+		/**
+		 * Callbacks to execute on the main thread as soon as possible
+		 */
+		MPSCQueue<QueuedCallback, 1024> queue;
+
+		/**
+		 * Protects `overflowQueue` and `whenConnectedQueue`
+		 */
 		std::mutex mutex;
 
 		/**
-		 * Callbacks to execute on the main thread as soon as possible
+		 * Callbacks that did not fit into `queue` because it was full.
+		 *
+		 * While this is not empty, new callbacks are appended here instead of to `queue` so they can't overtake older ones.
+		 */
+		std::vector<QueuedCallback> overflowQueue;
+
+		/**
+		 * Whether `overflowQueue` is not empty, readable without taking the mutex
 		 */
-		std::vector<std::function<void()>> queue;
+		std::atomic<bool> overflowing;
 
 		/**
 		 * Callbacks to execute on the main thread as soon as we are fully connected to the API
 		 */
-		std::vector<std::function<void()>> whenConnectedQueue;
+		std::vector<QueuedCallback> whenConnectedQueue;
+
+		/**
+		 * Callbacks taken out of the shared queues that did not fit into the previous ticks' budget.
+		 *
+		 * Only accessed from the main thread.
+		 */
+		std::deque<MainThreadCallback> pending;
+
+		/**
+		 * How much time we are allowed to spend running callbacks every tick, 0 means no limit.
+		 *
+		 * At least one callback always runs per tick so the queue can't stall.
+		 */
+		u64 drainBudgetMicroseconds = 2000;
+
+		std::atomic<u64> sequence;
+		std::atomic<u64> pushed;
+		std::atomic<u64> overflowed;
+		u64 executed;
+		u64 budgetExceededTicks;
+		u64 lastDrainMicroseconds;
+		u64 maxDrainMicroseconds;
 	} mainThreadCallbacks {};
 
 	// invariant: should be `nullptr` if `state == Uninitialized` and otherwise a valid pointer
@@ -373,8 +448,24 @@ private:
 	template<typename CB>
 	static void AddMainThreadCallback(CB &&callback)
 	{
-		std::unique_lock lock(KZGlobalService::mainThreadCallbacks.mutex);
-		KZGlobalService::mainThreadCallbacks.queue.emplace_back(std::move(callback));
+		auto &callbacks = KZGlobalService::mainThreadCallbacks;
+		QueuedCallback cb {callbacks.sequence.fetch_add(1, std::memory_order_relaxed), MainThreadCallback(std::forward<CB>(callback))};
+		callbacks.pushed.fetch_add(1, std::memory_order_relaxed);
+
+		if (!callbacks.overflowing.load(std::memory_order_acquire) && callbacks.queue.TryPush(std::move(cb)))
+		{
+			return;
+		}
+
+		std::unique_lock lock(callbacks.mutex);
+		// The overflow might have been drained in the meantime, the ring is fine again if it was.
+		if (callbacks.overflowQueue.empty() && callbacks.queue.TryPush(std::move(cb)))
+		{
+			return;
+		}
+		callbacks.overflowed.fetch_add(1, std::memory_order_relaxed);
+		callbacks.overflowQueue.emplace_back(std::move(cb));
+		callbacks.overflowing.store(true, std::memory_order_release);
 	}
 
 	/**
@@ -383,8 +474,10 @@ private:
 	template<typename CB>
 	static void AddWhenConnectedCallback(CB &&callback)
 	{
-		std::unique_lock lock(KZGlobalService::mainThreadCallbacks.mutex);
-		KZGlobalService::mainThreadCallbacks.whenConnectedQueue.emplace_back(std::move(callback));
+		auto &callbacks = KZGlobalService::mainThreadCallbacks;
+		QueuedCallback cb {callbacks.sequence.fetch_add(1, std::memory_order_relaxed), MainThreadCallback(std::forward<CB>(callback))};
+		std::unique_lock lock(callbacks.mutex);
+		callbacks.whenConnectedQueue.emplace_back(std::move(cb));
 	}
 
 	/**
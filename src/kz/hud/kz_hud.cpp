@@ -36,7 +36,7 @@ void KZHUDService::Init()
 
 void KZHUDService::Reset()
 {
-	this->showPanel = this->player->optionService->GetPreferenceBool("showPanel", true);
+	this->showPanel = this->player->optionService->GetPreference(KZ::pref::showPanel, true);
 	this->timerStoppedTime = {};
 	this->currentTimeWhenTimerStopped = {};
 }
@@ -155,13 +155,13 @@ void KZHUDService::DrawPanels(KZPlayer *player, KZPlayer *target)
 
 void KZHUDService::ResetShowPanel()
 {
-	this->showPanel = this->player->optionService->GetPreferenceBool("showPanel", true);
+	this->showPanel = this->player->optionService->GetPreference(KZ::pref::showPanel, true);
 }
 
 void KZHUDService::TogglePanel()
 {
 	this->showPanel = !this->showPanel;
-	this->player->optionService->SetPreferenceBool("showPanel", this->showPanel);
+	this->player->optionService->SetPreference(KZ::pref::showPanel, this->showPanel);
 	if (!this->showPanel)
 	{
 		utils::PrintAlert(this->player->GetController(), "#SFUI_EmptyString");
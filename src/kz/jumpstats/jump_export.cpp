@@ -0,0 +1,388 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <thread>
+
+#include "../kz.h"
+#include "kz_jumpstats.h"
+#include "jump_export.h"
+#include "../mode/kz_mode.h"
+#include "../option/kz_option.h"
+#include "utils/mpscqueue.h"
+
+#include "tier0/memdbgon.h"
+
+// Strafes past this are counted but not exported.
+#define JUMP_EXPORT_MAX_STRAFES 32
+#define JUMP_EXPORT_QUEUE_SIZE  256
+// How long the writer sleeps when there is nothing to write.
+#define JUMP_EXPORT_IDLE_TIME   std::chrono::milliseconds(100)
+
+struct JumpExportStrafe
+{
+	f32 duration;
+	f32 sync;
+	f32 gain;
+	f32 loss;
+	f32 externalGain;
+	f32 externalLoss;
+	f32 maxGain;
+	f32 maxSpeed;
+	f32 width;
+	f32 badAngles;
+	f32 overlap;
+	f32 deadAir;
+	f32 ratioAverage;
+	f32 ratioMedian;
+	f32 ratioMax;
+	i32 aaCalls;
+	i8 turnstate;
+	bool ratioAvailable;
+};
+
+struct JumpExportRecord
+{
+	u64 id;
+	u64 steamID64;
+	i64 timestamp;
+	i32 tickcount;
+	char map[64];
+	char mode[16];
+	JumpType jumpType;
+	bool valid;
+	f32 distance;
+	f32 offset;
+	f32 pre;
+	f32 max;
+	f32 height;
+	f32 airTime;
+	f32 sync;
+	f32 badAngles;
+	f32 overlap;
+	f32 deadAir;
+	f32 width;
+	f32 gainEfficiency;
+	f32 airPath;
+	f32 deviation;
+	f32 release;
+	f32 duckTime;
+	f32 duckEndTime;
+	i32 strafeCount;
+	JumpExportStrafe strafes[JUMP_EXPORT_MAX_STRAFES];
+};
+
+enum JumpExportFormat : u8
+{
+	EXPORT_NONE = 0,
+	EXPORT_NDJSON,
+	EXPORT_CSV
+};
+
+static_global struct
+{
+	JumpExportFormat format;
+	i64 maxFileSize;
+	u64 nextID;
+	std::thread writer;
+	std::atomic<bool> running;
+	std::atomic<u64> exported;
+	std::atomic<u64> dropped;
+	MPSCQueue<JumpExportRecord, JUMP_EXPORT_QUEUE_SIZE> queue;
+} jumpExport;
+
+// Opens a data file for appending, rotating it to <name>.1 once it grows past the size limit.
+static_function FILE *OpenExportFile(const char *fileName, const char *csvHeader)
+{
+	char path[1024];
+	char oldPath[1024];
+	g_SMAPI->PathFormat(path, sizeof(path), "%s/addons/cs2kz/data/%s", g_SMAPI->GetBaseDir(), fileName);
+	g_SMAPI->PathFormat(oldPath, sizeof(oldPath), "%s/addons/cs2kz/data/%s.1", g_SMAPI->GetBaseDir(), fileName);
+
+	FILE *file = fopen(path, "a");
+	if (!file)
+	{
+		return nullptr;
+	}
+	fseek(file, 0, SEEK_END);
+	if (ftell(file) >= jumpExport.maxFileSize)
+	{
+		fclose(file);
+		remove(oldPath);
+		rename(path, oldPath);
+		file = fopen(path, "a");
+	}
+	if (file && csvHeader && ftell(file) == 0)
+	{
+		fputs(csvHeader, file);
+	}
+	return file;
+}
+
+// Write a string as a quoted JSON string, map and mode names come from outside the plugin and can contain anything.
+static_function void WriteJSONString(FILE *file, const char *str)
+{
+	fputc('"', file);
+	for (const char *c = str; *c; c++)
+	{
+		switch (*c)
+		{
+			case '"':
+				fputs("\\\"", file);
+				break;
+			case '\\':
+				fputs("\\\\", file);
+				break;
+			case '\n':
+				fputs("\\n", file);
+				break;
+			case '\r':
+				fputs("\\r", file);
+				break;
+			case '\t':
+				fputs("\\t", file);
+				break;
+			default:
+				if ((u8)*c < 0x20)
+				{
+					fprintf(file, "\\u%04x", (u8)*c);
+				}
+				else
+				{
+					fputc(*c, file);
+				}
+		}
+	}
+	fputc('"', file);
+}
+
+// Write a string as a quoted CSV field, embedded quotes are doubled.
+static_function void WriteCSVString(FILE *file, const char *str)
+{
+	fputc('"', file);
+	for (const char *c = str; *c; c++)
+	{
+		if (*c == '"')
+		{
+			fputc('"', file);
+		}
+		fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+static_function void WriteNDJSON(FILE *file, const JumpExportRecord &record)
+{
+	// clang-format off
+	fprintf(file, "{\"id\":%llu,\"steamid64\":\"%llu\",\"time\":%lld,\"tick\":%i,\"map\":", record.id, record.steamID64, record.timestamp,
+		record.tickcount);
+	WriteJSONString(file, record.map);
+	fputs(",\"mode\":", file);
+	WriteJSONString(file, record.mode);
+	fprintf(file,
+		",\"type\":\"%s\",\"valid\":%s,"
+		"\"distance\":%.4f,\"offset\":%.4f,\"pre\":%.2f,\"max\":%.2f,\"height\":%.2f,\"airtime\":%.4f,\"sync\":%.4f,"
+		"\"bad_angles\":%.4f,\"overlap\":%.4f,\"dead_air\":%.4f,\"width\":%.2f,\"gain_eff\":%.4f,\"airpath\":%.4f,"
+		"\"deviation\":%.2f,\"release\":%.4f,\"duck_time\":%.4f,\"duck_end_time\":%.4f,\"strafe_count\":%i,\"strafes\":[",
+		jumpTypeShortStr[record.jumpType], record.valid ? "true" : "false", record.distance, record.offset, record.pre, record.max, record.height,
+		record.airTime, record.sync, record.badAngles, record.overlap, record.deadAir, record.width, record.gainEfficiency, record.airPath,
+		record.deviation, record.release, record.duckTime, record.duckEndTime, record.strafeCount);
+	for (i32 i = 0; i < MIN(record.strafeCount, JUMP_EXPORT_MAX_STRAFES); i++)
+	{
+		const JumpExportStrafe &strafe = record.strafes[i];
+		fprintf(file,
+			"%s{\"duration\":%.4f,\"sync\":%.4f,\"gain\":%.4f,\"loss\":%.4f,\"external_gain\":%.4f,\"external_loss\":%.4f,"
+			"\"max_gain\":%.4f,\"max_speed\":%.2f,\"width\":%.2f,\"bad_angles\":%.4f,\"overlap\":%.4f,\"dead_air\":%.4f,"
+			"\"aa_calls\":%i,\"turn\":%i",
+			i ? "," : "", strafe.duration, strafe.sync, strafe.gain, strafe.loss, strafe.externalGain, strafe.externalLoss, strafe.maxGain,
+			strafe.maxSpeed, strafe.width, strafe.badAngles, strafe.overlap, strafe.deadAir, strafe.aaCalls, strafe.turnstate);
+		if (strafe.ratioAvailable)
+		{
+			fprintf(file, ",\"ratio_avg\":%.4f,\"ratio_median\":%.4f,\"ratio_max\":%.4f", strafe.ratioAverage, strafe.ratioMedian, strafe.ratioMax);
+		}
+		fputc('}', file);
+	}
+	fputs("]}\n", file);
+	// clang-format on
+}
+
+static_function void WriteCSV(FILE *jumpFile, FILE *strafeFile, const JumpExportRecord &record)
+{
+	// clang-format off
+	fprintf(jumpFile, "%llu,%llu,%lld,%i,", record.id, record.steamID64, record.timestamp, record.tickcount);
+	WriteCSVString(jumpFile, record.map);
+	fputc(',', jumpFile);
+	WriteCSVString(jumpFile, record.mode);
+	fprintf(jumpFile, ",%s,%i,%.4f,%.4f,%.2f,%.2f,%.2f,%.4f,%.4f,%.4f,%.4f,%.4f,%.2f,%.4f,%.4f,%.2f,%.4f,%.4f,%.4f,%i\n",
+		jumpTypeShortStr[record.jumpType], record.valid, record.distance, record.offset, record.pre, record.max, record.height, record.airTime,
+		record.sync, record.badAngles, record.overlap, record.deadAir, record.width, record.gainEfficiency, record.airPath, record.deviation,
+		record.release, record.duckTime, record.duckEndTime, record.strafeCount);
+	for (i32 i = 0; i < MIN(record.strafeCount, JUMP_EXPORT_MAX_STRAFES); i++)
+	{
+		const JumpExportStrafe &strafe = record.strafes[i];
+		fprintf(strafeFile, "%llu,%i,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.2f,%.2f,%.4f,%.4f,%.4f,%i,%i,%i,%.4f,%.4f,%.4f\n",
+			record.id, i, strafe.duration, strafe.sync, strafe.gain, strafe.loss, strafe.externalGain, strafe.externalLoss, strafe.maxGain,
+			strafe.maxSpeed, strafe.width, strafe.badAngles, strafe.overlap, strafe.deadAir, strafe.aaCalls, strafe.turnstate,
+			strafe.ratioAvailable, strafe.ratioAverage, strafe.ratioMedian, strafe.ratioMax);
+	}
+	// clang-format on
+}
+
+static_function void WriteRecords()
+{
+	JumpExportRecord *record = new JumpExportRecord();
+	while (jumpExport.running.load(std::memory_order_acquire) || jumpExport.queue.Size() > 0)
+	{
+		if (!jumpExport.queue.TryPop(*record))
+		{
+			std::this_thread::sleep_for(JUMP_EXPORT_IDLE_TIME);
+			continue;
+		}
+
+		// Reopen the files for every batch so rotation and external truncation are picked up.
+		FILE *jumpFile = nullptr;
+		FILE *strafeFile = nullptr;
+		if (jumpExport.format == EXPORT_NDJSON)
+		{
+			jumpFile = OpenExportFile("jumps.ndjson", nullptr);
+		}
+		else
+		{
+			jumpFile = OpenExportFile("jumps.csv", "id,steamid64,time,tick,map,mode,type,valid,distance,offset,pre,max,height,airtime,sync,"
+												   "bad_angles,overlap,dead_air,width,gain_eff,airpath,deviation,release,duck_time,"
+												   "duck_end_time,strafe_count\n");
+			strafeFile = OpenExportFile("strafes.csv", "jump_id,strafe,duration,sync,gain,loss,external_gain,external_loss,max_gain,"
+													   "max_speed,width,bad_angles,overlap,dead_air,aa_calls,turn,ratio_available,ratio_avg,"
+													   "ratio_median,ratio_max\n");
+		}
+
+		do
+		{
+			if (jumpFile && jumpExport.format == EXPORT_NDJSON)
+			{
+				WriteNDJSON(jumpFile, *record);
+			}
+			else if (jumpFile && strafeFile)
+			{
+				WriteCSV(jumpFile, strafeFile, *record);
+			}
+			jumpExport.exported.fetch_add(1, std::memory_order_relaxed);
+		} while (jumpExport.queue.TryPop(*record));
+
+		if (jumpFile)
+		{
+			fclose(jumpFile);
+		}
+		if (strafeFile)
+		{
+			fclose(strafeFile);
+		}
+	}
+	delete record;
+}
+
+void KZ::jumpexport::Init()
+{
+	const char *format = KZOptionService::GetConfig().jumpExportFormat.Get();
+	if (KZ_STREQI(format, "ndjson"))
+	{
+		jumpExport.format = EXPORT_NDJSON;
+	}
+	else if (KZ_STREQI(format, "csv"))
+	{
+		jumpExport.format = EXPORT_CSV;
+	}
+	else
+	{
+		jumpExport.format = EXPORT_NONE;
+		return;
+	}
+	jumpExport.maxFileSize = MAX(KZOptionService::GetConfig().jumpExportMaxFileSize, 1) * 1024 * 1024;
+	// Keep IDs unique across restarts.
+	jumpExport.nextID = (u64)time(nullptr) * 1000000;
+	jumpExport.running.store(true, std::memory_order_release);
+	jumpExport.writer = std::thread(WriteRecords);
+}
+
+void KZ::jumpexport::Cleanup()
+{
+	if (!jumpExport.writer.joinable())
+	{
+		return;
+	}
+	jumpExport.running.store(false, std::memory_order_release);
+	jumpExport.writer.join();
+}
+
+void KZ::jumpexport::Submit(Jump *jump)
+{
+	if (jumpExport.format == EXPORT_NONE)
+	{
+		return;
+	}
+
+	// Stays alive for the whole session, records are too big to build on the stack every jump.
+	static_persist JumpExportRecord record;
+	KZPlayer *player = jump->GetJumpPlayer();
+	record.id = jumpExport.nextID++;
+	record.steamID64 = player->GetSteamId64();
+	record.timestamp = (i64)time(nullptr);
+	record.tickcount = g_pKZUtils->GetServerGlobals()->tickcount;
+	V_strncpy(record.map, g_pKZUtils->GetCurrentMapName().Get(), sizeof(record.map));
+	V_strncpy(record.mode, player->modeService->GetModeShortName(), sizeof(record.mode));
+	record.jumpType = jump->GetJumpType();
+	record.valid = jump->IsValid();
+	record.distance = jump->GetDistance();
+	record.offset = jump->GetOffset();
+	record.pre = jump->GetTakeoffSpeed();
+	record.max = jump->GetMaxSpeed();
+	record.height = jump->GetMaxHeight();
+	record.airTime = player->landingTimeActual - player->takeoffTime;
+	record.sync = jump->GetSync();
+	record.badAngles = jump->GetBadAngles();
+	record.overlap = jump->GetOverlap();
+	record.deadAir = jump->GetDeadAir();
+	record.width = jump->GetWidth();
+	record.gainEfficiency = jump->GetGainEfficiency();
+	record.airPath = jump->GetAirPath();
+	record.deviation = jump->GetDeviation();
+	record.release = jump->GetRelease();
+	record.duckTime = jump->GetDuckTime(false);
+	record.duckEndTime = jump->GetDuckTime(true);
+	record.strafeCount = jump->strafes.Count();
+	for (i32 i = 0; i < MIN(record.strafeCount, JUMP_EXPORT_MAX_STRAFES); i++)
+	{
+		Strafe &strafe = jump->strafes[i];
+		JumpExportStrafe &out = record.strafes[i];
+		out.duration = strafe.GetStrafeDuration();
+		out.sync = strafe.GetSync();
+		out.gain = strafe.GetGain();
+		out.loss = strafe.GetLoss();
+		out.externalGain = strafe.GetGain(true);
+		out.externalLoss = strafe.GetLoss(true);
+		out.maxGain = strafe.GetMaxGain();
+		out.maxSpeed = strafe.GetStrafeMaxSpeed();
+		out.width = strafe.GetWidth();
+		out.badAngles = strafe.GetBadAngleDuration();
+		out.overlap = strafe.GetOverlapDuration();
+		out.deadAir = strafe.GetDeadAirDuration();
+		out.aaCalls = strafe.aaCallCount;
+		out.turnstate = (i8)strafe.turnstate;
+		out.ratioAvailable = strafe.arStats.available;
+		out.ratioAverage = strafe.arStats.available ? strafe.arStats.average : 0.0f;
+		out.ratioMedian = strafe.arStats.available ? strafe.arStats.median : 0.0f;
+		out.ratioMax = strafe.arStats.available ? strafe.arStats.max : 0.0f;
+	}
+
+	if (!jumpExport.queue.TryPush(record))
+	{
+		jumpExport.dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+CON_COMMAND_F(kz_jump_export_stats, "Print jump export status", FCVAR_NONE)
+{
+	const char *formats[] = {"disabled", "ndjson", "csv"};
+	META_CONPRINTF("[KZ::JumpExport] Format: %s, exported: %llu, dropped: %llu\n", formats[jumpExport.format],
+				   jumpExport.exported.load(std::memory_order_relaxed), jumpExport.dropped.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "common.h"
+
+class Jump;
+
+/*
+	Streams every ended jump to rotating files in addons/cs2kz/data for external analysis.
+
+	The game thread only copies a fixed-size record into a lock-free ring, a background thread formats and writes them.
+	Records are dropped instead of blocking when the writer can't keep up.
+	Enabled by the "jumpExportFormat" server option: "ndjson" writes jumps.ndjson with nested strafes,
+	"csv" writes jumps.csv and strafes.csv linked by the jump ID.
+*/
+
+namespace KZ::jumpexport
+{
+	void Init();
+	void Cleanup();
+	void Submit(Jump *jump);
+} // namespace KZ::jumpexport
@@ -0,0 +1,371 @@
+#include <unordered_map>
+
+#include "../kz.h"
+#include "utils/simplecmds.h"
+#include "utils/tables.h"
+
+#include "kz_jumpstats.h"
+#include "../db/kz_db.h"
+#include "../mode/kz_mode.h"
+#include "../option/kz_option.h"
+#include "../language/kz_language.h"
+
+#include "vendor/sql_mm/src/public/sql_mm.h"
+
+/*
+	Jumpstat leaderboards.
+
+	Every player's best jump per (jump type, mode, block jump) is loaded from the local database once when it is set up,
+	then kept up to date in memory as jumps land, so the top and PB commands never have to wait for a query.
+	Only new personal bests are written to the database.
+*/
+
+// clang-format off
+static_global const char *columnKeys[] = {
+	"#",
+	"Course Top Header - Player Alias",
+	"Distance",
+	"Block",
+	"Strafes",
+	"Sync",
+	"Pre",
+	"Max",
+	"Air Time"
+};
+
+static_global const char *pbColumnKeys[] = {
+	"Jump Type",
+	"Distance",
+	"Block",
+	"Strafes",
+	"Sync",
+	"Pre",
+	"Max",
+	"Air Time"
+};
+
+// clang-format on
+
+struct JumpstatRecord
+{
+	u64 steamID64;
+	CUtlString alias;
+	u32 block;
+	f64 distance;
+	u32 strafes;
+	f32 sync;
+	f32 pre;
+	f32 max;
+	f32 airTime;
+
+	bool IsBetterThan(const JumpstatRecord &other) const
+	{
+		if (this->block != other.block)
+		{
+			return this->block > other.block;
+		}
+		return this->distance > other.distance;
+	}
+};
+
+typedef u32 JumpstatLeaderboardKey;
+
+inline JumpstatLeaderboardKey ToLeaderboardKey(JumpType jumpType, i32 modeID, bool blockJump)
+{
+	return (u32)jumpType | ((u32)modeID << 8) | ((u32)blockJump << 16);
+}
+
+static_global class KZDatabaseServiceEventListener_Jumpstats : public KZDatabaseServiceEventListener
+{
+public:
+	virtual void OnDatabaseSetup() override
+	{
+		KZJumpstatsService::UpdateLeaderboardCache();
+	}
+} databaseEventListener;
+
+// Sorted best first, one entry per player and at most leaderboardSize entries. Cheaters are left out.
+static_global std::unordered_map<JumpstatLeaderboardKey, CUtlVector<JumpstatRecord>> leaderboards;
+static_global std::unordered_map<u64, std::unordered_map<JumpstatLeaderboardKey, JumpstatRecord>> personalBests;
+static_global i32 leaderboardSize = 20;
+
+// Returns true if the record is a new personal best.
+static_function bool InsertRecord(JumpstatLeaderboardKey key, const JumpstatRecord &record, bool cheater)
+{
+	auto &playerPBs = personalBests[record.steamID64];
+	auto pb = playerPBs.find(key);
+	if (pb != playerPBs.end() && !record.IsBetterThan(pb->second))
+	{
+		return false;
+	}
+	playerPBs[key] = record;
+
+	if (cheater)
+	{
+		return true;
+	}
+
+	// Records only ever improve, so nobody below the cutoff can move back into the top after this.
+	CUtlVector<JumpstatRecord> &top = leaderboards[key];
+	FOR_EACH_VEC(top, i)
+	{
+		if (top[i].steamID64 == record.steamID64)
+		{
+			top.Remove(i);
+			break;
+		}
+	}
+	i32 index = 0;
+	while (index < top.Count() && !record.IsBetterThan(top[index]))
+	{
+		index++;
+	}
+	if (index < leaderboardSize)
+	{
+		top.InsertBefore(index, record);
+		if (top.Count() > leaderboardSize)
+		{
+			top.RemoveMultipleFromTail(top.Count() - leaderboardSize);
+		}
+	}
+	return true;
+}
+
+void KZJumpstatsService::InitLeaderboards()
+{
+	KZDatabaseService::RegisterEventListener(&databaseEventListener);
+}
+
+void KZJumpstatsService::UpdateLeaderboardCache()
+{
+	leaderboardSize = MAX(KZOptionService::GetConfig().jumpstatTopCount, 1);
+
+	auto onQuerySuccess = [](std::vector<ISQLQuery *> queries)
+	{
+		ISQLResult *result = queries[0]->GetResultSet();
+		if (!result)
+		{
+			return;
+		}
+		// Jumps that landed before the query finished are already in the cache, the better record wins either way.
+		while (result->FetchRow())
+		{
+			JumpstatRecord record;
+			record.steamID64 = (u64)result->GetInt64(0);
+			record.alias = result->GetString(1);
+			bool cheater = result->GetInt(2) == 1;
+			JumpType jumpType = (JumpType)result->GetInt(3);
+			i32 modeID = result->GetInt(4);
+			bool blockJump = result->GetInt(5) != 0;
+			record.block = result->GetInt(6);
+			record.distance = (f64)result->GetInt(7) / KZ_DB_JS_DISTANCE_PRECISION;
+			record.strafes = result->GetInt(8);
+			record.sync = (f32)result->GetInt(9) / KZ_DB_JS_SYNC_PRECISION;
+			record.pre = (f32)result->GetInt(10) / KZ_DB_JS_SPEED_PRECISION;
+			record.max = (f32)result->GetInt(11) / KZ_DB_JS_SPEED_PRECISION;
+			record.airTime = (f32)result->GetInt(12) / KZ_DB_JS_AIRTIME_PRECISION;
+			InsertRecord(ToLeaderboardKey(jumpType, modeID, blockJump), record, cheater);
+		}
+	};
+	KZDatabaseService::QueryAllJumpstatPBs(onQuerySuccess, KZDatabaseService::OnGenericTxnFailure);
+}
+
+void KZJumpstatsService::SubmitJumpToLeaderboard(Jump *jump)
+{
+	if (!KZDatabaseService::IsReady() || !this->player->databaseService->IsSetup())
+	{
+		return;
+	}
+	JumpType jumpType = jump->GetJumpType();
+	if (jumpType < JumpType_LongJump || jumpType > JumpType_Jumpbug)
+	{
+		return;
+	}
+	if (this->player->modeService->GetDistanceTier(jumpType, jump->GetDistance()) < DistanceTier_Meh)
+	{
+		return;
+	}
+	i32 modeID = KZ::mode::GetModeInfo(this->player->modeService).databaseID;
+	if (modeID < 0)
+	{
+		return;
+	}
+
+	JumpstatRecord record;
+	record.steamID64 = this->player->GetSteamId64();
+	record.alias = this->player->GetName();
+	// Block detection is not available yet, every jump counts as a non block jump.
+	record.block = 0;
+	record.distance = jump->GetDistance();
+	record.strafes = jump->strafes.Count();
+	record.sync = jump->GetSync() * 100.0f;
+	record.pre = jump->GetTakeoffSpeed();
+	record.max = jump->GetMaxSpeed();
+	record.airTime = this->player->landingTimeActual - this->player->takeoffTime;
+
+	if (!InsertRecord(ToLeaderboardKey(jumpType, modeID, false), record, this->player->databaseService->isCheater))
+	{
+		return;
+	}
+	this->player->languageService->PrintChat(true, false, "Jumpstat PB - New", jumpTypeStr[jumpType], record.distance);
+	this->player->databaseService->SaveJumpstat(jumpType, modeID, record.distance, record.block, record.strafes, record.sync, record.pre,
+												record.max, record.airTime);
+}
+
+static_function bool ParseModeArgument(KZPlayer *player, const char *modeName, i32 &modeID, CUtlString &modeShortName)
+{
+	KZModeManager::ModePluginInfo modeInfo =
+		(modeName && modeName[0]) ? KZ::mode::GetModeInfo(CUtlString(modeName)) : KZ::mode::GetModeInfo(player->modeService);
+	if (modeInfo.databaseID < 0)
+	{
+		player->languageService->PrintChat(true, false, "Jumpstat Top - Invalid Mode", modeName ? modeName : "");
+		return false;
+	}
+	modeID = modeInfo.databaseID;
+	modeShortName = modeInfo.shortModeName;
+	return true;
+}
+
+void KZJumpstatsService::PrintLeaderboard(KZPlayer *target, JumpType jumpType, const char *modeName, bool blockJump)
+{
+	i32 modeID;
+	CUtlString modeShortName;
+	if (!ParseModeArgument(target, modeName, modeID, modeShortName))
+	{
+		return;
+	}
+
+	CUtlString headers[KZ_ARRAYSIZE(columnKeys)];
+	for (u32 i = 0; i < KZ_ARRAYSIZE(columnKeys); i++)
+	{
+		headers[i] = target->languageService->PrepareMessage(columnKeys[i]).c_str();
+	}
+	utils::Table<KZ_ARRAYSIZE(columnKeys)> table(
+		target->languageService->PrepareMessage(blockJump ? "Jumpstat Top - Table Name (Block)" : "Jumpstat Top - Table Name", jumpTypeStr[jumpType],
+												modeShortName.Get())
+			.c_str(),
+		headers);
+
+	auto top = leaderboards.find(ToLeaderboardKey(jumpType, modeID, blockJump));
+	if (top != leaderboards.end())
+	{
+		CUtlString rank, distance, block, strafes, sync, pre, max, airTime;
+		FOR_EACH_VEC(top->second, i)
+		{
+			const JumpstatRecord &record = top->second[i];
+			rank.Format("%i", i + 1);
+			distance.Format("%.4f", record.distance);
+			block.Format("%u", record.block);
+			strafes.Format("%u", record.strafes);
+			sync.Format("%.0f%%", record.sync);
+			pre.Format("%.2f", record.pre);
+			max.Format("%.2f", record.max);
+			airTime.Format("%.4f", record.airTime);
+			table.SetRow(i, rank, record.alias, distance, block, strafes, sync, pre, max, airTime);
+		}
+	}
+
+	target->languageService->PrintChat(true, false, "Jumpstat Top - Check Console");
+	target->PrintConsole(false, false, table.GetSeparator("="));
+	target->PrintConsole(false, false, table.GetTitle());
+	target->PrintConsole(false, false, table.GetHeader());
+	for (u32 i = 0; i < table.GetNumEntries(); i++)
+	{
+		target->PrintConsole(false, false, table.GetLine(i));
+	}
+	target->PrintConsole(false, false, table.GetSeparator("="));
+}
+
+void KZJumpstatsService::PrintPersonalBests(KZPlayer *target, const char *modeName)
+{
+	i32 modeID;
+	CUtlString modeShortName;
+	if (!ParseModeArgument(target, modeName, modeID, modeShortName))
+	{
+		return;
+	}
+
+	CUtlString headers[KZ_ARRAYSIZE(pbColumnKeys)];
+	for (u32 i = 0; i < KZ_ARRAYSIZE(pbColumnKeys); i++)
+	{
+		headers[i] = target->languageService->PrepareMessage(pbColumnKeys[i]).c_str();
+	}
+	utils::Table<KZ_ARRAYSIZE(pbColumnKeys)> table(
+		target->languageService->PrepareMessage("Jumpstat PB - Table Name", target->GetName(), modeShortName.Get()).c_str(), headers);
+
+	auto playerPBs = personalBests.find(target->GetSteamId64());
+	if (playerPBs != personalBests.end())
+	{
+		u32 row = 0;
+		CUtlString distance, block, strafes, sync, pre, max, airTime;
+		for (i32 blockJump = 0; blockJump < 2; blockJump++)
+		{
+			for (i32 jumpType = JumpType_LongJump; jumpType <= JumpType_Jumpbug; jumpType++)
+			{
+				auto pb = playerPBs->second.find(ToLeaderboardKey((JumpType)jumpType, modeID, blockJump));
+				if (pb == playerPBs->second.end())
+				{
+					continue;
+				}
+				const JumpstatRecord &record = pb->second;
+				distance.Format("%.4f", record.distance);
+				block.Format("%u", record.block);
+				strafes.Format("%u", record.strafes);
+				sync.Format("%.0f%%", record.sync);
+				pre.Format("%.2f", record.pre);
+				max.Format("%.2f", record.max);
+				airTime.Format("%.4f", record.airTime);
+				table.SetRow(row++, jumpTypeStr[jumpType], distance, block, strafes, sync, pre, max, airTime);
+			}
+		}
+	}
+
+	target->languageService->PrintChat(true, false, "Jumpstat Top - Check Console");
+	target->PrintConsole(false, false, table.GetSeparator("="));
+	target->PrintConsole(false, false, table.GetTitle());
+	target->PrintConsole(false, false, table.GetHeader());
+	for (u32 i = 0; i < table.GetNumEntries(); i++)
+	{
+		target->PrintConsole(false, false, table.GetLine(i));
+	}
+	target->PrintConsole(false, false, table.GetSeparator("="));
+}
+
+static_function JumpType GetJumpTypeFromString(const char *jumpTypeString)
+{
+	for (i32 i = JumpType_LongJump; i <= JumpType_Jumpbug; i++)
+	{
+		if (KZ_STREQI(jumpTypeString, jumpTypeShortStr[i]) || KZ_STREQI(jumpTypeString, jumpTypeStr[i]))
+		{
+			return (JumpType)i;
+		}
+	}
+	return JumpType_Invalid;
+}
+
+SCMD(kz_jstop, SCFL_JUMPSTATS)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	JumpType jumpType = args->ArgC() < 2 ? JumpType_LongJump : GetJumpTypeFromString(args->Arg(1));
+	if (jumpType == JumpType_Invalid)
+	{
+		player->languageService->PrintChat(true, false, "Jumpstat Top Command Usage");
+		return MRES_SUPERCEDE;
+	}
+	KZJumpstatsService::PrintLeaderboard(player, jumpType, args->Arg(2));
+	return MRES_SUPERCEDE;
+}
+
+SCMD(kz_ljtop, SCFL_JUMPSTATS)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	KZJumpstatsService::PrintLeaderboard(player, JumpType_LongJump, args->Arg(1));
+	return MRES_SUPERCEDE;
+}
+
+SCMD(kz_jspb, SCFL_JUMPSTATS)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	KZJumpstatsService::PrintPersonalBests(player, args->Arg(1));
+	return MRES_SUPERCEDE;
+}
@@ -1,10 +1,15 @@
+#include <algorithm>
+#include <emmintrin.h>
+
 #include "../kz.h"
 #include "utils/utils.h"
 #include "utils/simplecmds.h"
 
 #include "kz_jumpstats.h"
+#include "jump_export.h"
 #include "../mode/kz_mode.h"
 #include "../style/kz_style.h"
+#include "../anticheat/strafe_analysis.h"
 #include "../option/kz_option.h"
 #include "../language/kz_language.h"
 #include "kz/trigger/kz_trigger.h"
@@ -182,171 +187,244 @@ void Strafe::UpdateCollisionVelocityChange(f32 delta)
 	}
 }
 
-void Strafe::End()
+// Sums of the per call stats of a strafe, see Strafe::End.
+struct StrafeSums
 {
-	FOR_EACH_VEC(this->aaCalls, i)
-	{
-		this->duration += this->aaCalls[i].duration;
-		// Calculate BA/DA/OL
-		if (this->aaCalls[i].wishspeed == 0)
+	f32 duration;
+	f32 overlap;
+	f32 deadAir;
+	f32 badAngles;
+	f32 sync;
+	f32 maxGain;
+	f32 airGain;
+	f32 airLoss;
+	f32 externalGain;
+	f32 externalLoss;
+	f32 width;
+};
+
+static_function f32 HorizontalSum(__m128 v)
+{
+	alignas(16) f32 lanes[4];
+	_mm_store_ps(lanes, v);
+	return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+static_function StrafeSums SumStrafeStats(const AACallArena &arena, i32 start, i32 count)
+{
+	const f32 *duration = arena.duration.Base() + start;
+	const f32 *wishspeed = arena.wishspeed.Base() + start;
+	const f32 *hasMoveKeys = arena.hasMoveKeys.Base() + start;
+	const f32 *speedPre = arena.speedPre.Base() + start;
+	const f32 *speedPost = arena.speedPost.Base() + start;
+	const f32 *velocityDelta = arena.velocityDelta.Base() + start;
+	const f32 *externalSpeedDiff = arena.externalSpeedDiff.Base() + start;
+	const f32 *idealGain = arena.idealGain.Base() + start;
+	const f32 *yawDelta = arena.yawDelta.Base() + start;
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 epsilon = _mm_set1_ps(JS_EPSILON);
+	__m128 sumDuration = zero, sumOverlap = zero, sumDeadAir = zero, sumBadAngles = zero, sumSync = zero, sumMaxGain = zero;
+	__m128 sumAirGain = zero, sumAirLoss = zero, sumExternalGain = zero, sumExternalLoss = zero, sumWidth = zero;
+
+	i32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 dur = _mm_loadu_ps(duration + i);
+		sumDuration = _mm_add_ps(sumDuration, dur);
+
+		// BA/DA/OL, in the same priority order as the scalar version below.
+		__m128 noWish = _mm_cmpeq_ps(_mm_loadu_ps(wishspeed + i), zero);
+		__m128 keys = _mm_cmpneq_ps(_mm_loadu_ps(hasMoveKeys + i), zero);
+		sumOverlap = _mm_add_ps(sumOverlap, _mm_and_ps(_mm_and_ps(noWish, keys), dur));
+		sumDeadAir = _mm_add_ps(sumDeadAir, _mm_and_ps(_mm_andnot_ps(keys, noWish), dur));
+
+		__m128 noDelta = _mm_cmple_ps(_mm_loadu_ps(velocityDelta + i), epsilon);
+		__m128 badAngle = _mm_andnot_ps(noWish, noDelta);
+		sumBadAngles = _mm_add_ps(sumBadAngles, _mm_and_ps(badAngle, dur));
+
+		__m128 speedDiff = _mm_sub_ps(_mm_loadu_ps(speedPost + i), _mm_loadu_ps(speedPre + i));
+		__m128 synced = _mm_andnot_ps(_mm_or_ps(noWish, noDelta), _mm_cmpgt_ps(speedDiff, epsilon));
+		sumSync = _mm_add_ps(sumSync, _mm_and_ps(synced, dur));
+
+		// Gain/loss.
+		sumMaxGain = _mm_add_ps(sumMaxGain, _mm_loadu_ps(idealGain + i));
+		sumAirGain = _mm_add_ps(sumAirGain, _mm_max_ps(speedDiff, zero));
+		sumAirLoss = _mm_add_ps(sumAirLoss, _mm_min_ps(speedDiff, zero));
+		__m128 external = _mm_loadu_ps(externalSpeedDiff + i);
+		sumExternalGain = _mm_add_ps(sumExternalGain, _mm_max_ps(external, zero));
+		sumExternalLoss = _mm_add_ps(sumExternalLoss, _mm_min_ps(external, zero));
+
+		sumWidth = _mm_add_ps(sumWidth, _mm_loadu_ps(yawDelta + i));
+	}
+
+	StrafeSums sums;
+	sums.duration = HorizontalSum(sumDuration);
+	sums.overlap = HorizontalSum(sumOverlap);
+	sums.deadAir = HorizontalSum(sumDeadAir);
+	sums.badAngles = HorizontalSum(sumBadAngles);
+	sums.sync = HorizontalSum(sumSync);
+	sums.maxGain = HorizontalSum(sumMaxGain);
+	sums.airGain = HorizontalSum(sumAirGain);
+	sums.airLoss = HorizontalSum(sumAirLoss);
+	sums.externalGain = HorizontalSum(sumExternalGain);
+	sums.externalLoss = HorizontalSum(sumExternalLoss);
+	sums.width = HorizontalSum(sumWidth);
+
+	for (; i < count; i++)
+	{
+		sums.duration += duration[i];
+		if (wishspeed[i] == 0)
 		{
-			u64 buttonBits = IN_FORWARD | IN_BACK | IN_MOVELEFT | IN_MOVERIGHT;
-			if (CInButtonState::IsButtonPressed(this->aaCalls[i].buttons, buttonBits))
+			if (hasMoveKeys[i] != 0)
 			{
-				this->overlap += this->aaCalls[i].duration;
+				sums.overlap += duration[i];
 			}
 			else
 			{
-				this->deadAir += this->aaCalls[i].duration;
+				sums.deadAir += duration[i];
 			}
 		}
-		else if ((this->aaCalls[i].velocityPost - this->aaCalls[i].velocityPre).Length2D() <= JS_EPSILON)
+		else if (velocityDelta[i] <= JS_EPSILON)
 		{
 			// This gain could just be from quantized float stuff.
-			this->badAngles += this->aaCalls[i].duration;
+			sums.badAngles += duration[i];
 		}
-		// Calculate sync.
-		else if (this->aaCalls[i].velocityPost.Length2D() - this->aaCalls[i].velocityPre.Length2D() > JS_EPSILON)
+		else if (speedPost[i] - speedPre[i] > JS_EPSILON)
 		{
-			this->syncDuration += this->aaCalls[i].duration;
+			sums.sync += duration[i];
 		}
 
-		// Gain/loss.
-		this->maxGain += this->aaCalls[i].CalcIdealGain();
-		f32 speedDiff = this->aaCalls[i].velocityPost.Length2D() - this->aaCalls[i].velocityPre.Length2D();
-		if (speedDiff > 0)
-		{
-			this->airGain += speedDiff;
-		}
-		else
-		{
-			this->airLoss += speedDiff;
-		}
-		f32 externalSpeedDiff = this->aaCalls[i].externalSpeedDiff;
-		if (externalSpeedDiff > 0)
+		sums.maxGain += idealGain[i];
+		f32 speedDiff = speedPost[i] - speedPre[i];
+		sums.airGain += MAX(speedDiff, 0.0f);
+		sums.airLoss += MIN(speedDiff, 0.0f);
+		sums.externalGain += MAX(externalSpeedDiff[i], 0.0f);
+		sums.externalLoss += MIN(externalSpeedDiff[i], 0.0f);
+		sums.width += yawDelta[i];
+	}
+	return sums;
+}
+
+void AACallArena::Add(AACall &call)
+{
+	f32 speedPre = call.velocityPre.Length2D();
+	f32 speedPost = call.velocityPost.Length2D();
+
+	this->duration.AddToTail(call.duration);
+	this->wishspeed.AddToTail(call.wishspeed);
+	this->hasMoveKeys.AddToTail(CInButtonState::IsButtonPressed(call.buttons, IN_FORWARD | IN_BACK | IN_MOVELEFT | IN_MOVERIGHT) ? 1.0f : 0.0f);
+	this->ducking.AddToTail(call.ducking ? 1.0f : 0.0f);
+	this->speedPre.AddToTail(speedPre);
+	this->speedPost.AddToTail(speedPost);
+	this->velocityDelta.AddToTail((call.velocityPost - call.velocityPre).Length2D());
+	this->externalSpeedDiff.AddToTail(call.externalSpeedDiff);
+	this->idealGain.AddToTail(call.CalcIdealGain());
+	this->yawDelta.AddToTail(fabs(utils::GetAngleDifference(call.currentYaw, call.prevYaw, 180.0f)));
+
+	// Angle ratio inputs, only meaningful if there is velocity.
+	f32 relativeYaw = 0.0f;
+	if (speedPre != 0)
+	{
+		QAngle angles, velAngles;
+		VectorAngles(call.velocityPre, velAngles);
+		// If no attempt to gain speed was made, use the angle of the last call as a reference,
+		// and add yaw relative to last tick's yaw.
+		if (call.wishspeed != 0)
 		{
-			this->externalGain += externalSpeedDiff;
+			VectorAngles(call.wishdir, angles);
 		}
 		else
 		{
-			this->externalLoss += externalSpeedDiff;
+			angles.y = call.prevYaw + utils::GetAngleDifference(call.currentYaw, call.prevYaw, 180.0f);
 		}
-		this->width += fabs(utils::GetAngleDifference(this->aaCalls[i].currentYaw, this->aaCalls[i].prevYaw, 180.0f));
+		relativeYaw = utils::NormalizeDeg(angles.y - velAngles.y);
 	}
-	this->CalcAngleRatioStats();
+	this->relativeYaw.AddToTail(relativeYaw);
+	this->minYaw.AddToTail(utils::NormalizeDeg(call.CalcMinYaw()));
+	this->idealYaw.AddToTail(utils::NormalizeDeg(call.CalcIdealYaw()));
+	this->maxYaw.AddToTail(utils::NormalizeDeg(call.CalcMaxYaw()));
 }
 
-bool Strafe::CalcAngleRatioStats()
+void Strafe::End(AACallArena &arena)
+{
+	StrafeSums sums = SumStrafeStats(arena, this->aaCallStart, this->aaCallCount);
+	this->duration += sums.duration;
+	this->overlap += sums.overlap;
+	this->deadAir += sums.deadAir;
+	this->badAngles += sums.badAngles;
+	this->syncDuration += sums.sync;
+	this->maxGain += sums.maxGain;
+	this->airGain += sums.airGain;
+	this->airLoss += sums.airLoss;
+	this->externalGain += sums.externalGain;
+	this->externalLoss += sums.externalLoss;
+	this->width += sums.width;
+	this->CalcAngleRatioStats(arena);
+}
+
+bool Strafe::CalcAngleRatioStats(AACallArena &arena)
 {
 	this->arStats.available = false;
 	f32 totalDuration = 0.0f;
 	f32 totalRatios = 0.0f;
-	CUtlVector<f32> ratios;
+	f32 maxRatio = -FLT_MAX;
+	CUtlVector<f32> &ratios = arena.ratios;
+	ratios.RemoveAll();
 
-	QAngle angles, velAngles;
-	FOR_EACH_VEC(this->aaCalls, i)
+	for (i32 i = this->aaCallStart; i < this->aaCallStart + this->aaCallCount; i++)
 	{
-		if (this->aaCalls[i].velocityPre.Length2D() == 0)
+		if (arena.speedPre[i] == 0)
 		{
 			// Any angle should be a good angle here.
 			// ratio += 0;
 			continue;
 		}
-		VectorAngles(this->aaCalls[i].velocityPre, velAngles);
 
-		// If no attempt to gain speed was made, use the angle of the last call as a reference,
-		// and add yaw relative to last tick's yaw.
-		// If the velocity is 0 as well, then every angle is a perfect angle.
-		if (this->aaCalls[i].wishspeed != 0)
-		{
-			VectorAngles(this->aaCalls[i].wishdir, angles);
-		}
-		else
-		{
-			angles.y = this->aaCalls[i].prevYaw + utils::GetAngleDifference(this->aaCalls[i].currentYaw, this->aaCalls[i].prevYaw, 180.0f);
-		}
-
-		angles -= velAngles;
-		// Get the minimum, ideal, and max yaw for gain.
-		f32 minYaw = utils::NormalizeDeg(this->aaCalls[i].CalcMinYaw());
-		f32 idealYaw = utils::NormalizeDeg(this->aaCalls[i].CalcIdealYaw());
-		f32 maxYaw = utils::NormalizeDeg(this->aaCalls[i].CalcMaxYaw());
-
-		angles.y = utils::NormalizeDeg(angles.y);
+		f32 yaw = arena.relativeYaw[i];
+		f32 minYaw = arena.minYaw[i];
+		f32 idealYaw = arena.idealYaw[i];
+		f32 maxYaw = arena.maxYaw[i];
 
 		if (this->turnstate == TURN_RIGHT || /* The ideal angle is calculated for left turns, we need to flip it for right turns. */
 			(this->turnstate == TURN_NONE
-			 && fabs(utils::GetAngleDifference(angles.y, idealYaw, 180.0f)) > fabs(utils::GetAngleDifference(-angles.y, idealYaw, 180.0f))))
+			 && fabs(utils::GetAngleDifference(yaw, idealYaw, 180.0f)) > fabs(utils::GetAngleDifference(-yaw, idealYaw, 180.0f))))
 		// If we aren't turning at all, take the one closer to the ideal yaw.
 		{
-			angles.y = -angles.y;
+			yaw = -yaw;
 		}
 
 		// It is possible for the player to gain speed here, by pressing the opposite keys
 		// while still turning in the same direction, which results in actual gain...
 		// Usually this happens at the end of a strafe.
-		if (angles.y < 0 && this->aaCalls[i].velocityPost.Length2D() > this->aaCalls[i].velocityPre.Length2D())
+		if (yaw < 0 && arena.speedPost[i] > arena.speedPre[i])
 		{
-			angles.y = -angles.y;
+			yaw = -yaw;
 		}
 
-		// If the player yaw is way too off, they are probably pressing the wrong key and probably not turning too fast.
-		// So we shouldn't count them into the average calc.
-
-		//	utils::PrintConsoleAll("%f %f %f %f | %f / %f / %f | %f -> %f | %f %f | ws %f wd %f %f %f accel %f fraction %f",
-		//	minYaw, angles.y, idealYaw, maxYaw,
-		//	utils::GetAngleDifference(angles.y, minYaw, 180.0),
-		//	utils::GetAngleDifference(idealYaw, minYaw, 180.0),
-		//	utils::GetAngleDifference(maxYaw, minYaw, 180.0),
-		//	this->aaCalls[i].velocityPre.Length2D(), this->aaCalls[i].velocityPost.Length2D(),
-		//	this->aaCalls[i].velocityPre.x, this->aaCalls[i].velocityPre.y,
-		//	this->aaCalls[i].wishspeed,
-		//	this->aaCalls[i].wishdir.x,
-		//	this->aaCalls[i].wishdir.y,
-		//	this->aaCalls[i].wishdir.z,
-		//	this->aaCalls[i].accel,
-		//	this->aaCalls[i].duration * ENGINE_FIXED_TICK_RATE);
-		if (angles.y > maxYaw + 20.0f || angles.y < minYaw - 20.0f)
+		f32 gainRatio = (arena.speedPost[i] - arena.speedPre[i]) / arena.idealGain[i];
+		f32 fraction = arena.duration[i] * ENGINE_FIXED_TICK_RATE;
+		f32 ratio;
+		if (yaw < minYaw)
 		{
+			ratio = -1 * fraction;
 		}
-		f32 gainRatio = (this->aaCalls[i].velocityPost.Length2D() - this->aaCalls[i].velocityPre.Length2D()) / this->aaCalls[i].CalcIdealGain();
-		f32 fraction = this->aaCalls[i].duration * ENGINE_FIXED_TICK_RATE;
-		if (angles.y < minYaw)
+		else if (yaw < idealYaw)
 		{
-			totalRatios += -1 * fraction;
-			totalDuration += fraction;
-			ratios.AddToTail(-1 * fraction);
-			// utils::PrintConsoleAll("No Gain: GR = %f (%f / %f)", gainRatio, this->aaCalls[i].velocityPost.Length2D()
-			// - this->aaCalls[i].velocityPre.Length2D(), this->aaCalls[i].CalcIdealGain());
-			continue;
-		}
-		else if (angles.y < idealYaw)
-		{
-			totalRatios += (gainRatio - 1) * fraction;
-			totalDuration += fraction;
-			ratios.AddToTail((gainRatio - 1) * fraction);
-			// utils::PrintConsoleAll("Slow Gain: GR = %f (%f / %f)", gainRatio,
-			// this->aaCalls[i].velocityPost.Length2D() - this->aaCalls[i].velocityPre.Length2D(),
-			// this->aaCalls[i].CalcIdealGain());
+			ratio = (gainRatio - 1) * fraction;
 		}
-		else if (angles.y < maxYaw)
+		else if (yaw < maxYaw)
 		{
-			totalRatios += (1 - gainRatio) * fraction;
-			totalDuration += fraction;
-			ratios.AddToTail((1 - gainRatio) * fraction);
-			// utils::PrintConsoleAll("Fast Gain: GR = %f (%f / %f)", gainRatio,
-			// this->aaCalls[i].velocityPost.Length2D() - this->aaCalls[i].velocityPre.Length2D(),
-			// this->aaCalls[i].CalcIdealGain());
+			ratio = (1 - gainRatio) * fraction;
 		}
 		else
 		{
-			totalRatios += 1.0f;
-			totalDuration += fraction;
-			ratios.AddToTail(1.0f);
-			// utils::PrintConsoleAll("TooFast Gain: GR = %f (%f / %f)", gainRatio,
-			// this->aaCalls[i].velocityPost.Length2D() - this->aaCalls[i].velocityPre.Length2D(),
-			// this->aaCalls[i].CalcIdealGain());
+			ratio = 1.0f;
 		}
+		totalRatios += ratio;
+		totalDuration += fraction;
+		maxRatio = MAX(maxRatio, ratio);
+		ratios.AddToTail(ratio);
 	}
 
 	// This can return nan if the duration is 0, this is intended...
@@ -354,11 +432,13 @@ bool Strafe::CalcAngleRatioStats()
 	{
 		return false;
 	}
-	ratios.Sort(this->SortFloat);
+	// Only the median is needed, partially sorting around it is enough.
+	f32 *median = ratios.Base() + ratios.Count() / 2;
+	std::nth_element(ratios.Base(), median, ratios.Base() + ratios.Count());
 	this->arStats.available = true;
 	this->arStats.average = totalRatios / totalDuration;
-	this->arStats.median = ratios[ratios.Count() / 2];
-	this->arStats.max = ratios[ratios.Count() - 1];
+	this->arStats.median = *median;
+	this->arStats.max = maxRatio;
 	return true;
 }
 
@@ -397,11 +477,11 @@ void Jump::Init()
 	}
 }
 
-void Jump::UpdateAACallPost(Vector wishdir, f32 wishspeed, f32 accel)
+void Jump::UpdateAACallPost(AACall &aaCall, Vector wishdir, f32 wishspeed, f32 accel)
 {
 	// Use the latest parameters, just in case they changed.
 	Strafe *strafe = this->GetCurrentStrafe();
-	AACall *call = &strafe->aaCalls.Tail();
+	AACall *call = &aaCall;
 	QAngle currentAngle;
 	this->player->GetAngles(&currentAngle);
 	call->maxspeed = this->player->currentMoveData->m_flMaxSpeed;
@@ -416,6 +496,10 @@ void Jump::UpdateAACallPost(Vector wishdir, f32 wishspeed, f32 accel)
 	this->player->GetVelocity(&call->velocityPost);
 	strafe->UpdateStrafeMaxSpeed(call->velocityPost.Length2D());
 
+	// The call is complete, derive everything the strafe stats need now so ending the jump stays cheap.
+	this->player->jumpstatsService->aaCallArena.Add(*call);
+	strafe->aaCallCount++;
+
 	// Check if we are still tracking release for the strafe.
 	if (strafe->jump->trackingRelease)
 	{
@@ -446,9 +530,10 @@ void Jump::Update()
 void Jump::End()
 {
 	this->Update();
+	AACallArena &arena = this->player->jumpstatsService->aaCallArena;
 	if (this->strafes.Count() > 0)
 	{
-		this->strafes.Tail().End();
+		this->strafes.Tail().End(arena);
 	}
 	this->landingOrigin = this->player->landingOrigin;
 	this->adjustedLandingOrigin = this->player->landingOriginActual;
@@ -460,12 +545,12 @@ void Jump::End()
 	f32 maxGain = 0.0f;
 	FOR_EACH_VEC(this->strafes, i)
 	{
-		FOR_EACH_VEC(this->strafes[i].aaCalls, j)
+		for (i32 j = this->strafes[i].aaCallStart; j < this->strafes[i].aaCallStart + this->strafes[i].aaCallCount; j++)
 		{
-			if (this->strafes[i].aaCalls[j].ducking)
+			if (arena.ducking[j] != 0)
 			{
-				this->duckDuration += this->strafes[i].aaCalls[j].duration;
-				this->duckEndDuration += this->strafes[i].aaCalls[j].duration;
+				this->duckDuration += arena.duration[j];
+				this->duckEndDuration += arena.duration[j];
 			}
 			else
 			{
@@ -531,6 +616,7 @@ Strafe *Jump::GetCurrentStrafe()
 	{
 		int index = this->strafes.AddToTail({this});
 		this->strafes[index].turnstate = this->player->GetTurning();
+		this->strafes[index].aaCallStart = this->player->jumpstatsService->aaCallArena.Count();
 	}
 	// If the player isn't turning, update the turn state until it changes.
 	else if (!this->strafes.Tail().turnstate)
@@ -540,10 +626,11 @@ Strafe *Jump::GetCurrentStrafe()
 	// Otherwise, if the strafe is in opposite direction, we add a new strafe.
 	else if (this->strafes.Tail().turnstate == -this->player->GetTurning())
 	{
-		this->strafes.Tail().End();
+		this->strafes.Tail().End(this->player->jumpstatsService->aaCallArena);
 		// Finish the previous strafe before adding a new strafe.
 		Strafe strafe = Strafe(this);
 		strafe.turnstate = this->player->GetTurning();
+		strafe.aaCallStart = this->player->jumpstatsService->aaCallArena.Count();
 		this->strafes.AddToTail(strafe);
 	}
 	// Turn state didn't change, it's the same strafe. No need to do anything.
@@ -595,6 +682,47 @@ f32 Jump::GetDeviation()
 	return distanceX;
 }
 
+void JumpHistory::Init(i32 depth)
+{
+	depth = MAX(depth, 1);
+	if (this->slots.Count() != depth)
+	{
+		this->slots.Purge();
+		this->slots.EnsureCount(depth);
+	}
+	this->start = 0;
+	this->count = 0;
+}
+
+Jump &JumpHistory::Add(KZPlayer *player)
+{
+	if (this->slots.Count() == 0)
+	{
+		this->Init(1);
+	}
+	// Construct the new jump before touching the ring, jump type detection looks at the previous jump.
+	Jump newJump(player);
+
+	i32 index = (this->start + this->count) % this->slots.Count();
+	if (this->count == this->slots.Count())
+	{
+		this->start = (this->start + 1) % this->slots.Count();
+	}
+	else
+	{
+		this->count++;
+	}
+
+	// Keep the strafe storage of the retired jump around.
+	Jump &jump = this->slots[index];
+	CCopyableUtlVector<Strafe> strafes;
+	strafes.Swap(jump.strafes);
+	strafes.RemoveAll();
+	jump = newJump;
+	jump.strafes.Swap(strafes);
+	return jump;
+}
+
 JumpType KZJumpstatsService::DetermineJumpType()
 {
 	if (this->jumps.Count() <= 0 || this->player->JustTeleported() || this->player->triggerService->ShouldDisableJumpstats())
@@ -691,10 +819,11 @@ f32 KZJumpstatsService::GetLastJumpRelease()
 
 void KZJumpstatsService::Reset()
 {
-	this->broadcastMinTier = static_cast<DistanceTier>(KZOptionService::GetOptionInt("defaultJSBroadcastMinTier", DistanceTier_Godlike));
-	this->soundMinTier = static_cast<DistanceTier>(KZOptionService::GetOptionInt("defaultJSSoundMinTier", DistanceTier_Godlike));
-	this->showJumpstats = KZOptionService::GetOptionInt("defaultShowJS", true);
-	this->jumps.Purge();
+	this->broadcastMinTier = static_cast<DistanceTier>(KZOptionService::GetConfig().defaultJSBroadcastMinTier);
+	this->soundMinTier = static_cast<DistanceTier>(KZOptionService::GetConfig().defaultJSSoundMinTier);
+	this->showJumpstats = KZOptionService::GetConfig().defaultShowJS;
+	this->jumps.Init(KZOptionService::GetConfig().jumpHistoryDepth);
+	this->aaCallArena.Clear();
 	this->jsAlways = {};
 	this->lastJumpButtonTime = {};
 	this->lastNoclipTime = {};
@@ -770,7 +899,8 @@ void KZJumpstatsService::OnAirMove()
 	{
 		return;
 	}
-	AACall call;
+	AACall &call = this->pendingAACall;
+	call = {};
 	this->player->GetVelocity(&call.velocityPre);
 
 	// moveDataPost is still the movedata from last tick.
@@ -778,8 +908,8 @@ void KZJumpstatsService::OnAirMove()
 	call.prevYaw = this->player->oldAngles.y;
 	call.curtime = g_pKZUtils->GetGlobals()->curtime;
 	call.tickcount = g_pKZUtils->GetGlobals()->tickcount;
-	Strafe *strafe = this->jumps.Tail().GetCurrentStrafe();
-	strafe->aaCalls.AddToTail(call);
+	// Make sure the strafe is up to date before the call gets added to it in OnAirMovePost.
+	this->jumps.Tail().GetCurrentStrafe();
 }
 
 void KZJumpstatsService::OnAirMovePost()
@@ -826,7 +956,7 @@ void KZJumpstatsService::OnAirMovePost()
 	}
 	f32 accel = KZ::mode::modeCvarRefs[MODECVAR_SV_AIRACCELERATE]->GetFloat();
 
-	this->jumps.Tail().UpdateAACallPost(wishdir, wishspeed, accel);
+	this->jumps.Tail().UpdateAACallPost(this->pendingAACall, wishdir, wishspeed, accel);
 }
 
 void KZJumpstatsService::AddJump()
@@ -835,7 +965,9 @@ void KZJumpstatsService::AddJump()
 	{
 		return;
 	}
-	this->jumps.AddToTail({this->player});
+	// Only the current jump needs its calls, previous jumps are either ended or will never be.
+	this->aaCallArena.Clear();
+	this->jumps.Add(this->player);
 }
 
 void KZJumpstatsService::UpdateJump()
@@ -865,6 +997,8 @@ void KZJumpstatsService::EndJump()
 		{
 			return;
 		}
+		KZ::jumpexport::Submit(jump);
+		KZ::strafeanalysis::Submit(jump);
 		if ((jump->GetOffset() > -JS_EPSILON && jump->IsValid()) || this->jsAlways)
 		{
 			if (this->ShouldDisplayJumpstats())
@@ -877,6 +1011,11 @@ void KZJumpstatsService::EndJump()
 				KZJumpstatsService::StartDemoRecording(jump->GetJumpPlayer()->GetName());
 			}
 			KZJumpstatsService::BroadcastJumpToChat(jump);
+			// jsAlways only affects what gets printed, PBs still need a valid jump that didn't land below its takeoff.
+			if (jump->GetOffset() > -JS_EPSILON && jump->IsValid())
+			{
+				this->SubmitJumpToLeaderboard(jump);
+			}
 			for (u32 i = 1; i < MAXPLAYERS + 1; i++)
 			{
 				KZPlayer *pl = g_pKZPlayerManager->ToPlayer(i);
@@ -917,6 +1056,10 @@ void KZJumpstatsService::InvalidateJumpstats(const char *reason)
 {
 	if (this->jumps.Count() > 0 && !this->jumps.Tail().AlreadyEnded())
 	{
+		if (this->jumps.Tail().IsValid())
+		{
+			movement::tracerecorder::OnJumpInvalidated(reason ? reason : "Invalidated");
+		}
 		this->jumps.Tail().Invalidate(reason);
 	}
 }
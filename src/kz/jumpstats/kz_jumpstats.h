@@ -81,6 +81,51 @@ public:
 	f32 CalcIdealGain();
 };
 
+// Per AACall values that strafe stats are computed from, derived once when the call is finished.
+// clang-format off
+#define AACALL_ARENA_FIELDS(X) \
+	X(duration)          /* Frame time of the call */ \
+	X(wishspeed)         /* 0 if no movement keys resulted in acceleration */ \
+	X(hasMoveKeys)       /* 1 if any movement key was held, 0 otherwise */ \
+	X(ducking)           /* 1 if ducked, 0 otherwise */ \
+	X(speedPre)          /* 2D speed before acceleration */ \
+	X(speedPost)         /* 2D speed after acceleration */ \
+	X(velocityDelta)     /* 2D length of the velocity change */ \
+	X(externalSpeedDiff) /* Speed change since the last call not caused by airstrafing */ \
+	X(idealGain)         /* Best possible gain for this call */ \
+	X(yawDelta)          /* Absolute yaw change since the previous call */ \
+	X(relativeYaw)       /* Wish direction relative to velocity, normalized */ \
+	X(minYaw)            /* Minimum yaw for gain, normalized */ \
+	X(idealYaw)          /* Ideal yaw for gain, normalized */ \
+	X(maxYaw)            /* Maximum yaw for gain, normalized */
+// clang-format on
+
+// Structure of arrays storage for the AACalls of the current jump.
+// Strafes reference a contiguous range in it, and the memory is kept around across jumps.
+struct AACallArena
+{
+#define AACALL_ARENA_DECLARE(name) CUtlVector<f32> name;
+	AACALL_ARENA_FIELDS(AACALL_ARENA_DECLARE)
+#undef AACALL_ARENA_DECLARE
+
+	// Scratch buffer for angle ratio stats.
+	CUtlVector<f32> ratios;
+
+	i32 Count() const
+	{
+		return this->duration.Count();
+	}
+
+	void Add(AACall &call);
+
+	void Clear()
+	{
+#define AACALL_ARENA_CLEAR(name) this->name.RemoveAll();
+		AACALL_ARENA_FIELDS(AACALL_ARENA_CLEAR)
+#undef AACALL_ARENA_CLEAR
+	}
+};
+
 class Strafe
 {
 public:
@@ -89,7 +134,9 @@ public:
 	Strafe(Jump *jump) : jump(jump) {}
 
 	Jump *jump;
-	CCopyableUtlVector<AACall> aaCalls;
+	// Range of this strafe's calls in the player's AACallArena.
+	i32 aaCallStart {};
+	i32 aaCallCount {};
 	TurnState turnstate;
 
 private:
@@ -117,7 +164,7 @@ private:
 	f32 strafeMaxSpeed {};
 
 public:
-	void End();
+	void End(AACallArena &arena);
 
 	f32 GetStrafeDuration()
 	{
@@ -177,16 +224,6 @@ public:
 		return this->strafeMaxSpeed;
 	}
 
-	// Calculate the ratio for each strafe.
-	// The ratio is 0 if the angle is perfect, closer to -100 if it's too slow
-	// Closer to 100 if it passes the optimal value.
-	// Note: if the player jumps in place, no velocity and no attempt to move at all, any angle will be "perfect".
-	// Returns false if there is no available stats.
-	static int SortFloat(const f32 *a, const f32 *b)
-	{
-		return *a > *b;
-	}
-
 	struct AngleRatioStats
 	{
 		bool available;
@@ -197,7 +234,12 @@ public:
 
 	AngleRatioStats arStats;
 
-	bool CalcAngleRatioStats();
+	// Calculate the ratio for each strafe.
+	// The ratio is 0 if the angle is perfect, closer to -100 if it's too slow
+	// Closer to 100 if it passes the optimal value.
+	// Note: if the player jumps in place, no velocity and no attempt to move at all, any angle will be "perfect".
+	// Returns false if there is no available stats.
+	bool CalcAngleRatioStats(AACallArena &arena);
 
 	void UpdateStrafeMaxSpeed(f32 speed)
 	{
@@ -246,10 +288,8 @@ public:
 	bool trackingRelease = true;
 
 public:
-	Jump()
-	{
-		Init();
-	}
+	// Empty slot for JumpHistory, there is no player to initialize from yet.
+	Jump() {}
 
 	Jump(KZPlayer *player) : player(player)
 	{
@@ -257,7 +297,7 @@ public:
 	}
 
 	void Init();
-	void UpdateAACallPost(Vector wishdir, f32 wishspeed, f32 accel);
+	void UpdateAACallPost(AACall &call, Vector wishdir, f32 wishspeed, f32 accel);
 	void Update();
 	void End();
 
@@ -370,12 +410,38 @@ public:
 	std::string GetInvalidationReasonString(const char *reason, const char *language = NULL);
 };
 
+// Ring of the most recent jumps of a player.
+// Slots are allocated once and reused, retiring the oldest jump keeps its strafe storage for the next one,
+// so tracking jumps doesn't allocate anything once every slot has been used.
+class JumpHistory
+{
+public:
+	// Resizes the ring if needed and forgets all jumps.
+	void Init(i32 depth);
+	// Starts a new jump, retiring the oldest one if the history is full.
+	Jump &Add(KZPlayer *player);
+
+	i32 Count() const
+	{
+		return this->count;
+	}
+
+	Jump &Tail()
+	{
+		return this->slots[(this->start + this->count - 1) % this->slots.Count()];
+	}
+
+private:
+	CUtlVector<Jump> slots;
+	i32 start {};
+	i32 count {};
+};
+
 class KZJumpstatsService : public KZBaseService
 {
 public:
 	KZJumpstatsService(KZPlayer *player) : KZBaseService(player)
 	{
-		this->jumps = CUtlVector<Jump>(1, 0);
 		this->tpmVelocity = Vector(0, 0, 0);
 	}
 
@@ -388,19 +454,31 @@ private:
 	bool jsAlways {};
 	bool showJumpstats {}; // Need change to type
 
-	CUtlVector<Jump> jumps;
+	JumpHistory jumps;
 	f32 lastJumpButtonTime {};
 	f32 lastNoclipTime {};
 	f32 lastDuckbugTime {};
 	f32 lastGroundSpeedCappedTime {};
 	f32 lastMovementProcessedTime {};
 	Vector tpmVelocity;
+	// Call being tracked between OnAirMove and OnAirMovePost.
+	AACall pendingAACall;
 	bool possibleEdgebug {};
 	f32 lastWPressedTime {};
 	bool ladderHopThisMove {};
 
 public:
+	AACallArena aaCallArena;
+
 	static void StartDemoRecording(CUtlString playerName);
+
+	// Leaderboards
+	static void InitLeaderboards();
+	static void UpdateLeaderboardCache();
+	static void PrintLeaderboard(KZPlayer *target, JumpType jumpType, const char *modeName = nullptr, bool blockJump = false);
+	static void PrintPersonalBests(KZPlayer *target, const char *modeName = nullptr);
+	void SubmitJumpToLeaderboard(Jump *jump);
+
 	static void OnServerActivate();
 	static DistanceTier GetDistTierFromString(const char *tierString);
 
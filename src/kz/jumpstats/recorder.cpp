@@ -16,7 +16,7 @@ static_function f64 StopDemoRecording()
 
 void KZJumpstatsService::StartDemoRecording(CUtlString playerName)
 {
-	if (alreadyRecording || !g_pFullFileSystem || !KZOptionService::GetOptionInt("autoDemoRecording"))
+	if (alreadyRecording || !g_pFullFileSystem || !KZOptionService::GetConfig().autoDemoRecording)
 	{
 		return;
 	}
@@ -24,6 +24,9 @@
 
 #define KZ_RECENT_TELEPORT_THRESHOLD 0.05f
 
+// Defined in mode/kz_mode.h
+enum KzModeCvars : i32;
+
 class KZPlayer;
 class KZAnticheatService;
 class KZBeamService;
@@ -138,6 +141,17 @@ private:
 	f32 lastValidYaw {};
 	bool oldUsingTurnbinds {};
 
+	// Mode convar values with style tweaks applied, indexed by KzModeCvars.
+	CUtlVector<const CVValue_t *> modeStyleCvarValues;
+	bool modeStyleCvarValuesDirty = true;
+	void RebuildModeStyleCvarValues();
+
+	// Movement hooks that the mode and styles override, styles are indexed the same way as styleServices.
+	u64 modeHookMask = MVHOOK_MASK_ALL;
+	u64 styleHookMask = MVHOOK_MASK_ALL;
+	CUtlVector<u64> styleHookMasks;
+	void RefreshHookSubscriptions();
+
 public:
 	KZAnticheatService *anticheatService {};
 	KZBeamService *beamService {};
@@ -192,7 +206,11 @@ public:
 	virtual void PrintAlert(bool addPrefix, bool includeSpectators, const char *format, ...);
 	virtual void PrintHTMLCentre(bool addPrefix, bool includeSpectators, const char *format, ...);
 
+	const CVValue_t *GetCvarValueFromModeStyles(KzModeCvars cvar);
 	const CVValue_t *GetCvarValueFromModeStyles(const char *name);
+
+	// Must be called whenever the mode service or the style services are changed.
+	void OnModeStyleServicesChanged();
 };
 
 class KZBaseService
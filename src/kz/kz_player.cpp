@@ -13,6 +13,8 @@
 #include "noclip/kz_noclip.h"
 #include "option/kz_option.h"
 #include "quiet/kz_quiet.h"
+#include "racing/kz_racing.h"
+#include "saveloc/kz_saveloc.h"
 #include "spec/kz_spec.h"
 #include "goto/kz_goto.h"
 #include "style/kz_style.h"
@@ -20,6 +22,8 @@
 #include "timer/kz_timer.h"
 #include "tip/kz_tip.h"
 #include "trigger/kz_trigger.h"
+#include "profiler/kz_profiler.h"
+#include "watchdog/kz_watchdog.h"
 #include "global/kz_global.h"
 
 #include "sdk/datatypes.h"
@@ -30,6 +34,41 @@
 
 extern CSteamGameServerAPIContext g_steamAPI;
 
+// Hooks that KZPlayer itself does work in besides forwarding to the mode and styles, these are always dispatched.
+// clang-format off
+static_global constexpr u64 kzPlayerHookMask =
+	MVHOOK_BIT(MVHOOK_PHYSICSSIMULATE) | MVHOOK_BIT(MVHOOK_PHYSICSSIMULATE_POST)
+	| MVHOOK_BIT(MVHOOK_PROCESSUSERCMDS) | MVHOOK_BIT(MVHOOK_SETUPMOVE)
+	| MVHOOK_BIT(MVHOOK_PROCESSMOVEMENT) | MVHOOK_BIT(MVHOOK_PROCESSMOVEMENT_POST)
+	| MVHOOK_BIT(MVHOOK_CHECKJUMPBUTTON) | MVHOOK_BIT(MVHOOK_JUMP)
+	| MVHOOK_BIT(MVHOOK_AIRMOVE) | MVHOOK_BIT(MVHOOK_AIRMOVE_POST)
+	| MVHOOK_BIT(MVHOOK_TRYPLAYERMOVE) | MVHOOK_BIT(MVHOOK_TRYPLAYERMOVE_POST)
+	| MVHOOK_BIT(MVHOOK_POSTTHINK)
+	| MVHOOK_BIT(MVHOOK_STARTTOUCHGROUND) | MVHOOK_BIT(MVHOOK_STOPTOUCHGROUND) | MVHOOK_BIT(MVHOOK_CHANGEMOVETYPE);
+// clang-format on
+
+// Forward a movement hook to the mode and to every style that subscribes to it.
+#define KZ_FORWARD_HOOK(hook, func, ...) \
+	do \
+	{ \
+		if (this->modeHookMask & MVHOOK_BIT(hook)) \
+		{ \
+			KZ_PROFILE(PROFILE_MODE); \
+			this->modeService->func(__VA_ARGS__); \
+		} \
+		if (this->styleHookMask & MVHOOK_BIT(hook)) \
+		{ \
+			KZ_PROFILE(PROFILE_STYLES); \
+			FOR_EACH_VEC(this->styleServices, i) \
+			{ \
+				if (this->styleHookMasks[i] & MVHOOK_BIT(hook)) \
+				{ \
+					this->styleServices[i]->func(__VA_ARGS__); \
+				} \
+			} \
+		} \
+	} while (0)
+
 void KZPlayer::Init()
 {
 	MovementPlayer::Init();
@@ -53,6 +92,8 @@ void KZPlayer::Init()
 	delete this->triggerService;
 	delete this->globalService;
 	delete this->measureService;
+	delete this->savelocService;
+	delete this->racingService;
 
 	this->anticheatService = new KZAnticheatService(this);
 	this->beamService = new KZBeamService(this);
@@ -72,6 +113,8 @@ void KZPlayer::Init()
 	this->triggerService = new KZTriggerService(this);
 	this->globalService = new KZGlobalService(this);
 	this->measureService = new KZMeasureService(this);
+	this->savelocService = new KZSavelocService(this);
+	this->racingService = new KZRacingService(this);
 
 	KZ::mode::InitModeService(this);
 }
@@ -86,6 +129,8 @@ void KZPlayer::Reset()
 	this->modeService->Reset();
 	this->optionService->Reset();
 	this->checkpointService->Reset();
+	this->savelocService->Reset();
+	this->racingService->Reset();
 	this->noclipService->Reset();
 	this->quietService->Reset();
 	this->jumpstatsService->Reset();
@@ -95,10 +140,12 @@ void KZPlayer::Reset()
 	this->triggerService->Reset();
 	this->measureService->Reset();
 	this->beamService->Reset();
+	this->telemetryService->Reset();
+	this->anticheatService->Reset();
 
-	g_pKZModeManager->SwitchToMode(this, KZOptionService::GetOptionStr("defaultMode", KZ_DEFAULT_MODE), true, true);
+	g_pKZModeManager->SwitchToMode(this, KZOptionService::GetConfig().defaultMode.Get(), true, true);
 	g_pKZStyleManager->ClearStyles(this, true);
-	CSplitString styles(KZOptionService::GetOptionStr("defaultStyles"), ",");
+	CSplitString styles(KZOptionService::GetConfig().defaultStyles.Get(), ",");
 	FOR_EACH_VEC(styles, i)
 	{
 		g_pKZStyleManager->AddStyle(this, styles[i]);
@@ -114,6 +161,8 @@ void KZPlayer::OnPlayerActive()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	// Mode/Styles stuff must be here for convars to be properly replicated.
+	// Anything sent before this point may not have reached the client, so resend everything.
+	KZ::mode::ResetReplicatedModeCvars(this);
 	g_pKZModeManager->SwitchToMode(this, this->modeService->GetModeName(), true, true);
 	g_pKZStyleManager->RefreshStyles(this);
 
@@ -142,13 +191,13 @@ META_RES KZPlayer::GetPlayerMaxSpeed(f32 &maxSpeed)
 void KZPlayer::OnPhysicsSimulate()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
+	KZ_WATCHDOG_SCOPE();
 	MovementPlayer::OnPhysicsSimulate();
-	this->triggerService->OnPhysicsSimulate();
-	this->modeService->OnPhysicsSimulate();
-	FOR_EACH_VEC(this->styleServices, i)
 	{
-		this->styleServices[i]->OnPhysicsSimulate();
+		KZ_PROFILE(PROFILE_TRIGGER);
+		this->triggerService->OnPhysicsSimulate();
 	}
+	KZ_FORWARD_HOOK(MVHOOK_PHYSICSSIMULATE, OnPhysicsSimulate);
 	this->noclipService->HandleMoveCollision();
 	this->EnableGodMode();
 	this->UpdatePlayerModelAlpha();
@@ -157,22 +206,34 @@ void KZPlayer::OnPhysicsSimulate()
 void KZPlayer::OnPhysicsSimulatePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
+	KZ_WATCHDOG_SCOPE();
 	MovementPlayer::OnPhysicsSimulatePost();
-	this->triggerService->OnPhysicsSimulatePost();
-	this->telemetryService->OnPhysicsSimulatePost();
-	this->modeService->OnPhysicsSimulatePost();
-	FOR_EACH_VEC(this->styleServices, i)
 	{
-		this->styleServices[i]->OnPhysicsSimulatePost();
+		KZ_PROFILE(PROFILE_TRIGGER);
+		this->triggerService->OnPhysicsSimulatePost();
 	}
-	this->timerService->OnPhysicsSimulatePost();
-	if (this->specService->GetSpectatedPlayer())
+	// AFK detection works on a scale of seconds, sampling it less often under load is fine.
+	if (KZ::watchdog::ShouldRun(KZ::watchdog::DEGRADE_TELEMETRY, 4))
 	{
-		KZHUDService::DrawPanels(this->specService->GetSpectatedPlayer(), this);
+		KZ_PROFILE(PROFILE_TELEMETRY);
+		this->telemetryService->OnPhysicsSimulatePost();
 	}
-	else if (this->IsAlive())
+	KZ_FORWARD_HOOK(MVHOOK_PHYSICSSIMULATE_POST, OnPhysicsSimulatePost);
 	{
-		KZHUDService::DrawPanels(this, this);
+		KZ_PROFILE(PROFILE_TIMER);
+		this->timerService->OnPhysicsSimulatePost();
+	}
+	if (KZ::watchdog::ShouldRun(KZ::watchdog::DEGRADE_HUD))
+	{
+		KZ_PROFILE(PROFILE_HUD);
+		if (this->specService->GetSpectatedPlayer())
+		{
+			KZHUDService::DrawPanels(this->specService->GetSpectatedPlayer(), this);
+		}
+		else if (this->IsAlive())
+		{
+			KZHUDService::DrawPanels(this, this);
+		}
 	}
 	this->measureService->OnPhysicsSimulatePost();
 }
@@ -180,571 +241,432 @@ void KZPlayer::OnPhysicsSimulatePost()
 void KZPlayer::OnProcessUsercmds(void *cmds, int numcmds)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnProcessUsercmds(cmds, numcmds);
-	FOR_EACH_VEC(this->styleServices, i)
 	{
-		this->styleServices[i]->OnProcessUsercmds(cmds, numcmds);
+		KZ_PROFILE(PROFILE_TELEMETRY);
+		this->telemetryService->OnProcessUsercmds(numcmds);
 	}
+	KZ_FORWARD_HOOK(MVHOOK_PROCESSUSERCMDS, OnProcessUsercmds, cmds, numcmds);
 }
 
 void KZPlayer::OnProcessUsercmdsPost(void *cmds, int numcmds)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnProcessUsercmdsPost(cmds, numcmds);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnProcessUsercmdsPost(cmds, numcmds);
-	}
+	KZ_FORWARD_HOOK(MVHOOK_PROCESSUSERCMDS_POST, OnProcessUsercmdsPost, cmds, numcmds);
 }
 
 void KZPlayer::OnSetupMove(PlayerCommand *pc)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnSetupMove(pc);
-	FOR_EACH_VEC(this->styleServices, i)
 	{
-		this->styleServices[i]->OnSetupMove(pc);
+		KZ_PROFILE(PROFILE_TELEMETRY);
+		this->telemetryService->OnSetupMove(pc->cmdNum);
 	}
+	KZ_FORWARD_HOOK(MVHOOK_SETUPMOVE, OnSetupMove, pc);
 }
 
 void KZPlayer::OnSetupMovePost(PlayerCommand *pc)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnSetupMovePost(pc);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnSetupMovePost(pc);
-	}
+	KZ_FORWARD_HOOK(MVHOOK_SETUPMOVE_POST, OnSetupMovePost, pc);
 }
 
 void KZPlayer::OnProcessMovement()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
+	KZ_WATCHDOG_SCOPE();
 	MovementPlayer::OnProcessMovement();
 	KZ::mode::ApplyModeSettings(this);
 
 	this->DisableTurnbinds();
-	this->triggerService->OnProcessMovement();
-	this->modeService->OnProcessMovement();
-	FOR_EACH_VEC(this->styleServices, i)
 	{
-		this->styleServices[i]->OnProcessMovement();
+		KZ_PROFILE(PROFILE_TRIGGER);
+		this->triggerService->OnProcessMovement();
 	}
+	KZ_FORWARD_HOOK(MVHOOK_PROCESSMOVEMENT, OnProcessMovement);
 
-	this->jumpstatsService->OnProcessMovement();
+	{
+		KZ_PROFILE(PROFILE_JUMPSTATS);
+		this->jumpstatsService->OnProcessMovement();
+	}
 	this->checkpointService->TpHoldPlayerStill();
+	this->racingService->OnProcessMovement();
 }
 
 void KZPlayer::OnProcessMovementPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
+	KZ_WATCHDOG_SCOPE();
 
-	this->jumpstatsService->UpdateJump();
-	this->modeService->OnProcessMovementPost();
-	FOR_EACH_VEC(this->styleServices, i)
 	{
-		this->styleServices[i]->OnProcessMovementPost();
+		KZ_PROFILE(PROFILE_JUMPSTATS);
+		this->jumpstatsService->UpdateJump();
+	}
+	KZ_FORWARD_HOOK(MVHOOK_PROCESSMOVEMENT_POST, OnProcessMovementPost);
+	{
+		KZ_PROFILE(PROFILE_JUMPSTATS);
+		this->jumpstatsService->OnProcessMovementPost();
+	}
+	{
+		KZ_PROFILE(PROFILE_TRIGGER);
+		this->triggerService->OnProcessMovementPost();
 	}
-	this->jumpstatsService->OnProcessMovementPost();
-	this->triggerService->OnProcessMovementPost();
 	MovementPlayer::OnProcessMovementPost();
 }
 
 void KZPlayer::OnPlayerMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnPlayerMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPlayerMove();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_PLAYERMOVE, OnPlayerMove);
 }
 
 void KZPlayer::OnPlayerMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnPlayerMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPlayerMovePost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_PLAYERMOVE_POST, OnPlayerMovePost);
 }
 
 void KZPlayer::OnCheckParameters()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckParameters();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckParameters();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CHECKPARAMETERS, OnCheckParameters);
 }
 
 void KZPlayer::OnCheckParametersPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckParametersPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckParametersPost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CHECKPARAMETERS_POST, OnCheckParametersPost);
 }
 
 void KZPlayer::OnCanMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCanMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCanMove();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CANMOVE, OnCanMove);
 }
 
 void KZPlayer::OnCanMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCanMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCanMovePost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CANMOVE_POST, OnCanMovePost);
 }
 
 void KZPlayer::OnFullWalkMove(bool &ground)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnFullWalkMove(ground);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnFullWalkMove(ground);
-	}
+	KZ_FORWARD_HOOK(MVHOOK_FULLWALKMOVE, OnFullWalkMove, ground);
 }
 
 void KZPlayer::OnFullWalkMovePost(bool ground)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnFullWalkMovePost(ground);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnFullWalkMovePost(ground);
-	}
+	KZ_FORWARD_HOOK(MVHOOK_FULLWALKMOVE_POST, OnFullWalkMovePost, ground);
 }
 
 void KZPlayer::OnMoveInit()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnMoveInit();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnMoveInit();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_MOVEINIT, OnMoveInit);
 }
 
 void KZPlayer::OnMoveInitPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnMoveInitPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnMoveInitPost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_MOVEINIT_POST, OnMoveInitPost);
 }
 
 void KZPlayer::OnCheckWater()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckWater();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckWater();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CHECKWATER, OnCheckWater);
 }
 
 void KZPlayer::OnWaterMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnWaterMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnWaterMove();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_WATERMOVE, OnWaterMove);
 }
 
 void KZPlayer::OnWaterMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnWaterMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnWaterMovePost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_WATERMOVE_POST, OnWaterMovePost);
 }
 
 void KZPlayer::OnCheckWaterPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckWaterPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckWaterPost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CHECKWATER_POST, OnCheckWaterPost);
 }
 
 void KZPlayer::OnCheckVelocity(const char *a3)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckVelocity(a3);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckVelocity(a3);
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CHECKVELOCITY, OnCheckVelocity, a3);
 }
 
 void KZPlayer::OnCheckVelocityPost(const char *a3)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckVelocityPost(a3);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckVelocityPost(a3);
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CHECKVELOCITY_POST, OnCheckVelocityPost, a3);
 }
 
 void KZPlayer::OnDuck()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnDuck();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnDuck();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_DUCK, OnDuck);
 }
 
 void KZPlayer::OnDuckPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnDuckPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnDuckPost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_DUCK_POST, OnDuckPost);
 }
 
 void KZPlayer::OnCanUnduck()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCanUnduck();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCanUnduck();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CANUNDUCK, OnCanUnduck);
 }
 
 void KZPlayer::OnCanUnduckPost(bool &ret)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCanUnduckPost(ret);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCanUnduckPost(ret);
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CANUNDUCK_POST, OnCanUnduckPost, ret);
 }
 
 void KZPlayer::OnLadderMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnLadderMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnLadderMove();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_LADDERMOVE, OnLadderMove);
 }
 
 void KZPlayer::OnLadderMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnLadderMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnLadderMovePost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_LADDERMOVE_POST, OnLadderMovePost);
 }
 
 void KZPlayer::OnCheckJumpButton()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckJumpButton();
-	FOR_EACH_VEC(this->styleServices, i)
+	KZ_FORWARD_HOOK(MVHOOK_CHECKJUMPBUTTON, OnCheckJumpButton);
 	{
-		this->styleServices[i]->OnCheckJumpButton();
+		KZ_PROFILE(PROFILE_TRIGGER);
+		this->triggerService->OnCheckJumpButton();
 	}
-	this->triggerService->OnCheckJumpButton();
 }
 
 void KZPlayer::OnCheckJumpButtonPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckJumpButtonPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckJumpButtonPost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CHECKJUMPBUTTON_POST, OnCheckJumpButtonPost);
 }
 
 void KZPlayer::OnJump()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnJump();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnJump();
-	}
+	this->telemetryService->OnJump();
+	KZ_FORWARD_HOOK(MVHOOK_JUMP, OnJump);
 }
 
 void KZPlayer::OnJumpPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnJumpPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnJumpPost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_JUMP_POST, OnJumpPost);
 }
 
 void KZPlayer::OnAirMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnAirMove();
-	FOR_EACH_VEC(this->styleServices, i)
+	KZ_FORWARD_HOOK(MVHOOK_AIRMOVE, OnAirMove);
 	{
-		this->styleServices[i]->OnAirMove();
+		KZ_PROFILE(PROFILE_JUMPSTATS);
+		this->jumpstatsService->OnAirMove();
 	}
-	this->jumpstatsService->OnAirMove();
 }
 
 void KZPlayer::OnAirMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnAirMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
+	KZ_FORWARD_HOOK(MVHOOK_AIRMOVE_POST, OnAirMovePost);
 	{
-		this->styleServices[i]->OnAirMovePost();
+		KZ_PROFILE(PROFILE_JUMPSTATS);
+		this->jumpstatsService->OnAirMovePost();
 	}
-	this->jumpstatsService->OnAirMovePost();
 }
 
 void KZPlayer::OnFriction()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnFriction();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnFriction();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_FRICTION, OnFriction);
 }
 
 void KZPlayer::OnFrictionPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnFrictionPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnFrictionPost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_FRICTION_POST, OnFrictionPost);
 }
 
 void KZPlayer::OnWalkMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnWalkMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnWalkMove();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_WALKMOVE, OnWalkMove);
 }
 
 void KZPlayer::OnWalkMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnWalkMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnWalkMovePost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_WALKMOVE_POST, OnWalkMovePost);
 }
 
 void KZPlayer::OnTryPlayerMove(Vector *pFirstDest, trace_t *pFirstTrace)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnTryPlayerMove(pFirstDest, pFirstTrace);
-	FOR_EACH_VEC(this->styleServices, i)
+	KZ_FORWARD_HOOK(MVHOOK_TRYPLAYERMOVE, OnTryPlayerMove, pFirstDest, pFirstTrace);
 	{
-		this->styleServices[i]->OnTryPlayerMove(pFirstDest, pFirstTrace);
+		KZ_PROFILE(PROFILE_JUMPSTATS);
+		this->jumpstatsService->OnTryPlayerMove();
 	}
-	this->jumpstatsService->OnTryPlayerMove();
 }
 
 void KZPlayer::OnTryPlayerMovePost(Vector *pFirstDest, trace_t *pFirstTrace)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnTryPlayerMovePost(pFirstDest, pFirstTrace);
-	FOR_EACH_VEC(this->styleServices, i)
+	KZ_FORWARD_HOOK(MVHOOK_TRYPLAYERMOVE_POST, OnTryPlayerMovePost, pFirstDest, pFirstTrace);
 	{
-		this->styleServices[i]->OnTryPlayerMovePost(pFirstDest, pFirstTrace);
+		KZ_PROFILE(PROFILE_JUMPSTATS);
+		this->jumpstatsService->OnTryPlayerMovePost();
 	}
-	this->jumpstatsService->OnTryPlayerMovePost();
 }
 
 void KZPlayer::OnCategorizePosition(bool bStayOnGround)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCategorizePosition(bStayOnGround);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCategorizePosition(bStayOnGround);
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CATEGORIZEPOSITION, OnCategorizePosition, bStayOnGround);
 }
 
 void KZPlayer::OnCategorizePositionPost(bool bStayOnGround)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCategorizePositionPost(bStayOnGround);
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCategorizePositionPost(bStayOnGround);
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CATEGORIZEPOSITION_POST, OnCategorizePositionPost, bStayOnGround);
 }
 
 void KZPlayer::OnFinishGravity()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnFinishGravity();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnFinishGravity();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_FINISHGRAVITY, OnFinishGravity);
 }
 
 void KZPlayer::OnFinishGravityPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnFinishGravityPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnFinishGravityPost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_FINISHGRAVITY_POST, OnFinishGravityPost);
 }
 
 void KZPlayer::OnCheckFalling()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckFalling();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckFalling();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CHECKFALLING, OnCheckFalling);
 }
 
 void KZPlayer::OnCheckFallingPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnCheckFallingPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnCheckFallingPost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_CHECKFALLING_POST, OnCheckFallingPost);
 }
 
 void KZPlayer::OnPostPlayerMove()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnPostPlayerMove();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPostPlayerMove();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_POSTPLAYERMOVE, OnPostPlayerMove);
 }
 
 void KZPlayer::OnPostPlayerMovePost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnPostPlayerMovePost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPostPlayerMovePost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_POSTPLAYERMOVE_POST, OnPostPlayerMovePost);
 }
 
 void KZPlayer::OnPostThink()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnPostThink();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPostThink();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_POSTTHINK, OnPostThink);
 	MovementPlayer::OnPostThink();
 }
 
 void KZPlayer::OnPostThinkPost()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->modeService->OnPostThinkPost();
-	FOR_EACH_VEC(this->styleServices, i)
-	{
-		this->styleServices[i]->OnPostThinkPost();
-	}
+	KZ_FORWARD_HOOK(MVHOOK_POSTTHINK_POST, OnPostThinkPost);
 }
 
 void KZPlayer::OnStartTouchGround()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->jumpstatsService->EndJump();
-	this->timerService->OnStartTouchGround();
-	this->modeService->OnStartTouchGround();
-	FOR_EACH_VEC(this->styleServices, i)
 	{
-		this->styleServices[i]->OnStartTouchGround();
+		KZ_PROFILE(PROFILE_JUMPSTATS);
+		this->jumpstatsService->EndJump();
+	}
+	{
+		KZ_PROFILE(PROFILE_TIMER);
+		this->timerService->OnStartTouchGround();
 	}
+	KZ_FORWARD_HOOK(MVHOOK_STARTTOUCHGROUND, OnStartTouchGround);
 }
 
 void KZPlayer::OnStopTouchGround()
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->timerService->OnStopTouchGround();
-	this->modeService->OnStopTouchGround();
-	FOR_EACH_VEC(this->styleServices, i)
 	{
-		this->styleServices[i]->OnStopTouchGround();
+		KZ_PROFILE(PROFILE_TIMER);
+		this->timerService->OnStopTouchGround();
+	}
+	KZ_FORWARD_HOOK(MVHOOK_STOPTOUCHGROUND, OnStopTouchGround);
+	{
+		KZ_PROFILE(PROFILE_JUMPSTATS);
+		this->jumpstatsService->AddJump();
+	}
+	{
+		KZ_PROFILE(PROFILE_TRIGGER);
+		this->triggerService->OnStopTouchGround();
 	}
-	this->jumpstatsService->AddJump();
-	this->triggerService->OnStopTouchGround();
 }
 
 void KZPlayer::OnChangeMoveType(MoveType_t oldMoveType)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
-	this->jumpstatsService->OnChangeMoveType(oldMoveType);
-	this->timerService->OnChangeMoveType(oldMoveType);
-	this->modeService->OnChangeMoveType(oldMoveType);
-	FOR_EACH_VEC(this->styleServices, i)
 	{
-		this->styleServices[i]->OnChangeMoveType(oldMoveType);
+		KZ_PROFILE(PROFILE_JUMPSTATS);
+		this->jumpstatsService->OnChangeMoveType(oldMoveType);
 	}
+	{
+		KZ_PROFILE(PROFILE_TIMER);
+		this->timerService->OnChangeMoveType(oldMoveType);
+	}
+	KZ_FORWARD_HOOK(MVHOOK_CHANGEMOVETYPE, OnChangeMoveType, oldMoveType);
 }
 
 void KZPlayer::OnTeleport(const Vector *origin, const QAngle *angles, const Vector *velocity)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	this->lastTeleportTime = g_pKZUtils->GetServerGlobals()->curtime;
-	this->jumpstatsService->InvalidateJumpstats("Teleported");
+	{
+		KZ_PROFILE(PROFILE_JUMPSTATS);
+		this->jumpstatsService->InvalidateJumpstats("Teleported");
+	}
 	this->modeService->OnTeleport(origin, angles, velocity);
-	this->timerService->OnTeleport(origin, angles, velocity);
+	{
+		KZ_PROFILE(PROFILE_TIMER);
+		this->timerService->OnTeleport(origin, angles, velocity);
+	}
 	if (origin)
 	{
 		this->beamService->OnTeleport();
 	}
-	this->triggerService->OnTeleport();
+	{
+		KZ_PROFILE(PROFILE_TRIGGER);
+		this->triggerService->OnTeleport();
+	}
+	this->telemetryService->OnTeleport();
 }
 
 void KZPlayer::DisableTurnbinds()
@@ -815,7 +737,7 @@ bool KZPlayer::JustTeleported(f32 threshold)
 void KZPlayer::ToggleHideLegs()
 {
 	this->hideLegs = !this->hideLegs;
-	this->optionService->SetPreferenceBool("hideLegs", this->hideLegs);
+	this->optionService->SetPreference(KZ::pref::hideLegs, this->hideLegs);
 }
 
 void KZPlayer::PlayErrorSound()
@@ -838,6 +760,61 @@ void KZPlayer::OnChangeTeamPost(i32 team)
 	this->timerService->OnPlayerJoinTeam(team);
 }
 
+void KZPlayer::OnModeStyleServicesChanged()
+{
+	this->modeStyleCvarValuesDirty = true;
+	this->RefreshHookSubscriptions();
+}
+
+void KZPlayer::RefreshHookSubscriptions()
+{
+	this->modeHookMask = this->modeService ? this->modeService->GetSubscribedHooks() : 0;
+	this->styleHookMask = 0;
+	this->styleHookMasks.SetCount(this->styleServices.Count());
+	FOR_EACH_VEC(this->styleServices, i)
+	{
+		this->styleHookMasks[i] = this->styleServices[i]->GetSubscribedHooks();
+		this->styleHookMask |= this->styleHookMasks[i];
+	}
+	this->subscribedHooks = kzPlayerHookMask | this->modeHookMask | this->styleHookMask;
+}
+
+void KZPlayer::RebuildModeStyleCvarValues()
+{
+	this->modeStyleCvarValues.SetCount(MODECVAR_COUNT);
+	const CVValue_t *modeValues = this->modeService->GetModeConVarValues();
+	for (i32 i = 0; i < MODECVAR_COUNT; i++)
+	{
+		this->modeStyleCvarValues[i] = &modeValues[i];
+		// Later styles take priority over earlier ones.
+		FOR_EACH_VEC_BACK(this->styleServices, j)
+		{
+			const CVValue_t *tweakedValue = this->styleServices[j]->GetTweakedConvarValue(KZ::mode::modeCvarNames[i]);
+			if (tweakedValue)
+			{
+				this->modeStyleCvarValues[i] = tweakedValue;
+				break;
+			}
+		}
+	}
+	this->modeStyleCvarValuesDirty = false;
+}
+
+const CVValue_t *KZPlayer::GetCvarValueFromModeStyles(KzModeCvars cvar)
+{
+	if (cvar < MODECVAR_FIRST || cvar >= MODECVAR_COUNT)
+	{
+		assert(0);
+		return CVValue_t::InvalidValue();
+	}
+
+	if (this->modeStyleCvarValuesDirty)
+	{
+		this->RebuildModeStyleCvarValues();
+	}
+	return this->modeStyleCvarValues[cvar];
+}
+
 const CVValue_t *KZPlayer::GetCvarValueFromModeStyles(const char *name)
 {
 	if (!name)
@@ -846,6 +823,15 @@ const CVValue_t *KZPlayer::GetCvarValueFromModeStyles(const char *name)
 		return CVValue_t::InvalidValue();
 	}
 
+	// Prefer the cached mode convar path, only fall back to a cvar lookup for convars that modes don't control.
+	for (i32 i = 0; i < MODECVAR_COUNT; i++)
+	{
+		if (KZ_STREQI(KZ::mode::modeCvarNames[i], name))
+		{
+			return this->GetCvarValueFromModeStyles((KzModeCvars)i);
+		}
+	}
+
 	ConVarRefAbstract cvarRef(name);
 	if (!cvarRef.IsValidRef() || !cvarRef.IsConVarDataAvailable())
 	{
@@ -862,17 +848,5 @@ const CVValue_t *KZPlayer::GetCvarValueFromModeStyles(const char *name)
 		}
 	}
 
-	for (int i = 0; i < MODECVAR_COUNT; i++)
-	{
-		if (!KZ::mode::modeCvarRefs[i]->IsValidRef() || !KZ::mode::modeCvarRefs[i]->IsConVarDataAvailable())
-		{
-			continue;
-		}
-		if (!V_stricmp(KZ::mode::modeCvarRefs[i]->GetName(), name))
-		{
-			return &this->modeService->GetModeConVarValues()[i];
-		}
-	}
-
 	return cvarRef.GetConVarData()->Value(-1);
 }
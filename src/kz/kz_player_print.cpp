@@ -11,7 +11,7 @@
 	char buffer[512]; \
 	if (addPrefix) \
 	{ \
-		const char *prefix = KZOptionService::GetOptionStr("chatPrefix", KZ_DEFAULT_CHAT_PREFIX); \
+		const char *prefix = KZOptionService::GetConfig().chatPrefix.Get(); \
 		snprintf(buffer, sizeof(buffer), "%s ", prefix); \
 		vsnprintf(buffer + strlen(prefix) + 1, sizeof(buffer) - (strlen(prefix) + 1), format, args); \
 	} \
@@ -130,7 +130,7 @@ void KZPlayer::PrintHTMLCentre(bool addPrefix, bool includeSpectators, const cha
 
 	if (addPrefix)
 	{
-		const char *prefix = KZOptionService::GetOptionStr("chatPrefix", KZ_DEFAULT_CHAT_PREFIX);
+		const char *prefix = KZOptionService::GetConfig().chatPrefix.Get();
 		buffer.Format("%s %s", prefix, buffer.Get());
 	}
 
@@ -97,7 +97,7 @@ void KZLanguageService::LoadTranslations()
 
 void KZLanguageService::OnPlayerPreferencesLoaded()
 {
-	const char *language = this->player->optionService->GetPreferenceStr("preferredLanguage");
+	const char *language = this->player->optionService->GetPreference(KZ::pref::preferredLanguage);
 	bool shouldReconnect = !(this->player->checkpointService->GetCheckpointCount() || this->player->timerService->GetTimerRunning());
 	if (language[0])
 	{
@@ -171,7 +171,7 @@ void KZLanguageService::OnPlayerConnect(u64 steamID64)
 	{
 		return;
 	}
-	this->UpdateLanguage(steamID64, KZOptionService::GetOptionStr("defaultLanguage", KZ_DEFAULT_LANGUAGE), LanguageInfo::CacheLevel::CACHE_NONE,
+	this->UpdateLanguage(steamID64, KZOptionService::GetConfig().defaultLanguage.Get(), LanguageInfo::CacheLevel::CACHE_NONE,
 						 false);
 	if (g_pClientCvarValue)
 	{
@@ -192,7 +192,7 @@ void KZLanguageService::OnPlayerConnect(u64 steamID64)
 
 KZLanguageService::LanguageInfo::LanguageInfo()
 {
-	V_strncpy(this->language, KZOptionService::GetOptionStr("defaultLanguage", KZ_DEFAULT_LANGUAGE), sizeof(this->language));
+	V_strncpy(this->language, KZOptionService::GetConfig().defaultLanguage.Get(), sizeof(this->language));
 }
 
 SCMD(kz_language, SCFL_PREFERENCE)
@@ -203,7 +203,7 @@ SCMD(kz_language, SCFL_PREFERENCE)
 	V_strlower(language);
 	bool shouldReconnect = !(player->checkpointService->GetCheckpointCount() || player->timerService->GetTimerRunning());
 	KZLanguageService::UpdateLanguage(player->GetSteamId64(), language, KZLanguageService::LanguageInfo::CacheLevel::CACHE_OVERRIDE, true);
-	player->optionService->SetPreferenceStr("preferredLanguage", language);
+	player->optionService->SetPreference(KZ::pref::preferredLanguage, language);
 	if (!shouldReconnect)
 	{
 		player->languageService->PrintChat(true, false, "Switch Language", language);
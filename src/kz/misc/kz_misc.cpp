@@ -29,7 +29,7 @@ static_global class KZOptionServiceEventListener_Misc : public KZOptionServiceEv
 {
 	virtual void OnPlayerPreferencesLoaded(KZPlayer *player)
 	{
-		bool hideLegs = player->optionService->GetPreferenceBool("hideLegs", false);
+		bool hideLegs = player->optionService->GetPreference(KZ::pref::hideLegs, false);
 		if (player->HidingLegs() != hideLegs)
 		{
 			player->ToggleHideLegs();
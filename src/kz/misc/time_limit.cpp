@@ -103,5 +103,5 @@ void KZ::misc::UnrestrictTimeLimit()
 
 void KZ::misc::InitTimeLimit()
 {
-	mp_timelimit.Set(KZOptionService::GetOptionFloat("defaultTimeLimit", 60.0f));
+	mp_timelimit.Set(static_cast<f32>(KZOptionService::GetConfig().defaultTimeLimit));
 }
@@ -5,9 +5,9 @@
 #include "../jumpstats/kz_jumpstats.h"
 #include "UtlStringMap.h"
 
-#define KZ_MODE_MANAGER_INTERFACE "KZModeManagerInterface"
+#define KZ_MODE_MANAGER_INTERFACE "KZModeManagerInterface002"
 
-enum KzModeCvars
+enum KzModeCvars : i32
 {
 	MODECVAR_FIRST = 0,
 	MODECVAR_SLOPE_DROP_ENABLE = 0,
@@ -197,6 +197,13 @@ public:
 
 	// Other events
 	virtual void OnTeleport(const Vector *newPosition, const QAngle *newAngles, const Vector *newVelocity) {}
+
+	// Movement hooks that this mode implements, see MovementHook. Hooks outside of this mask are not forwarded to the mode.
+	// Modes should return movement::GetOverriddenHooks<ModeClass, KZModeService>() unless they need something more specific.
+	virtual u64 GetSubscribedHooks()
+	{
+		return MVHOOK_MASK_ALL;
+	}
 };
 
 typedef KZModeService *(*ModeServiceFactory)(KZPlayer *player);
@@ -308,6 +315,13 @@ namespace KZ::mode
 	static_assert(KZ_ARRAYSIZE(modeCvarNames) == MODECVAR_COUNT, "Array modeCvarRefs length is not the same as MODECVAR_COUNT!");
 
 	void ApplyModeSettings(KZPlayer *player);
+
+	// Send the mode convars (with style tweaks) that differ from what the client last received, in a single message.
+	void ReplicateModeCvars(KZPlayer *player);
+	// Forget what the client last received, so the next replication sends every mode convar.
+	void ResetReplicatedModeCvars(KZPlayer *player);
+	// Call this when a mode convar is replicated to the client outside of ReplicateModeCvars.
+	void InvalidateReplicatedModeCvar(KZPlayer *player, KzModeCvars cvar);
 	void DisableReplicatedModeCvars();
 	void EnableReplicatedModeCvars();
 
@@ -144,7 +144,7 @@ void KZClassicModeService::Reset()
 	this->forcedUnduck = {};
 	this->postProcessMovementZSpeed = {};
 
-	this->angleHistory.RemoveAll();
+	this->ClearAngleHistory();
 	this->leftPreRatio = {};
 	this->rightPreRatio = {};
 	this->bonusSpeed = {};
@@ -438,32 +438,64 @@ void KZClassicModeService::ReduceDuckSlowdown()
 
 void KZClassicModeService::UpdateAngleHistory()
 {
-	CMoveData *mv = this->player->currentMoveData;
-	u32 oldEntries = 0;
-	FOR_EACH_VEC(this->angleHistory, i)
+	f32 curtime = g_pKZUtils->GetGlobals()->curtime;
+	while (this->angleHistoryCount > 0 && this->angleHistory[this->angleHistoryStart].when + PS_TURN_RATE_WINDOW < curtime)
 	{
-		if (this->angleHistory[i].when + PS_TURN_RATE_WINDOW < g_pKZUtils->GetGlobals()->curtime)
-		{
-			oldEntries++;
-			continue;
-		}
-		break;
+		this->PopAngleHistory();
 	}
-	this->angleHistory.RemoveMultipleFromHead(oldEntries);
 	if ((this->player->GetPlayerPawn()->m_fFlags & FL_ONGROUND) == 0)
 	{
 		return;
 	}
+	this->PushAngleHistory(this->CalcTurnRate());
+}
+
+void KZClassicModeService::PushAngleHistory(f32 rate)
+{
+	// Should only happen if a lot of usercmds are processed within the same window, the oldest entry is the least relevant.
+	if (this->angleHistoryCount == PS_ANGLE_HISTORY_SIZE)
+	{
+		this->PopAngleHistory();
+	}
+	AngleHistory &angHist = this->angleHistory[(this->angleHistoryStart + this->angleHistoryCount) & (PS_ANGLE_HISTORY_SIZE - 1)];
+	angHist.rate = rate;
+	angHist.when = g_pKZUtils->GetGlobals()->curtime;
+	angHist.duration = g_pKZUtils->GetGlobals()->frametime;
+	this->angleHistoryCount++;
+	this->angleHistoryWeightedRate += angHist.rate * angHist.duration;
+	this->angleHistoryDuration += angHist.duration;
+}
+
+void KZClassicModeService::PopAngleHistory()
+{
+	const AngleHistory &angHist = this->angleHistory[this->angleHistoryStart];
+	this->angleHistoryWeightedRate -= angHist.rate * angHist.duration;
+	this->angleHistoryDuration -= angHist.duration;
+	this->angleHistoryStart = (this->angleHistoryStart + 1) & (PS_ANGLE_HISTORY_SIZE - 1);
+	this->angleHistoryCount--;
+	// Reset the sums whenever the history empties out so floating point error can't build up.
+	if (this->angleHistoryCount == 0)
+	{
+		this->ClearAngleHistory();
+	}
+}
 
-	AngleHistory *angHist = this->angleHistory.AddToTailGetPtr();
-	angHist->when = g_pKZUtils->GetGlobals()->curtime;
-	angHist->duration = g_pKZUtils->GetGlobals()->frametime;
+void KZClassicModeService::ClearAngleHistory()
+{
+	this->angleHistoryStart = 0;
+	this->angleHistoryCount = 0;
+	this->angleHistoryWeightedRate = 0.0;
+	this->angleHistoryDuration = 0.0;
+}
+
+f32 KZClassicModeService::CalcTurnRate()
+{
+	CMoveData *mv = this->player->currentMoveData;
 
 	// Not turning if velocity is null.
 	if (mv->m_vecVelocity.Length2D() == 0)
 	{
-		angHist->rate = 0;
-		return;
+		return 0;
 	}
 
 	// Copying from WalkMove
@@ -496,8 +528,7 @@ void KZClassicModeService::UpdateAngleHistory()
 
 	if (wishdir.Length() == 0)
 	{
-		angHist->rate = 0;
-		return;
+		return 0;
 	}
 
 	Vector velocity = mv->m_vecVelocity;
@@ -509,26 +540,19 @@ void KZClassicModeService::UpdateAngleHistory()
 	VectorAngles(velocity, velAngle);
 	accelAngle.y = g_pKZUtils->NormalizeDeg(accelAngle.y);
 	velAngle.y = g_pKZUtils->NormalizeDeg(velAngle.y);
-	angHist->rate = g_pKZUtils->GetAngleDifference(velAngle.y, accelAngle.y, 180.0, true);
+	return g_pKZUtils->GetAngleDifference(velAngle.y, accelAngle.y, 180.0, true);
 }
 
 void KZClassicModeService::CalcPrestrafe()
 {
-	f32 totalDuration = 0;
-	f32 sumWeightedAngles = 0;
-	FOR_EACH_VEC(this->angleHistory, i)
-	{
-		sumWeightedAngles += this->angleHistory[i].rate * this->angleHistory[i].duration;
-		totalDuration += this->angleHistory[i].duration;
-	}
 	f32 averageRate;
-	if (totalDuration == 0)
+	if (this->angleHistoryCount == 0 || this->angleHistoryDuration <= 0.0)
 	{
 		averageRate = 0;
 	}
 	else
 	{
-		averageRate = sumWeightedAngles / totalDuration;
+		averageRate = (f32)(this->angleHistoryWeightedRate / this->angleHistoryDuration);
 	}
 
 	f32 rewardRate = Clamp(fabs(averageRate) / PS_MAX_REWARD_RATE, 0.0f, 1.0f) * g_pKZUtils->GetGlobals()->frametime;
@@ -20,6 +20,11 @@
 #define PS_MAX_PS_TIME      0.50f // Time to reach maximum prestrafe speed with optimal turning
 #define PS_TURN_RATE_WINDOW 0.02f // Turn rate will be computed over this amount of time
 #define PS_DECREMENT_RATIO  3.0f  // Prestrafe will lose this fast compared to gaining
+// Highest tick rate the turn rate window is expected to be sampled at.
+#define PS_MAX_TICK_RATE 128.0f
+// Capacity of the angle history ring buffer. Covers PS_TURN_RATE_WINDOW at the maximum tick rate,
+// with headroom for several usercmds being processed in the same tick. Must be a power of two.
+#define PS_ANGLE_HISTORY_SIZE 16
 // Controls the ratio between prestrafe ratio and gain.
 // The lower the value, the faster the prespeed gain at the start, but the slower the gain near the max value.
 // 1 means prestrafe gain is linear with the ratio.
@@ -117,7 +122,16 @@ class KZClassicModeService : public KZModeService
 		f32 duration;
 	};
 
-	CUtlVector<AngleHistory> angleHistory;
+	static_assert((PS_ANGLE_HISTORY_SIZE & (PS_ANGLE_HISTORY_SIZE - 1)) == 0, "PS_ANGLE_HISTORY_SIZE must be a power of two!");
+	static_assert(PS_ANGLE_HISTORY_SIZE >= PS_TURN_RATE_WINDOW * PS_MAX_TICK_RATE + 1, "PS_ANGLE_HISTORY_SIZE is too small for PS_TURN_RATE_WINDOW!");
+
+	// Ring buffer of ground turn rates within PS_TURN_RATE_WINDOW, oldest entry first.
+	AngleHistory angleHistory[PS_ANGLE_HISTORY_SIZE] {};
+	u32 angleHistoryStart {};
+	u32 angleHistoryCount {};
+	// Running sums over the entries currently in angleHistory.
+	f64 angleHistoryWeightedRate {};
+	f64 angleHistoryDuration {};
 	f32 leftPreRatio {};
 	f32 rightPreRatio {};
 	f32 bonusSpeed {};
@@ -141,6 +155,11 @@ public:
 	virtual const char *GetModeName() override;
 	virtual const char *GetModeShortName() override;
 
+	virtual u64 GetSubscribedHooks() override
+	{
+		return movement::GetOverriddenHooks<KZClassicModeService, KZModeService>();
+	}
+
 	virtual bool EnableWaterFix() override;
 
 	virtual DistanceTier GetDistanceTier(JumpType jumpType, f32 distance) override;
@@ -175,6 +194,10 @@ public:
 	void RestoreInterpolatedViewAngles();
 
 	void UpdateAngleHistory();
+	void PushAngleHistory(f32 rate);
+	void PopAngleHistory();
+	void ClearAngleHistory();
+	f32 CalcTurnRate();
 	void CalcPrestrafe();
 	f32 GetPrestrafeGain();
 
@@ -22,6 +22,9 @@ KZModeManager *g_pKZModeManager = &modeManager;
 
 CUtlVector<KZModeManager::ModePluginInfo> modeInfos;
 
+// Mode convar values that each client last received from us, empty if unknown.
+static_global CUtlString replicatedModeCvarValues[MAXPLAYERS + 1][MODECVAR_COUNT];
+
 static_global class KZDatabaseServiceEventListener_Modes : public KZDatabaseServiceEventListener
 {
 public:
@@ -115,6 +118,7 @@ void KZ::mode::InitModeService(KZPlayer *player)
 {
 	delete player->modeService;
 	player->modeService = new KZVanillaModeService(player);
+	player->OnModeStyleServicesChanged();
 }
 
 void KZ::mode::DisableReplicatedModeCvars()
@@ -147,6 +151,49 @@ void KZ::mode::ApplyModeSettings(KZPlayer *player)
 	player->enableWaterFix = player->modeService->EnableWaterFix();
 }
 
+void KZ::mode::ReplicateModeCvars(KZPlayer *player)
+{
+	CUtlString *lastValues = replicatedModeCvarValues[player->GetPlayerSlot().Get()];
+	const char *cvarNames[MODECVAR_COUNT];
+	const char *cvarValues[MODECVAR_COUNT];
+	u32 count = 0;
+	for (u32 i = 0; i < MODECVAR_COUNT; i++)
+	{
+		if (!modeCvarRefs[i]->IsValidRef() || !modeCvarRefs[i]->IsConVarDataAvailable())
+		{
+			continue;
+		}
+		CBufferStringN<32> value;
+		modeCvarRefs[i]->TypeTraits()->ValueToString(player->GetCvarValueFromModeStyles((KzModeCvars)i), value);
+		if (!lastValues[i].IsEmpty() && KZ_STREQ(lastValues[i].Get(), value.Get()))
+		{
+			continue;
+		}
+		lastValues[i] = value.Get();
+		cvarNames[count] = modeCvarNames[i];
+		// Point at the cached copy, the buffer goes out of scope at the end of the iteration.
+		cvarValues[count] = lastValues[i].Get();
+		count++;
+	}
+	if (count > 0)
+	{
+		utils::SendMultipleConVarValues(player->GetPlayerSlot(), cvarNames, cvarValues, count);
+	}
+}
+
+void KZ::mode::ResetReplicatedModeCvars(KZPlayer *player)
+{
+	for (u32 i = 0; i < MODECVAR_COUNT; i++)
+	{
+		replicatedModeCvarValues[player->GetPlayerSlot().Get()][i].Clear();
+	}
+}
+
+void KZ::mode::InvalidateReplicatedModeCvar(KZPlayer *player, KzModeCvars cvar)
+{
+	replicatedModeCvarValues[player->GetPlayerSlot().Get()][cvar].Clear();
+}
+
 bool KZModeManager::RegisterMode(PluginId id, const char *shortModeName, const char *longModeName, ModeServiceFactory factory)
 {
 	if (!shortModeName || V_strlen(shortModeName) == 0 || !longModeName || V_strlen(longModeName) == 0)
@@ -284,6 +331,7 @@ bool KZModeManager::SwitchToMode(KZPlayer *player, const char *modeName, bool si
 	player->modeService->Cleanup();
 	delete player->modeService;
 	player->modeService = factory(player);
+	player->OnModeStyleServicesChanged();
 	player->timerService->TimerStop();
 	player->modeService->Init();
 
@@ -292,12 +340,12 @@ bool KZModeManager::SwitchToMode(KZPlayer *player, const char *modeName, bool si
 		player->languageService->PrintChat(true, false, "Switched Mode", player->modeService->GetModeName());
 	}
 
-	utils::SendMultipleConVarValues(player->GetPlayerSlot(), KZ::mode::modeCvarRefs, player->modeService->GetModeConVarValues(), MODECVAR_COUNT);
+	KZ::mode::ReplicateModeCvars(player);
 
 	player->SetVelocity({0, 0, 0});
 	player->jumpstatsService->InvalidateJumpstats("Externally modified");
 
-	player->optionService->SetPreferenceStr("preferredMode", modeName);
+	player->optionService->SetPreference(KZ::pref::preferredMode, modeName);
 	return true;
 }
 
@@ -437,7 +485,7 @@ void KZDatabaseServiceEventListener_Modes::OnDatabaseSetup()
 
 void KZOptionServiceEventListener_Modes::OnPlayerPreferencesLoaded(KZPlayer *player)
 {
-	const char *mode = player->optionService->GetPreferenceStr("preferredMode", KZOptionService::GetOptionStr("defaultMode", KZ_DEFAULT_MODE));
+	const char *mode = player->optionService->GetPreference(KZ::pref::preferredMode, KZOptionService::GetConfig().defaultMode.Get());
 	// Give up changing modes if the player is already in the server for a while.
 	if (player->telemetryService->GetTimeInServer() < 30.0f && !player->timerService->GetTimerRunning())
 	{
@@ -56,6 +56,12 @@ public:
 	virtual void Reset() override;
 	virtual const char *GetModeName() override;
 	virtual const char *GetModeShortName() override;
+
+	virtual u64 GetSubscribedHooks() override
+	{
+		return movement::GetOverriddenHooks<KZVanillaModeService, KZModeService>();
+	}
+
 	virtual DistanceTier GetDistanceTier(JumpType jumpType, f32 distance) override;
 	virtual const CVValue_t *GetModeConVarValues() override;
 
@@ -1,42 +1,214 @@
+#include <atomic>
+
 #include "kz_option.h"
 #include "kz/db/kz_db.h"
 #include "utils/eventlisteners.h"
-static_global KeyValues *pServerCfgKeyValues;
+#include "utils/ctimer.h"
+
+// Snapshots replaced by a reload are never freed, a reader might still be using one.
+static_global CUtlVector<KZServerConfig *> retiredConfigs;
+static_global KZServerConfig defaultConfig;
+static_global std::atomic<KZServerConfig *> currentConfig = &defaultConfig;
 
 IMPLEMENT_CLASS_EVENT_LISTENER(KZOptionService, KZOptionServiceEventListener);
 
-void KZOptionService::LoadDefaultOptions()
+static_function void ReadConfigOption(KeyValues *kv, const char *name, CUtlString &out)
+{
+	out = kv->GetString(name, out.Get());
+}
+
+static_function void ReadConfigOption(KeyValues *kv, const char *name, f64 &out)
+{
+	out = kv->GetFloat(name, out);
+}
+
+static_function void ReadConfigOption(KeyValues *kv, const char *name, i64 &out)
+{
+	out = kv->GetInt(name, out);
+}
+
+static_function void ReadConfigOption(KeyValues *kv, const char *name, bool &out)
+{
+	const char *value = kv->GetString(name, nullptr);
+	if (value && value[0])
+	{
+		out = KZ_STREQI(value, "true") || atoi(value) != 0;
+	}
+}
+
+bool KZOptionService::LoadDefaultOptions()
 {
 	char serverCfgPath[1024];
 	V_snprintf(serverCfgPath, sizeof(serverCfgPath), "%s%s", g_SMAPI->GetBaseDir(), "/cfg/cs2kz-server-config.txt");
 
-	pServerCfgKeyValues = new KeyValues("ServerConfig");
-	pServerCfgKeyValues->LoadFromFile(g_pFullFileSystem, serverCfgPath, nullptr);
+	KZServerConfig *config = new KZServerConfig();
+	config->keyValues = new KeyValues("ServerConfig");
+	if (!config->keyValues->LoadFromFile(g_pFullFileSystem, serverCfgPath, nullptr))
+	{
+		META_CONPRINTF("[KZ::Options] Failed to load %s.\n", serverCfgPath);
+		// Keep the current options if there are any.
+		if (currentConfig.load() != &defaultConfig)
+		{
+			config->keyValues->deleteThis();
+			delete config;
+			return false;
+		}
+	}
+
+#define READ_CONFIG_OPTION(type, name, defaultValue) ReadConfigOption(config->keyValues, #name, config->name);
+	KZ_SERVER_CONFIG(READ_CONFIG_OPTION)
+#undef READ_CONFIG_OPTION
+
+	KZServerConfig *oldConfig = currentConfig.exchange(config, std::memory_order_acq_rel);
+	if (oldConfig != &defaultConfig)
+	{
+		retiredConfigs.AddToTail(oldConfig);
+	}
+	return true;
+}
+
+const KZServerConfig &KZOptionService::GetConfig()
+{
+	return *currentConfig.load(std::memory_order_acquire);
 }
 
 const char *KZOptionService::GetOptionStr(const char *optionName, const char *defaultValue)
 {
-	return pServerCfgKeyValues->GetString(optionName, defaultValue);
+	KeyValues *kv = GetConfig().keyValues;
+	return kv ? kv->GetString(optionName, defaultValue) : defaultValue;
 }
 
 f64 KZOptionService::GetOptionFloat(const char *optionName, f64 defaultValue)
 {
-	return pServerCfgKeyValues->GetFloat(optionName, defaultValue);
+	KeyValues *kv = GetConfig().keyValues;
+	return kv ? kv->GetFloat(optionName, defaultValue) : defaultValue;
 }
 
 i64 KZOptionService::GetOptionInt(const char *optionName, i64 defaultValue)
 {
-	return pServerCfgKeyValues->GetInt(optionName, defaultValue);
+	KeyValues *kv = GetConfig().keyValues;
+	return kv ? kv->GetInt(optionName, defaultValue) : defaultValue;
 }
 
 KeyValues *KZOptionService::GetOptionKV(const char *optionName)
 {
-	return pServerCfgKeyValues->FindKey(optionName);
+	KeyValues *kv = GetConfig().keyValues;
+	return kv ? kv->FindKey(optionName) : nullptr;
+}
+
+CON_COMMAND_F(kz_reload_config, "Reload cfg/cs2kz-server-config.txt", FCVAR_NONE)
+{
+	// Options that are only read on startup, such as pool sizes or the database connection, still need a restart.
+	if (KZOptionService::LoadDefaultOptions())
+	{
+		META_CONPRINTF("[KZ::Options] Server config reloaded.\n");
+	}
+}
+
+static_function f64 FlushPrefsTimer()
+{
+	KZOptionService::FlushPrefs();
+	return KZ_PREFERENCE_FLUSH_INTERVAL;
 }
 
 void KZOptionService::InitOptions()
 {
 	LoadDefaultOptions();
+	StartTimer(FlushPrefsTimer, KZ_PREFERENCE_FLUSH_INTERVAL, true, true);
+}
+
+void KZOptionService::FlushPrefs(bool force)
+{
+	f64 now = g_pKZUtils->GetServerGlobals()->realtime;
+	for (i32 i = 0; i <= MAXPLAYERS; i++)
+	{
+		KZPlayer *player = g_pKZPlayerManager->ToPlayer(i);
+		if (!player || !player->optionService || !player->optionService->prefsDirty)
+		{
+			continue;
+		}
+		// Wait for the player to stop changing options so a burst of changes results in one write.
+		if (force || now - player->optionService->lastPrefChangeTime >= KZ_PREFERENCE_SAVE_DELAY)
+		{
+			player->optionService->SaveLocalPrefs();
+		}
+	}
+	KZDatabaseService::FlushPrefs();
+}
+
+static_function void ReadPreference(KeyValues3 *kv, bool &out)
+{
+	out = kv->GetBool();
+}
+
+static_function void ReadPreference(KeyValues3 *kv, i64 &out)
+{
+	out = kv->GetInt64();
+}
+
+static_function void ReadPreference(KeyValues3 *kv, f64 &out)
+{
+	out = kv->GetDouble();
+}
+
+static_function void ReadPreference(KeyValues3 *kv, Vector &out)
+{
+	out = kv->GetVector();
+}
+
+static_function void ReadPreference(KeyValues3 *kv, CUtlString &out)
+{
+	out = kv->GetString();
+}
+
+static_function void WritePreference(KeyValues3 *kv, bool value)
+{
+	kv->SetBool(value);
+}
+
+static_function void WritePreference(KeyValues3 *kv, i64 value)
+{
+	kv->SetInt64(value);
+}
+
+static_function void WritePreference(KeyValues3 *kv, f64 value)
+{
+	kv->SetDouble(value);
+}
+
+static_function void WritePreference(KeyValues3 *kv, const Vector &value)
+{
+	kv->SetVector(value);
+}
+
+static_function void WritePreference(KeyValues3 *kv, const CUtlString &value)
+{
+	kv->SetString(value.Get());
+}
+
+void KZOptionService::LoadPreferencesFromKV()
+{
+	this->preferences = KZPreferences();
+	KeyValues3 *member;
+#define LOAD_PREFERENCE(type, name) \
+	if ((member = this->prefKV.FindMember(#name))) \
+	{ \
+		ReadPreference(member, this->preferences.name.value); \
+		this->preferences.name.isSet = true; \
+	}
+	KZ_PREFERENCES(LOAD_PREFERENCE)
+#undef LOAD_PREFERENCE
+}
+
+void KZOptionService::WritePreferencesToKV()
+{
+#define WRITE_PREFERENCE(type, name) \
+	if (this->preferences.name.isSet) \
+	{ \
+		WritePreference(this->prefKV.FindOrCreateMember(#name), this->preferences.name.value); \
+	}
+	KZ_PREFERENCES(WRITE_PREFERENCE)
+#undef WRITE_PREFERENCE
 }
 
 void KZOptionService::InitializeLocalPrefs(CUtlString text)
@@ -56,7 +228,9 @@ void KZOptionService::InitializeLocalPrefs(CUtlString text)
 		META_CONPRINTF("[KZ::DB] Error fetching local preference: %s\n", error.Get());
 		return;
 	}
+	this->LoadPreferencesFromKV();
 	this->initState = LOCAL;
+	this->savedLocalPrefs = text;
 	// Calling this before the player is ingame will create unwanted race conditions.
 	// We need to make sure the player is both authenticated and ingame.
 	if (this->player->IsInGame())
@@ -78,6 +252,7 @@ void KZOptionService::InitializeGlobalPrefs(std::string json)
 		return;
 	}
 
+	this->LoadPreferencesFromKV();
 	this->initState = GLOBAL;
 
 	META_CONPRINTF("[KZ::Options] Loaded global preferences.\n");
@@ -92,17 +267,25 @@ void KZOptionService::InitializeGlobalPrefs(std::string json)
 
 void KZOptionService::SaveLocalPrefs()
 {
-	if (this->player->IsFakeClient())
+	if (!this->prefsDirty || this->player->IsFakeClient())
 	{
 		return;
 	}
+	this->prefsDirty = false;
 	CUtlString error, output;
+	this->WritePreferencesToKV();
 	SaveKV3AsJSON(&this->prefKV, &error, &output);
 	if (!error.IsEmpty())
 	{
 		META_CONPRINTF("[KZ::DB] Error saving local preference: %s\n", error.Get());
 		return;
 	}
+	// Options toggled back and forth end up where they started.
+	if (output == this->savedLocalPrefs)
+	{
+		return;
+	}
+	this->savedLocalPrefs = output;
 	this->player->databaseService->SavePrefs(output);
 }
 
@@ -7,6 +7,96 @@
 #include "keyvalues3.h"
 #include "utils/eventlisteners.h"
 
+// Seconds a player's preferences must stay unchanged before they are written.
+#define KZ_PREFERENCE_SAVE_DELAY     5.0
+// Seconds between two batched preference writes.
+#define KZ_PREFERENCE_FLUSH_INTERVAL 1.0
+
+// Every option of cfg/cs2kz-server-config.txt read by the plugin, with its type and the value used when it's missing.
+// clang-format off
+#define KZ_SERVER_CONFIG(X) \
+	X(CUtlString, defaultMode, KZ_DEFAULT_MODE) \
+	X(CUtlString, defaultStyles, "") \
+	X(f64, defaultTimeLimit, 60.0) \
+	X(CUtlString, defaultLanguage, KZ_DEFAULT_LANGUAGE) \
+	X(f64, tipInterval, KZ_DEFAULT_TIP_INTERVAL) \
+	X(i64, defaultJSBroadcastMinTier, 4 /* DistanceTier_Godlike */) \
+	X(i64, defaultJSSoundMinTier, 4 /* DistanceTier_Godlike */) \
+	X(bool, defaultShowJS, true) \
+	X(i64, jumpHistoryDepth, 4) \
+	X(i64, jumpstatTopCount, 20) \
+	X(CUtlString, jumpExportFormat, "") \
+	X(i64, jumpExportMaxFileSize, 64) \
+	X(bool, strafeAnalysis, true) \
+	X(i64, savelocPoolSize, 4096) \
+	X(i64, savelocMaxPerPlayer, 64) \
+	X(bool, savelocPersist, false) \
+	X(bool, autoDemoRecording, false) \
+	X(CUtlString, chatPrefix, KZ_DEFAULT_CHAT_PREFIX) \
+	X(bool, overridePlayerChat, true) \
+	X(i64, tickBudget, 4000) \
+	X(f64, telemetrySnapshotInterval, 15.0) \
+	X(CUtlString, apiUrl, "https://api.cs2kz.org") \
+	X(CUtlString, apiKey, "") \
+	X(i64, mainThreadCallbackBudget, 2000)
+// clang-format on
+
+// Parsed once per (re)load and never modified afterwards, see KZOptionService::GetConfig.
+struct KZServerConfig
+{
+#define DECLARE_CONFIG_OPTION(type, name, defaultValue) type name = defaultValue;
+	KZ_SERVER_CONFIG(DECLARE_CONFIG_OPTION)
+#undef DECLARE_CONFIG_OPTION
+
+	// The whole file, for sections such as "db" and options that aren't listed above.
+	KeyValues *keyValues {};
+};
+
+// Every preference stored per player, except tables. Adding one here gives it a typed slot and a KZ::pref key.
+// clang-format off
+#define KZ_PREFERENCES(X) \
+	X(bool, showPanel) \
+	X(bool, hideLegs) \
+	X(bool, hideOtherPlayers) \
+	X(bool, hideWeapon) \
+	X(i64, desiredBeamType) \
+	X(Vector, beamOffset) \
+	X(i64, preferredCompareType) \
+	X(CUtlString, preferredMode) \
+	X(CUtlString, preferredStyles) \
+	X(CUtlString, preferredLanguage)
+// clang-format on
+
+template<typename T>
+struct KZPreference
+{
+	T value {};
+	// Unset preferences fall back to the default given by the reader.
+	bool isSet {};
+};
+
+struct KZPreferences
+{
+#define DECLARE_PREFERENCE(type, name) KZPreference<type> name;
+	KZ_PREFERENCES(DECLARE_PREFERENCE)
+#undef DECLARE_PREFERENCE
+};
+
+template<typename T>
+struct KZPreferenceKey
+{
+	using Type = T;
+	const char *name;
+	KZPreference<T> KZPreferences::*slot;
+};
+
+namespace KZ::pref
+{
+#define DECLARE_PREFERENCE_KEY(type, name) inline constexpr KZPreferenceKey<type> name {#name, &KZPreferences::name};
+	KZ_PREFERENCES(DECLARE_PREFERENCE_KEY)
+#undef DECLARE_PREFERENCE_KEY
+} // namespace KZ::pref
+
 class KZOptionServiceEventListener
 {
 public:
@@ -22,13 +112,15 @@ class KZOptionService : public KZBaseService
 
 public:
 	static void InitOptions();
+	// Current server config snapshot. kz_reload_config swaps in a new one, so don't keep the reference across frames.
+	static const KZServerConfig &GetConfig();
+	// Lookups by name for options not in KZ_SERVER_CONFIG.
 	static const char *GetOptionStr(const char *optionName, const char *defaultValue = "");
 	static f64 GetOptionFloat(const char *optionName, f64 defaultValue = 0.0);
 	static i64 GetOptionInt(const char *optionName, i64 defaultValue = 0);
 	static KeyValues *GetOptionKV(const char *optionName);
-
-private:
-	static void LoadDefaultOptions();
+	// Parse the config file into a new snapshot and make it current. Returns false and keeps the current one on failure.
+	static bool LoadDefaultOptions();
 
 private:
 	enum
@@ -38,15 +130,37 @@ private:
 		GLOBAL
 	} initState;
 
+	// Holds everything loaded from JSON. Known preferences are read from and written back to their typed slots.
 	KeyValues3 prefKV = KeyValues3(KV3_TYPEEX_TABLE, KV3_SUBTYPE_UNSPECIFIED);
+	KZPreferences preferences;
+
+	void LoadPreferencesFromKV();
+	void WritePreferencesToKV();
+
+	bool prefsDirty {};
+	f64 lastPrefChangeTime {};
+	// Local preferences as last read from or queued to the database, writes that would not change them are skipped.
+	CUtlString savedLocalPrefs;
+
+	void MarkPrefsDirty()
+	{
+		prefsDirty = true;
+		lastPrefChangeTime = g_pKZUtils->GetServerGlobals()->realtime;
+	}
 
 public:
 	void Reset()
 	{
 		initState = NONE;
 		prefKV.SetToEmptyTable();
+		preferences = KZPreferences();
+		prefsDirty = false;
+		savedLocalPrefs.Clear();
 	}
 
+	// Queue preferences that changed for long enough (or at all if force is set) and write them in one transaction.
+	static void FlushPrefs(bool force = false);
+
 	void InitializeLocalPrefs(CUtlString text);
 	void InitializeGlobalPrefs(std::string json);
 
@@ -55,6 +169,7 @@ public:
 		return initState > NONE;
 	}
 
+	// Queue the preferences for writing if they changed since the last write.
 	void SaveLocalPrefs();
 
 	void SaveGlobalPrefs() {}
@@ -69,135 +184,38 @@ public:
 
 	void GetPreferencesAsJSON(CUtlString *error, CUtlString *output)
 	{
+		this->WritePreferencesToKV();
 		SaveKV3AsJSON(&this->prefKV, error, output);
 	}
 
-	// Due to the way keyvalues3.h is written, we can't template these functions.
-	void SetPreferenceBool(const char *optionName, bool value)
+	template<typename T>
+	T GetPreference(const KZPreferenceKey<T> &key, const typename KZPreferenceKey<T>::Type &defaultValue = {})
 	{
-		if (!IsInitialized())
-		{
-			return;
-		}
-		prefKV.FindOrCreateMember(optionName)->SetBool(value);
-		CALL_FORWARD(eventListeners, OnPlayerPreferenceChanged, this->player, optionName);
+		const KZPreference<T> &preference = this->preferences.*key.slot;
+		return IsInitialized() && preference.isSet ? preference.value : defaultValue;
 	}
 
-	bool GetPreferenceBool(const char *optionName, bool defaultValue = false)
+	const char *GetPreference(const KZPreferenceKey<CUtlString> &key, const char *defaultValue = "")
 	{
-		if (!IsInitialized())
-		{
-			return defaultValue;
-		}
-		bool created = false;
-		KeyValues3 *option = prefKV.FindOrCreateMember(optionName, &created);
-		if (created)
-		{
-			option->SetBool(defaultValue);
-		}
-		return option->GetBool(defaultValue);
+		const KZPreference<CUtlString> &preference = this->preferences.*key.slot;
+		return IsInitialized() && preference.isSet ? preference.value.Get() : defaultValue;
 	}
 
-	void SetPreferenceFloat(const char *optionName, f64 value)
+	template<typename T>
+	void SetPreference(const KZPreferenceKey<T> &key, const typename KZPreferenceKey<T>::Type &value)
 	{
 		if (!IsInitialized())
 		{
 			return;
 		}
-		prefKV.FindOrCreateMember(optionName)->SetDouble(value);
-		CALL_FORWARD(eventListeners, OnPlayerPreferenceChanged, this->player, optionName);
-	}
-
-	f64 GetPreferenceFloat(const char *optionName, f64 defaultValue = 0.0)
-	{
-		if (!IsInitialized())
-		{
-			return defaultValue;
-		}
-		bool created = false;
-		KeyValues3 *option = prefKV.FindOrCreateMember(optionName, &created);
-		if (created)
-		{
-			option->SetDouble(defaultValue);
-		}
-		return option->GetDouble(defaultValue);
-	}
-
-	void SetPreferenceInt(const char *optionName, i64 value)
-	{
-		if (!IsInitialized())
-		{
-			return;
-		}
-		prefKV.FindOrCreateMember(optionName)->SetInt64(value);
-		CALL_FORWARD(eventListeners, OnPlayerPreferenceChanged, this->player, optionName);
-	}
-
-	i64 GetPreferenceInt(const char *optionName, i64 defaultValue = 0)
-	{
-		if (!IsInitialized())
-		{
-			return defaultValue;
-		}
-		bool created = false;
-		KeyValues3 *option = prefKV.FindOrCreateMember(optionName, &created);
-		if (created)
-		{
-			option->SetInt64(defaultValue);
-		}
-		return option->GetInt64(defaultValue);
-	}
-
-	void SetPreferenceStr(const char *optionName, const char *value)
-	{
-		if (!IsInitialized())
-		{
-			return;
-		}
-		prefKV.FindOrCreateMember(optionName)->SetString(value);
-		CALL_FORWARD(eventListeners, OnPlayerPreferenceChanged, this->player, optionName);
-	}
-
-	const char *GetPreferenceStr(const char *optionName, const char *defaultValue = "")
-	{
-		if (!IsInitialized())
-		{
-			return defaultValue;
-		}
-		bool created = false;
-		KeyValues3 *option = prefKV.FindOrCreateMember(optionName, &created);
-		if (created)
-		{
-			option->SetString(defaultValue);
-		}
-		return option->GetString(defaultValue);
-	}
-
-	void SetPreferenceVector(const char *optionName, const Vector &value)
-	{
-		if (!IsInitialized())
-		{
-			return;
-		}
-		prefKV.FindOrCreateMember(optionName)->SetVector(value);
-		CALL_FORWARD(eventListeners, OnPlayerPreferenceChanged, this->player, optionName);
-	}
-
-	Vector GetPreferenceVector(const char *optionName, const Vector &defaultValue = Vector(0.0f, 0.0f, 0.0f))
-	{
-		if (!IsInitialized())
-		{
-			return defaultValue;
-		}
-		bool created = false;
-		KeyValues3 *option = prefKV.FindOrCreateMember(optionName, &created);
-		if (created)
-		{
-			option->SetVector(defaultValue);
-		}
-		return option->GetVector(defaultValue);
+		KZPreference<T> &preference = this->preferences.*key.slot;
+		preference.value = value;
+		preference.isSet = true;
+		this->MarkPrefsDirty();
+		CALL_FORWARD(eventListeners, OnPlayerPreferenceChanged, this->player, key.name);
 	}
 
+	// Tables have no typed slot and live in the KeyValues3 tree.
 	void SetPreferenceTable(const char *optionName, const KeyValues3 &value)
 	{
 		if (!IsInitialized())
@@ -207,6 +225,7 @@ public:
 		KeyValues3 *option = prefKV.FindOrCreateMember(optionName);
 		option->SetToEmptyTable();
 		*option = value;
+		this->MarkPrefsDirty();
 		CALL_FORWARD(eventListeners, OnPlayerPreferenceChanged, this->player, optionName);
 	}
 
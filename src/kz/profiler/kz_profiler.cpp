@@ -0,0 +1,372 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <thread>
+
+#include "kz_profiler.h"
+#include "kz/kz.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace KZ::profiler;
+
+// Ticks per rolling window written to the profile files, roughly 10 seconds at 64 tick.
+#define PROFILE_WINDOW_TICKS 640
+// The CSV file is rotated once it grows past this size.
+#define PROFILE_CSV_MAX_SIZE (4 * 1024 * 1024)
+// 4 sub-buckets per power of two, enough for ~20% precision on the percentiles.
+#define PROFILE_HISTOGRAM_BUCKETS 256
+
+static_global const char *sectionNames[PROFILE_COUNT] = {"trigger", "jumpstats", "timer", "mode", "styles", "hud", "quiet", "beam", "telemetry"};
+
+struct Histogram
+{
+	std::atomic<u32> buckets[PROFILE_HISTOGRAM_BUCKETS];
+	std::atomic<u64> count;
+	std::atomic<u64> sum;
+	std::atomic<u64> max;
+
+	void Record(u64 cycles)
+	{
+		this->buckets[GetBucket(cycles)].fetch_add(1, std::memory_order_relaxed);
+		this->count.fetch_add(1, std::memory_order_relaxed);
+		this->sum.fetch_add(cycles, std::memory_order_relaxed);
+		u64 currentMax = this->max.load(std::memory_order_relaxed);
+		while (cycles > currentMax && !this->max.compare_exchange_weak(currentMax, cycles, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	void Reset()
+	{
+		for (u32 i = 0; i < PROFILE_HISTOGRAM_BUCKETS; i++)
+		{
+			this->buckets[i].store(0, std::memory_order_relaxed);
+		}
+		this->count.store(0, std::memory_order_relaxed);
+		this->sum.store(0, std::memory_order_relaxed);
+		this->max.store(0, std::memory_order_relaxed);
+	}
+
+	// Approximate value at the given percentile (0-1), in cycles.
+	u64 GetPercentile(f64 percentile) const
+	{
+		u64 total = this->count.load(std::memory_order_relaxed);
+		if (total == 0)
+		{
+			return 0;
+		}
+		u64 target = (u64)(percentile * (f64)(total - 1)) + 1;
+		u64 seen = 0;
+		for (u32 i = 0; i < PROFILE_HISTOGRAM_BUCKETS; i++)
+		{
+			seen += this->buckets[i].load(std::memory_order_relaxed);
+			if (seen >= target)
+			{
+				return MIN(GetBucketMidpoint(i), this->max.load(std::memory_order_relaxed));
+			}
+		}
+		return this->max.load(std::memory_order_relaxed);
+	}
+
+	static u32 GetMostSignificantBit(u64 value)
+	{
+#ifdef _WIN32
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return index;
+#else
+		return 63 - __builtin_clzll(value);
+#endif
+	}
+
+	static u32 GetBucket(u64 value)
+	{
+		if (value < 4)
+		{
+			return (u32)value;
+		}
+		u32 msb = GetMostSignificantBit(value);
+		u32 sub = (value >> (msb - 2)) & 3;
+		return 4 + (msb - 2) * 4 + sub;
+	}
+
+	static u64 GetBucketMidpoint(u32 bucket)
+	{
+		if (bucket < 4)
+		{
+			return bucket;
+		}
+		u32 msb = (bucket - 4) / 4 + 2;
+		u64 sub = (bucket - 4) % 4;
+		u64 width = 1ull << (msb - 2);
+		return ((4 + sub) << (msb - 2)) + width / 2;
+	}
+};
+
+static_global struct
+{
+	Histogram total[PROFILE_COUNT];
+	Histogram window[PROFILE_COUNT];
+	u32 windowTicks;
+	// Used to convert cycles to microseconds.
+	u64 calibrationTimestamp;
+	std::chrono::steady_clock::time_point calibrationTime;
+	bool tickPending;
+} profilerData;
+
+static_function f64 GetCyclesPerMicrosecond()
+{
+	u64 cycles = ReadTimestamp() - profilerData.calibrationTimestamp;
+	f64 elapsed = std::chrono::duration<f64, std::micro>(std::chrono::steady_clock::now() - profilerData.calibrationTime).count();
+	if (elapsed <= 0.0 || cycles == 0)
+	{
+		return 1.0;
+	}
+	return (f64)cycles / elapsed;
+}
+
+static_function void ResetProfiler()
+{
+	for (u32 i = 0; i < PROFILE_COUNT; i++)
+	{
+		profilerData.total[i].Reset();
+		profilerData.window[i].Reset();
+		tickCycles[i] = 0;
+	}
+	profilerData.windowTicks = 0;
+	profilerData.tickPending = false;
+	profilerData.calibrationTimestamp = ReadTimestamp();
+	profilerData.calibrationTime = std::chrono::steady_clock::now();
+}
+
+struct SectionStats
+{
+	u64 ticks;
+	f64 p50;
+	f64 p99;
+	f64 max;
+	f64 mean;
+};
+
+static_function SectionStats GetSectionStats(const Histogram &histogram, f64 cyclesPerMicrosecond)
+{
+	SectionStats stats;
+	stats.ticks = histogram.count.load(std::memory_order_relaxed);
+	stats.p50 = histogram.GetPercentile(0.5) / cyclesPerMicrosecond;
+	stats.p99 = histogram.GetPercentile(0.99) / cyclesPerMicrosecond;
+	stats.max = histogram.max.load(std::memory_order_relaxed) / cyclesPerMicrosecond;
+	stats.mean = stats.ticks ? histogram.sum.load(std::memory_order_relaxed) / cyclesPerMicrosecond / stats.ticks : 0.0;
+	return stats;
+}
+
+struct ProfileSnapshot
+{
+	i64 time;
+	SectionStats sections[PROFILE_COUNT];
+};
+
+// Profile files are written on a separate thread so file IO never stalls a tick.
+static_global struct
+{
+	std::thread thread;
+	std::atomic<bool> writing;
+} profileWriter;
+
+static_function void WriteProfileFiles(ProfileSnapshot snapshot)
+{
+	i64 now = snapshot.time;
+
+	char csvPath[1024];
+	char oldCsvPath[1024];
+	char jsonPath[1024];
+	g_SMAPI->PathFormat(csvPath, sizeof(csvPath), "%s/addons/cs2kz/data/profile.csv", g_SMAPI->GetBaseDir());
+	g_SMAPI->PathFormat(oldCsvPath, sizeof(oldCsvPath), "%s/addons/cs2kz/data/profile.csv.1", g_SMAPI->GetBaseDir());
+	g_SMAPI->PathFormat(jsonPath, sizeof(jsonPath), "%s/addons/cs2kz/data/profile.json", g_SMAPI->GetBaseDir());
+
+	FILE *csv = fopen(csvPath, "a");
+	if (csv)
+	{
+		fseek(csv, 0, SEEK_END);
+		long size = ftell(csv);
+		if (size >= PROFILE_CSV_MAX_SIZE)
+		{
+			fclose(csv);
+			remove(oldCsvPath);
+			rename(csvPath, oldCsvPath);
+			csv = fopen(csvPath, "a");
+		}
+	}
+	if (csv)
+	{
+		if (ftell(csv) == 0)
+		{
+			fprintf(csv, "time,section,ticks,p50_us,p99_us,max_us,mean_us\n");
+		}
+		for (u32 i = 0; i < PROFILE_COUNT; i++)
+		{
+			const SectionStats &stats = snapshot.sections[i];
+			fprintf(csv, "%lld,%s,%llu,%.3f,%.3f,%.3f,%.3f\n", now, sectionNames[i], stats.ticks, stats.p50, stats.p99, stats.max, stats.mean);
+		}
+		fclose(csv);
+	}
+
+	FILE *json = fopen(jsonPath, "w");
+	if (json)
+	{
+		fprintf(json, "{\"time\":%lld,\"sections\":{", now);
+		for (u32 i = 0; i < PROFILE_COUNT; i++)
+		{
+			const SectionStats &stats = snapshot.sections[i];
+			fprintf(json, "%s\"%s\":{\"ticks\":%llu,\"p50_us\":%.3f,\"p99_us\":%.3f,\"max_us\":%.3f,\"mean_us\":%.3f}", i ? "," : "", sectionNames[i],
+					stats.ticks, stats.p50, stats.p99, stats.max, stats.mean);
+		}
+		fprintf(json, "}}\n");
+		fclose(json);
+	}
+	profileWriter.writing.store(false, std::memory_order_release);
+}
+
+// Returns false if the previous files are still being written.
+static_function bool QueueProfileFiles(Histogram (&histograms)[PROFILE_COUNT])
+{
+	if (profileWriter.writing.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+	if (profileWriter.thread.joinable())
+	{
+		profileWriter.thread.join();
+	}
+
+	ProfileSnapshot snapshot;
+	snapshot.time = (i64)time(nullptr);
+	f64 cyclesPerMicrosecond = GetCyclesPerMicrosecond();
+	for (u32 i = 0; i < PROFILE_COUNT; i++)
+	{
+		snapshot.sections[i] = GetSectionStats(histograms[i], cyclesPerMicrosecond);
+	}
+	profileWriter.writing.store(true, std::memory_order_release);
+	profileWriter.thread = std::thread(WriteProfileFiles, snapshot);
+	return true;
+}
+
+void KZ::profiler::OnGameFrame()
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	// The first frame after enabling has no complete tick to flush.
+	if (profilerData.tickPending)
+	{
+		for (u32 i = 0; i < PROFILE_COUNT; i++)
+		{
+			profilerData.total[i].Record(tickCycles[i]);
+			profilerData.window[i].Record(tickCycles[i]);
+			tickCycles[i] = 0;
+		}
+
+		if (++profilerData.windowTicks >= PROFILE_WINDOW_TICKS)
+		{
+			// Skip this window rather than wait if the previous one is still being written.
+			QueueProfileFiles(profilerData.window);
+			for (u32 i = 0; i < PROFILE_COUNT; i++)
+			{
+				profilerData.window[i].Reset();
+			}
+			profilerData.windowTicks = 0;
+		}
+	}
+	profilerData.tickPending = true;
+}
+
+void KZ::profiler::Cleanup()
+{
+	if (profileWriter.thread.joinable())
+	{
+		profileWriter.thread.join();
+	}
+}
+
+void KZ::profiler::AppendMetrics(std::string &out)
+{
+	if (profilerData.total[0].count.load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	f64 cyclesPerMicrosecond = GetCyclesPerMicrosecond();
+	char line[256];
+	out += "# HELP kz_service_tick_time_microseconds Time spent in each service per server tick, while kz_profile is running.\n";
+	out += "# TYPE kz_service_tick_time_microseconds summary\n";
+	for (u32 i = 0; i < PROFILE_COUNT; i++)
+	{
+		SectionStats stats = GetSectionStats(profilerData.total[i], cyclesPerMicrosecond);
+		V_snprintf(line, sizeof(line),
+				   "kz_service_tick_time_microseconds{service=\"%s\",quantile=\"0.5\"} %.3f\n"
+				   "kz_service_tick_time_microseconds{service=\"%s\",quantile=\"0.99\"} %.3f\n"
+				   "kz_service_tick_time_microseconds_sum{service=\"%s\"} %.3f\n"
+				   "kz_service_tick_time_microseconds_count{service=\"%s\"} %llu\n",
+				   sectionNames[i], stats.p50, sectionNames[i], stats.p99, sectionNames[i], stats.mean * stats.ticks, sectionNames[i], stats.ticks);
+		out += line;
+	}
+}
+
+static_function void PrintProfileReport()
+{
+	f64 cyclesPerMicrosecond = GetCyclesPerMicrosecond();
+	META_CONPRINTF("[KZ::Profiler] %s, %.0f cycles/us\n", enabled ? "Enabled" : "Disabled", cyclesPerMicrosecond);
+	META_CONPRINTF("%-10s %10s %10s %10s %10s %10s\n", "section", "ticks", "p50 (us)", "p99 (us)", "max (us)", "mean (us)");
+	for (u32 i = 0; i < PROFILE_COUNT; i++)
+	{
+		SectionStats stats = GetSectionStats(profilerData.total[i], cyclesPerMicrosecond);
+		META_CONPRINTF("%-10s %10llu %10.2f %10.2f %10.2f %10.2f\n", sectionNames[i], stats.ticks, stats.p50, stats.p99, stats.max, stats.mean);
+	}
+}
+
+CON_COMMAND_F(kz_profile, "Per-service tick profiler. Usage: kz_profile [start|stop|reset|dump]", FCVAR_NONE)
+{
+	if (args.ArgC() < 2)
+	{
+		PrintProfileReport();
+		return;
+	}
+
+	if (KZ_STREQI(args[1], "start"))
+	{
+		if (!enabled)
+		{
+			ResetProfiler();
+			enabled = true;
+		}
+		META_CONPRINTF("[KZ::Profiler] Profiling started.\n");
+	}
+	else if (KZ_STREQI(args[1], "stop"))
+	{
+		enabled = false;
+		META_CONPRINTF("[KZ::Profiler] Profiling stopped.\n");
+	}
+	else if (KZ_STREQI(args[1], "reset"))
+	{
+		ResetProfiler();
+		META_CONPRINTF("[KZ::Profiler] Profiling data reset.\n");
+	}
+	else if (KZ_STREQI(args[1], "dump"))
+	{
+		if (QueueProfileFiles(profilerData.total))
+		{
+			META_CONPRINTF("[KZ::Profiler] Writing profile.csv and profile.json to addons/cs2kz/data.\n");
+		}
+		else
+		{
+			META_CONPRINTF("[KZ::Profiler] Profile files are still being written, try again later.\n");
+		}
+	}
+	else
+	{
+		META_CONPRINTF("Usage: kz_profile [start|stop|reset|dump]\n");
+	}
+}
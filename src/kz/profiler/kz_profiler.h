@@ -0,0 +1,87 @@
+#pragma once
+#include <string>
+
+#include "common.h"
+
+#ifdef _WIN32
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define KZ_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define KZ_UNLIKELY(x) (x)
+#endif
+
+/*
+	Lightweight per-service tick profiler.
+
+	Every profiled section accumulates rdtsc cycles over a server tick, and the per-tick totals are recorded into
+	log-linear histograms at the start of the next GameFrame. `kz_profile` controls it and prints p50/p99/max per section.
+	While disabled, a scope costs a single test of KZ::profiler::enabled, captured when the scope is entered.
+*/
+
+namespace KZ::profiler
+{
+	enum Section : u8
+	{
+		PROFILE_TRIGGER = 0,
+		PROFILE_JUMPSTATS,
+		PROFILE_TIMER,
+		PROFILE_MODE,
+		PROFILE_STYLES,
+		PROFILE_HUD,
+		PROFILE_QUIET,
+		PROFILE_BEAM,
+		PROFILE_TELEMETRY,
+		PROFILE_COUNT
+	};
+
+	inline bool enabled = false;
+	// Cycles spent in each section during the current tick. Profiled code only ever runs on the main thread.
+	inline u64 tickCycles[PROFILE_COUNT] {};
+
+	inline u64 ReadTimestamp()
+	{
+		return __rdtsc();
+	}
+
+	// Both ends test the same flag, captured on construction. The compiler knows it can't change in between and can merge the tests.
+	class Scope
+	{
+	public:
+		Scope(Section section) : section(section), active(enabled)
+		{
+			if (KZ_UNLIKELY(this->active))
+			{
+				this->start = ReadTimestamp();
+			}
+		}
+
+		~Scope()
+		{
+			if (KZ_UNLIKELY(this->active))
+			{
+				tickCycles[this->section] += ReadTimestamp() - this->start;
+			}
+		}
+
+	private:
+		Section section;
+		bool active;
+		u64 start;
+	};
+
+	// Flush the previous tick's totals into the histograms. Called at the start of every GameFrame.
+	void OnGameFrame();
+	// Waits for profile files in progress to be written, called on unload.
+	void Cleanup();
+	// Append the per-section tick time quantiles in the Prometheus text format. Appends nothing if the profiler hasn't recorded anything.
+	void AppendMetrics(std::string &out);
+} // namespace KZ::profiler
+
+#define KZ_PROFILE_CONCAT_(a, b) a##b
+#define KZ_PROFILE_CONCAT(a, b)  KZ_PROFILE_CONCAT_(a, b)
+#define KZ_PROFILE(section)      KZ::profiler::Scope KZ_PROFILE_CONCAT(kzProfileScope, __LINE__)(KZ::profiler::section)
@@ -143,7 +143,7 @@ void KZ::quiet::OnPostEvent(INetworkMessageInternal *pEvent, const CNetMessage *
 		case CS_UM_SayText:
 		case UM_SayText:
 		{
-			if (!KZOptionService::GetOptionInt("overridePlayerChat", true))
+			if (!KZOptionService::GetConfig().overridePlayerChat)
 			{
 				return;
 			}
@@ -153,7 +153,7 @@ void KZ::quiet::OnPostEvent(INetworkMessageInternal *pEvent, const CNetMessage *
 		case CS_UM_SayText2:
 		case UM_SayText2:
 		{
-			if (!KZOptionService::GetOptionInt("overridePlayerChat", true))
+			if (!KZOptionService::GetConfig().overridePlayerChat)
 			{
 				return;
 			}
@@ -209,8 +209,8 @@ void KZQuietService::Init()
 
 void KZQuietService::Reset()
 {
-	this->hideOtherPlayers = this->player->optionService->GetPreferenceBool("hideOtherPlayers", false);
-	this->hideWeapon = this->player->optionService->GetPreferenceBool("hideWeapon", false);
+	this->hideOtherPlayers = this->player->optionService->GetPreference(KZ::pref::hideOtherPlayers, false);
+	this->hideWeapon = this->player->optionService->GetPreference(KZ::pref::hideWeapon, false);
 	this->ResetHideWeapon();
 }
 
@@ -256,14 +256,14 @@ bool KZQuietService::ShouldHideIndex(u32 targetIndex)
 void KZQuietService::ToggleHideWeapon()
 {
 	this->hideWeapon = !this->hideWeapon;
-	this->player->optionService->SetPreferenceBool("hideWeapon", this->hideWeapon);
+	this->player->optionService->SetPreference(KZ::pref::hideWeapon, this->hideWeapon);
 }
 
 void KZQuietService::OnPlayerPreferencesLoaded()
 {
-	this->hideWeapon = this->player->optionService->GetPreferenceBool("hideWeapon", false);
+	this->hideWeapon = this->player->optionService->GetPreference(KZ::pref::hideWeapon, false);
 
-	bool newShouldHide = this->player->optionService->GetPreferenceBool("hideOtherPlayers", false);
+	bool newShouldHide = this->player->optionService->GetPreference(KZ::pref::hideOtherPlayers, false);
 	if (!newShouldHide && this->hideOtherPlayers && this->player->IsInGame())
 	{
 		this->SendFullUpdate();
@@ -274,7 +274,7 @@ void KZQuietService::OnPlayerPreferencesLoaded()
 void KZQuietService::ToggleHide()
 {
 	this->hideOtherPlayers = !this->hideOtherPlayers;
-	this->player->optionService->SetPreferenceBool("hideOtherPlayers", this->hideOtherPlayers);
+	this->player->optionService->SetPreference(KZ::pref::hideOtherPlayers, this->hideOtherPlayers);
 	if (!this->hideOtherPlayers)
 	{
 		this->SendFullUpdate();
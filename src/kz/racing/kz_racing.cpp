@@ -1 +1,625 @@
 #include "kz_racing.h"
+#include "../checkpoint/kz_checkpoint.h"
+#include "../language/kz_language.h"
+#include "../noclip/kz_noclip.h"
+#include "../timer/kz_timer.h"
+#include "utils/simplecmds.h"
+
+#include "tier0/memdbgon.h"
+
+// Progress is compared as one number: stages outweigh checkpoints, which outweigh splits.
+#define RACE_PROGRESS_STAGE      (1 << 16)
+#define RACE_PROGRESS_CHECKPOINT (1 << 8)
+#define RACE_PROGRESS_SPLIT      1
+
+static_assert(KZ_MAX_SPLIT_ZONES < 256 && KZ_MAX_CHECKPOINT_ZONES < 256, "Race progress fields overflow");
+
+enum RaceState
+{
+	RACE_LOBBY,
+	RACE_COUNTDOWN,
+	RACE_RUNNING
+};
+
+struct RaceParticipant
+{
+	// Null once the player left the race.
+	KZPlayer *player;
+	CUtlString name;
+	u32 progress;
+	// Tick on which the current progress was reached, whoever got there first stays ahead.
+	i32 progressTick;
+	f64 finishTime = -1;
+	bool forfeited;
+
+	bool IsDone() const
+	{
+		return this->forfeited || this->finishTime >= 0;
+	}
+
+	bool IsAheadOf(const RaceParticipant &other) const
+	{
+		if (this->forfeited != other.forfeited)
+		{
+			return other.forfeited;
+		}
+		bool finished = this->finishTime >= 0;
+		if (finished != (other.finishTime >= 0))
+		{
+			return finished;
+		}
+		if (finished)
+		{
+			return this->finishTime < other.finishTime;
+		}
+		if (this->progress != other.progress)
+		{
+			return this->progress > other.progress;
+		}
+		return this->progressTick < other.progressTick;
+	}
+};
+
+struct KZRace
+{
+	KZPlayer *host;
+	u32 courseGUID;
+	Vector startOrigin;
+	QAngle startAngles;
+	RaceState state;
+	i32 releaseTick;
+	i32 lastAnnouncedSecond;
+	// Always sorted, first place first.
+	CUtlVector<RaceParticipant> standings;
+
+	i32 Find(KZPlayer *player)
+	{
+		FOR_EACH_VEC(this->standings, i)
+		{
+			if (this->standings[i].player == player)
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	// Move a participant whose result changed to its new place. Only neighbours are compared, so the cost
+	// depends on how many places were gained or lost rather than on the race size.
+	i32 Reposition(i32 index)
+	{
+		while (index > 0 && this->standings[index].IsAheadOf(this->standings[index - 1]))
+		{
+			V_swap(this->standings[index], this->standings[index - 1]);
+			index--;
+		}
+		while (index < this->standings.Count() - 1 && this->standings[index + 1].IsAheadOf(this->standings[index]))
+		{
+			V_swap(this->standings[index], this->standings[index + 1]);
+			index++;
+		}
+		return index;
+	}
+
+	template<typename... Args>
+	void Print(const char *message, Args &&...args)
+	{
+		FOR_EACH_VEC(this->standings, i)
+		{
+			if (this->standings[i].player)
+			{
+				this->standings[i].player->languageService->PrintChat(true, false, message, args...);
+			}
+		}
+	}
+};
+
+static_global CUtlVector<KZRace *> races;
+
+static_global class KZTimerServiceEventListener_Racing : public KZTimerServiceEventListener
+{
+	virtual void OnTimerStartPost(KZPlayer *player, u32 courseGUID) override;
+	virtual void OnSplitZoneReached(KZPlayer *player, u32 courseGUID, i32 splitNumber) override;
+	virtual void OnCheckpointZoneReached(KZPlayer *player, u32 courseGUID, i32 cpNumber) override;
+	virtual void OnStageZoneReached(KZPlayer *player, u32 courseGUID, i32 stageNumber) override;
+	virtual void OnTimerEndPost(KZPlayer *player, u32 courseGUID, f32 time, u32 teleportsUsed) override;
+	virtual void OnTimerStopped(KZPlayer *player, u32 courseGUID) override;
+	virtual void OnTimerInvalidated(KZPlayer *player) override;
+} timerEventListener;
+
+void KZRacingService::DestroyRace(KZRace *race)
+{
+	FOR_EACH_VEC(race->standings, i)
+	{
+		if (race->standings[i].player)
+		{
+			race->standings[i].player->racingService->race = nullptr;
+		}
+	}
+	races.FindAndRemove(race);
+	delete race;
+}
+
+static_function void PrintStanding(KZPlayer *player, KZRace *race, i32 index)
+{
+	const RaceParticipant &participant = race->standings[index];
+	if (participant.forfeited)
+	{
+		player->languageService->PrintChat(true, false, "Race - Standing (Forfeited)", index + 1, participant.name.Get());
+	}
+	else if (participant.finishTime >= 0)
+	{
+		player->languageService->PrintChat(true, false, "Race - Standing (Finished)", index + 1, participant.name.Get(),
+										   KZTimerService::FormatTime(participant.finishTime).Get());
+	}
+	else
+	{
+		player->languageService->PrintChat(true, false, "Race - Standing (Running)", index + 1, participant.name.Get());
+	}
+}
+
+bool KZRacingService::CheckRaceOver(KZRace *race)
+{
+	FOR_EACH_VEC(race->standings, i)
+	{
+		if (!race->standings[i].IsDone())
+		{
+			return false;
+		}
+	}
+	race->Print("Race - Over");
+	FOR_EACH_VEC(race->standings, i)
+	{
+		KZPlayer *player = race->standings[i].player;
+		if (!player)
+		{
+			continue;
+		}
+		FOR_EACH_VEC(race->standings, j)
+		{
+			PrintStanding(player, race, j);
+		}
+	}
+	DestroyRace(race);
+	return true;
+}
+
+void KZRacingService::ReleaseRace(KZRace *race)
+{
+	const KZCourseDescriptor *course = KZ::course::GetCourse(race->courseGUID);
+	if (!course)
+	{
+		race->Print("Race - Cancelled");
+		DestroyRace(race);
+		return;
+	}
+
+	race->state = RACE_RUNNING;
+	i32 tick = g_pKZUtils->GetServerGlobals()->tickcount;
+	// Starting timers can forfeit participants, which reorders the standings, so take a copy first.
+	CUtlVector<KZPlayer *> participants;
+	FOR_EACH_VEC(race->standings, i)
+	{
+		race->standings[i].progressTick = tick;
+		if (race->standings[i].player)
+		{
+			participants.AddToTail(race->standings[i].player);
+		}
+	}
+	race->Print("Race - Go");
+
+	CUtlVector<KZPlayer *> falseStarts;
+	FOR_EACH_VEC(participants, i)
+	{
+		if (!participants[i]->IsAlive() || !participants[i]->timerService->TimerStart(course))
+		{
+			falseStarts.AddToTail(participants[i]);
+		}
+	}
+	FOR_EACH_VEC(falseStarts, i)
+	{
+		// The race is gone once the last participant forfeited.
+		if (falseStarts[i]->racingService->race == race)
+		{
+			falseStarts[i]->racingService->Forfeit("Race - False Start");
+		}
+	}
+}
+
+void KZRacingService::Init()
+{
+	KZTimerService::RegisterEventListener(&timerEventListener);
+}
+
+void KZRacingService::OnGameFrame()
+{
+	if (races.Count() == 0)
+	{
+		return;
+	}
+
+	i32 tick = g_pKZUtils->GetServerGlobals()->tickcount;
+	for (i32 i = races.Count() - 1; i >= 0; i--)
+	{
+		KZRace *race = races[i];
+		if (race->state != RACE_COUNTDOWN)
+		{
+			continue;
+		}
+		i32 ticksLeft = race->releaseTick - tick;
+		if (ticksLeft <= 0)
+		{
+			ReleaseRace(race);
+			continue;
+		}
+		i32 secondsLeft = (i32)ceil(ticksLeft * ENGINE_FIXED_TICK_INTERVAL);
+		if (secondsLeft != race->lastAnnouncedSecond)
+		{
+			race->lastAnnouncedSecond = secondsLeft;
+			race->Print("Race - Countdown", secondsLeft);
+		}
+	}
+}
+
+void KZRacingService::OnServerActivate()
+{
+	// Courses and their start positions are gone with the old map.
+	while (races.Count() > 0)
+	{
+		races[0]->Print("Race - Cancelled");
+		DestroyRace(races[0]);
+	}
+}
+
+void KZRacingService::Reset()
+{
+	if (this->race)
+	{
+		this->LeaveRace();
+	}
+}
+
+i32 KZRacingService::GetRacePosition()
+{
+	return this->race ? this->race->Find(this->player) + 1 : 0;
+}
+
+void KZRacingService::CreateRace(const char *courseName)
+{
+	if (this->race)
+	{
+		this->player->languageService->PrintChat(true, false, "Race - Already Racing");
+		this->player->PlayErrorSound();
+		return;
+	}
+
+	const KZCourseDescriptor *course = nullptr;
+	if (courseName && courseName[0])
+	{
+		course = KZ::course::GetCourse(courseName, false);
+	}
+	else if (this->player->timerService->GetCourse())
+	{
+		course = this->player->timerService->GetCourse();
+	}
+	else if (KZ::course::GetCourseCount() == 1)
+	{
+		course = KZ::course::GetFirstCourse();
+	}
+
+	if (!course)
+	{
+		this->player->languageService->PrintChat(true, false, "Race - Course Not Found");
+		this->player->PlayErrorSound();
+		return;
+	}
+	if (!course->hasStartPosition)
+	{
+		this->player->languageService->PrintChat(true, false, "Race - No Start Position", course->name);
+		this->player->PlayErrorSound();
+		return;
+	}
+
+	KZRace *race = new KZRace();
+	race->host = this->player;
+	race->courseGUID = course->guid;
+	race->startOrigin = course->startPosition;
+	race->startAngles = course->startAngles;
+	race->state = RACE_LOBBY;
+	races.AddToTail(race);
+
+	RaceParticipant participant {};
+	participant.player = this->player;
+	participant.name = this->player->GetName();
+	race->standings.AddToTail(participant);
+	this->race = race;
+
+	KZLanguageService::PrintChatAll(true, "Race - Created", this->player->GetName(), course->name);
+}
+
+void KZRacingService::JoinRace(const char *hostNamePart)
+{
+	if (this->race)
+	{
+		this->player->languageService->PrintChat(true, false, "Race - Already Racing");
+		this->player->PlayErrorSound();
+		return;
+	}
+
+	KZRace *target = nullptr;
+	i32 lobbyCount = 0;
+	FOR_EACH_VEC(races, i)
+	{
+		if (races[i]->state != RACE_LOBBY)
+		{
+			continue;
+		}
+		lobbyCount++;
+		if (!hostNamePart || !hostNamePart[0] || V_stristr(races[i]->host->GetName(), hostNamePart))
+		{
+			target = races[i];
+		}
+	}
+
+	if (!target)
+	{
+		this->player->languageService->PrintChat(true, false, "Race - Not Found");
+		this->player->PlayErrorSound();
+		return;
+	}
+	if ((!hostNamePart || !hostNamePart[0]) && lobbyCount > 1)
+	{
+		this->player->languageService->PrintChat(true, false, "Race - Specify Host");
+		return;
+	}
+
+	RaceParticipant participant {};
+	participant.player = this->player;
+	participant.name = this->player->GetName();
+	target->standings.AddToTail(participant);
+	this->race = target;
+	target->Print("Race - Joined", this->player->GetName(), target->standings.Count());
+}
+
+void KZRacingService::LeaveRace()
+{
+	if (!this->race)
+	{
+		this->player->languageService->PrintChat(true, false, "Race - Not In Race");
+		return;
+	}
+
+	if (this->race->state != RACE_LOBBY)
+	{
+		this->Forfeit("Race - Left");
+		return;
+	}
+
+	KZRace *race = this->race;
+	if (race->host == this->player)
+	{
+		race->Print("Race - Cancelled");
+		DestroyRace(race);
+		return;
+	}
+	race->Print("Race - Left Lobby", this->player->GetName());
+	race->standings.Remove(race->Find(this->player));
+	this->race = nullptr;
+}
+
+void KZRacingService::StartRace()
+{
+	if (!this->race || this->race->host != this->player)
+	{
+		this->player->languageService->PrintChat(true, false, "Race - Not Host");
+		this->player->PlayErrorSound();
+		return;
+	}
+	KZRace *race = this->race;
+	if (race->state != RACE_LOBBY)
+	{
+		return;
+	}
+
+	// Participants can't start the race dead.
+	for (i32 i = race->standings.Count() - 1; i >= 0; i--)
+	{
+		KZPlayer *participant = race->standings[i].player;
+		if (!participant->IsAlive() && participant != this->player)
+		{
+			race->Print("Race - Removed (Dead)", participant->GetName());
+			participant->racingService->race = nullptr;
+			race->standings.Remove(i);
+		}
+	}
+	if (!this->player->IsAlive() || race->standings.Count() < KZ_RACE_MIN_PARTICIPANTS)
+	{
+		this->player->languageService->PrintChat(true, false, "Race - Not Enough Participants", KZ_RACE_MIN_PARTICIPANTS);
+		this->player->PlayErrorSound();
+		return;
+	}
+
+	FOR_EACH_VEC(race->standings, i)
+	{
+		KZPlayer *participant = race->standings[i].player;
+		if (participant->timerService->GetPaused())
+		{
+			participant->timerService->Resume(true);
+		}
+		participant->timerService->TimerStop(false);
+		participant->checkpointService->ResetCheckpoints();
+		participant->noclipService->DisableNoclip();
+		participant->Teleport(&race->startOrigin, &race->startAngles, &vec3_origin);
+	}
+
+	race->state = RACE_COUNTDOWN;
+	race->releaseTick = g_pKZUtils->GetServerGlobals()->tickcount + (i32)(KZ_RACE_COUNTDOWN_SECONDS / ENGINE_FIXED_TICK_INTERVAL);
+	race->lastAnnouncedSecond = 0;
+}
+
+void KZRacingService::PrintStandings()
+{
+	if (!this->race)
+	{
+		this->player->languageService->PrintChat(true, false, "Race - Not In Race");
+		return;
+	}
+	const KZCourseDescriptor *course = KZ::course::GetCourse(this->race->courseGUID);
+	this->player->languageService->PrintChat(true, false, "Race - Standings Header", course ? course->name : "");
+	FOR_EACH_VEC(this->race->standings, i)
+	{
+		PrintStanding(this->player, this->race, i);
+	}
+}
+
+void KZRacingService::OnProcessMovement()
+{
+	if (!this->race || this->race->state != RACE_COUNTDOWN || !this->player->IsAlive())
+	{
+		return;
+	}
+	Vector origin;
+	this->player->GetOrigin(&origin);
+	// Same as TpHoldPlayerStill, setting the origin when it already matches moves the player.
+	if (origin != this->race->startOrigin)
+	{
+		this->player->SetOrigin(this->race->startOrigin);
+	}
+	this->player->SetVelocity(vec3_origin);
+}
+
+void KZRacingService::Forfeit(const char *reason)
+{
+	KZRace *race = this->race;
+	i32 index = race->Find(this->player);
+	RaceParticipant &participant = race->standings[index];
+	participant.player = nullptr;
+	this->race = nullptr;
+	if (participant.IsDone())
+	{
+		return;
+	}
+
+	participant.forfeited = true;
+	race->Reposition(index);
+	this->player->languageService->PrintChat(true, false, reason);
+	race->Print("Race - Forfeited", this->player->GetName());
+	CheckRaceOver(race);
+}
+
+void KZRacingService::OnZoneReached(u32 courseGUID, u32 progressIncrement)
+{
+	if (!this->race || this->race->state != RACE_RUNNING || courseGUID != this->race->courseGUID)
+	{
+		return;
+	}
+	i32 index = this->race->Find(this->player);
+	RaceParticipant &participant = this->race->standings[index];
+	// Finished participants stay in the race until it ends, further runs don't count.
+	if (participant.IsDone())
+	{
+		return;
+	}
+	participant.progress += progressIncrement;
+	participant.progressTick = g_pKZUtils->GetServerGlobals()->tickcount;
+	i32 newIndex = this->race->Reposition(index);
+	if (newIndex < index)
+	{
+		this->player->languageService->PrintChat(true, false, "Race - Position", newIndex + 1, this->race->standings.Count());
+	}
+}
+
+void KZTimerServiceEventListener_Racing::OnTimerStartPost(KZPlayer *player, u32 courseGUID)
+{
+	KZRace *race = player->racingService->race;
+	if (race && race->state == RACE_RUNNING && courseGUID != race->courseGUID)
+	{
+		player->racingService->Forfeit("Race - Wrong Course");
+	}
+}
+
+void KZTimerServiceEventListener_Racing::OnSplitZoneReached(KZPlayer *player, u32 courseGUID, i32 splitNumber)
+{
+	player->racingService->OnZoneReached(courseGUID, RACE_PROGRESS_SPLIT);
+}
+
+void KZTimerServiceEventListener_Racing::OnCheckpointZoneReached(KZPlayer *player, u32 courseGUID, i32 cpNumber)
+{
+	player->racingService->OnZoneReached(courseGUID, RACE_PROGRESS_CHECKPOINT);
+}
+
+void KZTimerServiceEventListener_Racing::OnStageZoneReached(KZPlayer *player, u32 courseGUID, i32 stageNumber)
+{
+	player->racingService->OnZoneReached(courseGUID, RACE_PROGRESS_STAGE);
+}
+
+void KZTimerServiceEventListener_Racing::OnTimerEndPost(KZPlayer *player, u32 courseGUID, f32 time, u32 teleportsUsed)
+{
+	KZRace *race = player->racingService->race;
+	if (!race || race->state != RACE_RUNNING || courseGUID != race->courseGUID)
+	{
+		return;
+	}
+	i32 index = race->Find(player);
+	if (race->standings[index].IsDone())
+	{
+		return;
+	}
+	race->standings[index].finishTime = time;
+	i32 place = race->Reposition(index) + 1;
+	race->Print("Race - Finished", player->GetName(), place, KZTimerService::FormatTime(time).Get(), teleportsUsed);
+	CheckRaceOver(race);
+}
+
+void KZTimerServiceEventListener_Racing::OnTimerStopped(KZPlayer *player, u32 courseGUID)
+{
+	KZRace *race = player->racingService->race;
+	if (race && race->state == RACE_RUNNING && courseGUID == race->courseGUID)
+	{
+		player->racingService->Forfeit("Race - Timer Stopped");
+	}
+}
+
+void KZTimerServiceEventListener_Racing::OnTimerInvalidated(KZPlayer *player)
+{
+	KZRace *race = player->racingService->race;
+	if (race && race->state == RACE_RUNNING)
+	{
+		player->racingService->Forfeit("Race - Run Invalidated");
+	}
+}
+
+SCMD(kz_race, SCFL_RACING)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	player->racingService->CreateRace(args->ArgS());
+	return MRES_SUPERCEDE;
+}
+
+SCMD(kz_joinrace, SCFL_RACING)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	player->racingService->JoinRace(args->ArgS());
+	return MRES_SUPERCEDE;
+}
+
+SCMD(kz_leaverace, SCFL_RACING)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	player->racingService->LeaveRace();
+	return MRES_SUPERCEDE;
+}
+
+SCMD(kz_startrace, SCFL_RACING)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	player->racingService->StartRace();
+	return MRES_SUPERCEDE;
+}
+
+SCMD(kz_racestatus, SCFL_RACING)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	player->racingService->PrintStandings();
+	return MRES_SUPERCEDE;
+}
@@ -1,7 +1,58 @@
 #pragma once
 #include "../kz.h"
 
+#define KZ_RACE_COUNTDOWN_SECONDS 5
+#define KZ_RACE_MIN_PARTICIPANTS  2
+
+/*
+	Races are hosted by a player on one course. Once the host starts the race, every participant is brought to the course's
+	start position and held there during the countdown, then all timers are started on the same server tick.
+
+	Standings are kept sorted and only move when someone reaches a zone, finishes or forfeits,
+	so running races cost nothing per tick.
+*/
+
+struct KZRace;
+
 class KZRacingService : public KZBaseService
 {
 	using KZBaseService::KZBaseService;
+
+private:
+	KZRace *race {};
+
+	void Forfeit(const char *reason);
+	void OnZoneReached(u32 courseGUID, u32 progressIncrement);
+
+	static void ReleaseRace(KZRace *race);
+	// Ends the race once nobody is left running, returns whether it did.
+	static bool CheckRaceOver(KZRace *race);
+	static void DestroyRace(KZRace *race);
+
+public:
+	static void Init();
+	// Counts down and releases races, called once per server tick.
+	static void OnGameFrame();
+	static void OnServerActivate();
+
+	virtual void Reset() override;
+
+	bool IsRacing()
+	{
+		return this->race != nullptr;
+	}
+
+	// Position in the standings starting from 1, 0 if not racing.
+	i32 GetRacePosition();
+
+	void CreateRace(const char *courseName);
+	void JoinRace(const char *hostNamePart);
+	void LeaveRace();
+	void StartRace();
+	void PrintStandings();
+
+	// Keep the participant at the start during the countdown.
+	void OnProcessMovement();
+
+	friend class KZTimerServiceEventListener_Racing;
 };
@@ -0,0 +1,41 @@
+#include "kz_saveloc.h"
+#include "utils/simplecmds.h"
+
+SCMD(kz_saveloc, SCFL_SAVELOC)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	player->savelocService->CreateSaveloc();
+	return MRES_SUPERCEDE;
+}
+
+SCMD_LINK(kz_sl, kz_saveloc);
+
+SCMD(kz_loadloc, SCFL_SAVELOC)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	player->savelocService->LoadSaveloc(args->ArgC() >= 2 ? V_StringToInt32(args->Arg(1), -1) : 0);
+	return MRES_SUPERCEDE;
+}
+
+SCMD_LINK(kz_ll, kz_loadloc);
+
+SCMD(kz_prevloc, SCFL_SAVELOC)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	player->savelocService->LoadPrevSaveloc();
+	return MRES_SUPERCEDE;
+}
+
+SCMD(kz_nextloc, SCFL_SAVELOC)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	player->savelocService->LoadNextSaveloc();
+	return MRES_SUPERCEDE;
+}
+
+SCMD(kz_shareloc, SCFL_SAVELOC)
+{
+	KZPlayer *player = g_pKZPlayerManager->ToPlayer(controller);
+	player->savelocService->ShareSaveloc(args->ArgC() >= 2 ? args->Arg(1) : "");
+	return MRES_SUPERCEDE;
+}
@@ -1 +1,478 @@
 #include "kz_saveloc.h"
+#include "../db/kz_db.h"
+#include "../language/kz_language.h"
+#include "../noclip/kz_noclip.h"
+#include "../option/kz_option.h"
+#include "../timer/kz_timer.h"
+#include "kz/trigger/kz_trigger.h"
+#include "utils/utils.h"
+#include "utils/ctimer.h"
+
+#include "../db/queries/savelocs.h"
+#include "vendor/sql_mm/src/public/sql_mm.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace KZ::Database;
+
+// Pending savelocs are written once this many are queued, or every SAVELOC_FLUSH_INTERVAL seconds.
+#define SAVELOC_WRITE_BATCH_SIZE 32
+#define SAVELOC_FLUSH_INTERVAL   5.0
+// Writes are dropped past this to keep memory bounded while the database is unavailable.
+#define SAVELOC_MAX_PENDING      1024
+
+struct SavelocSlot
+{
+	Saveloc saveloc;
+	u32 generation {};
+	u32 refCount {};
+	i32 nextFree = -1;
+};
+
+static_global struct
+{
+	CUtlVector<SavelocSlot> slots;
+	i32 firstFree = -1;
+	i32 usedCount;
+} pool;
+
+static_global i32 maxSavelocsPerPlayer = 64;
+static_global bool persistSavelocs;
+
+struct PendingSaveloc
+{
+	u64 steamID64;
+	i32 mapID;
+	u32 mapCourseID;
+	Saveloc saveloc;
+};
+
+static_global CUtlVector<PendingSaveloc> pendingWrites;
+
+static_global class KZDatabaseServiceEventListener_Saveloc : public KZDatabaseServiceEventListener
+{
+public:
+	virtual void OnMapSetup() override;
+	virtual void OnClientSetup(Player *player, u64 steamID64, bool isCheater) override;
+} databaseEventListener;
+
+static_function void ResetPool()
+{
+	FOR_EACH_VEC(pool.slots, i)
+	{
+		// Invalidate every handle that still points to this slot.
+		pool.slots[i].generation++;
+		pool.slots[i].refCount = 0;
+		pool.slots[i].nextFree = i + 1 < pool.slots.Count() ? i + 1 : -1;
+	}
+	pool.firstFree = pool.slots.Count() > 0 ? 0 : -1;
+	pool.usedCount = 0;
+}
+
+static_function Saveloc *ResolveSaveloc(SavelocHandle handle)
+{
+	if (!pool.slots.IsValidIndex(handle.index))
+	{
+		return nullptr;
+	}
+	SavelocSlot &slot = pool.slots[handle.index];
+	return slot.generation == handle.generation && slot.refCount > 0 ? &slot.saveloc : nullptr;
+}
+
+// The new saveloc is freed again as soon as nothing references it, use AcquireSaveloc to keep it.
+static_function SavelocHandle AllocSaveloc(const Saveloc &saveloc)
+{
+	if (pool.firstFree < 0)
+	{
+		return {};
+	}
+	i32 index = pool.firstFree;
+	SavelocSlot &slot = pool.slots[index];
+	pool.firstFree = slot.nextFree;
+	pool.usedCount++;
+	slot.saveloc = saveloc;
+	slot.refCount = 0;
+	slot.nextFree = -1;
+	return {index, slot.generation};
+}
+
+static_function void AcquireSaveloc(SavelocHandle handle)
+{
+	if (pool.slots.IsValidIndex(handle.index) && pool.slots[handle.index].generation == handle.generation)
+	{
+		pool.slots[handle.index].refCount++;
+	}
+}
+
+static_function void ReleaseSaveloc(SavelocHandle handle)
+{
+	if (!ResolveSaveloc(handle))
+	{
+		return;
+	}
+	SavelocSlot &slot = pool.slots[handle.index];
+	if (--slot.refCount > 0)
+	{
+		return;
+	}
+	slot.generation++;
+	slot.nextFree = pool.firstFree;
+	pool.firstFree = handle.index;
+	pool.usedCount--;
+}
+
+static_function void FlushPendingSavelocs()
+{
+	if (pendingWrites.Count() == 0 || !KZDatabaseService::IsReady())
+	{
+		return;
+	}
+
+	Transaction txn;
+	char query[1024];
+	FOR_EACH_VEC(pendingWrites, i)
+	{
+		const PendingSaveloc &pending = pendingWrites[i];
+		const Saveloc &saveloc = pending.saveloc;
+		const KZCheckpointService::Checkpoint &cp = saveloc.checkpoint;
+		V_snprintf(query, sizeof(query), sql_savelocs_insert, pending.steamID64, pending.mapID, cp.origin.x, cp.origin.y, cp.origin.z, cp.angles.x,
+				   cp.angles.y, saveloc.velocity.x, saveloc.velocity.y, saveloc.velocity.z, cp.ladderNormal.x, cp.ladderNormal.y, cp.ladderNormal.z,
+				   cp.onLadder, cp.slopeDropOffset, cp.slopeDropHeight, saveloc.ducked, saveloc.duckAmount, pending.mapCourseID,
+				   saveloc.timerRunning ? saveloc.time : 0.0);
+		txn.queries.push_back(query);
+		V_snprintf(query, sizeof(query), sql_savelocs_prune, pending.steamID64, pending.mapID, pending.steamID64, pending.mapID,
+				   maxSavelocsPerPlayer);
+		txn.queries.push_back(query);
+	}
+	pendingWrites.RemoveAll();
+	KZDatabaseService::GetDatabaseConnection()->ExecuteTransaction(txn, KZDatabaseService::OnGenericTxnSuccess, KZDatabaseService::OnGenericTxnFailure);
+}
+
+static_function f64 FlushSavelocsTimer()
+{
+	FlushPendingSavelocs();
+	return SAVELOC_FLUSH_INTERVAL;
+}
+
+void KZSavelocService::Init()
+{
+	i32 poolSize = MAX(KZOptionService::GetConfig().savelocPoolSize, 0);
+	maxSavelocsPerPlayer = MAX(KZOptionService::GetConfig().savelocMaxPerPlayer, 1);
+	persistSavelocs = KZOptionService::GetConfig().savelocPersist;
+
+	pool.slots.SetCount(poolSize);
+	ResetPool();
+
+	KZDatabaseService::RegisterEventListener(&databaseEventListener);
+	if (persistSavelocs)
+	{
+		StartTimer(FlushSavelocsTimer, SAVELOC_FLUSH_INTERVAL, true, true);
+	}
+}
+
+void KZSavelocService::Cleanup()
+{
+	FlushPendingSavelocs();
+}
+
+void KZSavelocService::OnServerActivate()
+{
+	// Savelocs only make sense on the map they were made on.
+	FlushPendingSavelocs();
+	for (i32 i = 0; i <= MAXPLAYERS; i++)
+	{
+		KZPlayer *player = g_pKZPlayerManager->ToPlayer(i);
+		if (player && player->savelocService)
+		{
+			player->savelocService->savelocs.RemoveAll();
+			player->savelocService->currentSavelocIndex = 0;
+		}
+	}
+	ResetPool();
+}
+
+void KZSavelocService::Reset()
+{
+	FOR_EACH_VEC(this->savelocs, i)
+	{
+		ReleaseSaveloc(this->savelocs[i]);
+	}
+	this->savelocs.RemoveAll();
+	this->currentSavelocIndex = 0;
+}
+
+bool KZSavelocService::AddSaveloc(SavelocHandle handle, bool persist)
+{
+	Saveloc *saveloc = ResolveSaveloc(handle);
+	if (!saveloc && pool.slots.IsValidIndex(handle.index) && pool.slots[handle.index].generation == handle.generation)
+	{
+		// Freshly allocated, not referenced by anyone yet.
+		saveloc = &pool.slots[handle.index].saveloc;
+	}
+	if (!saveloc)
+	{
+		return false;
+	}
+
+	AcquireSaveloc(handle);
+	if (this->savelocs.Count() >= maxSavelocsPerPlayer)
+	{
+		ReleaseSaveloc(this->savelocs[0]);
+		this->savelocs.Remove(0);
+	}
+	this->savelocs.AddToTail(handle);
+	this->currentSavelocIndex = this->savelocs.Count() - 1;
+
+	if (persist && persistSavelocs && this->player->databaseService->IsSetup() && KZDatabaseService::GetMapID() > 0)
+	{
+		if (pendingWrites.Count() >= SAVELOC_MAX_PENDING)
+		{
+			pendingWrites.Remove(0);
+		}
+		const KZCourseDescriptor *course = KZ::course::GetCourse(saveloc->courseGUID);
+		pendingWrites.AddToTail({saveloc->ownerSteamID64, KZDatabaseService::GetMapID(), course ? course->localDatabaseID : 0, *saveloc});
+		if (pendingWrites.Count() >= SAVELOC_WRITE_BATCH_SIZE)
+		{
+			FlushPendingSavelocs();
+		}
+	}
+	return true;
+}
+
+void KZSavelocService::CreateSaveloc()
+{
+	CCSPlayerPawn *pawn = this->player->GetPlayerPawn();
+	if (!pawn || !pawn->IsAlive())
+	{
+		return;
+	}
+
+	Saveloc saveloc = {};
+	this->player->checkpointService->CaptureCheckpoint(saveloc.checkpoint);
+	this->player->GetVelocity(&saveloc.velocity);
+	CCSPlayer_MovementServices *ms = this->player->GetMoveServices();
+	if (ms)
+	{
+		saveloc.ducked = ms->m_bDucked();
+		saveloc.duckAmount = ms->m_flDuckAmount();
+	}
+	const KZCourseDescriptor *course = this->player->timerService->GetCourse();
+	saveloc.timerRunning = this->player->timerService->GetTimerRunning() && course;
+	saveloc.courseGUID = course ? course->guid : 0;
+	saveloc.time = this->player->timerService->GetTime();
+	saveloc.ownerSteamID64 = this->player->GetSteamId64();
+
+	SavelocHandle handle = AllocSaveloc(saveloc);
+	if (!this->AddSaveloc(handle, true))
+	{
+		this->player->languageService->PrintChat(true, false, "Can't Saveloc (Pool Full)");
+		this->player->PlayErrorSound();
+		return;
+	}
+	this->player->languageService->PrintChat(true, false, "Make Saveloc", this->savelocs.Count());
+	this->player->checkpointService->PlayCheckpointSound();
+}
+
+void KZSavelocService::LoadSaveloc(i32 index)
+{
+	CCSPlayerPawn *pawn = this->player->GetPlayerPawn();
+	if (!pawn || !pawn->IsAlive())
+	{
+		return;
+	}
+	if (this->savelocs.Count() == 0)
+	{
+		this->player->languageService->PrintChat(true, false, "Can't Load Saveloc (No Savelocs)");
+		this->player->PlayErrorSound();
+		return;
+	}
+	if (index < 0 || index > this->savelocs.Count())
+	{
+		this->player->languageService->PrintChat(true, false, "Can't Load Saveloc (Invalid Number)", this->savelocs.Count());
+		this->player->PlayErrorSound();
+		return;
+	}
+	if (index > 0)
+	{
+		this->currentSavelocIndex = index - 1;
+	}
+	const Saveloc *saveloc = ResolveSaveloc(this->savelocs[this->currentSavelocIndex]);
+	if (!saveloc)
+	{
+		return;
+	}
+	if (!this->player->triggerService->CanTeleportToCheckpoints())
+	{
+		this->player->languageService->PrintChat(true, false, "Can't Teleport (Map)");
+		this->player->PlayErrorSound();
+		return;
+	}
+
+	const KZCheckpointService::Checkpoint &cp = saveloc->checkpoint;
+	this->player->noclipService->DisableNoclip();
+	this->player->Teleport(&cp.origin, &cp.angles, &saveloc->velocity);
+	pawn->m_flSlopeDropHeight(cp.slopeDropHeight);
+	pawn->m_flSlopeDropOffset(cp.slopeDropOffset);
+
+	CBaseEntity *groundEntity = static_cast<CBaseEntity *>(GameEntitySystem()->GetEntityInstance(cp.groundEnt));
+	// Same as checkpoints, don't attach the player onto something that might have moved away.
+	if (groundEntity
+		&& (groundEntity->entindex() == 0
+			|| (groundEntity->m_vecBaseVelocity().Length() == 0.0f && groundEntity->m_vecAbsVelocity().Length() == 0.0f)))
+	{
+		pawn->m_hGroundEntity(cp.groundEnt);
+	}
+
+	CCSPlayer_MovementServices *ms = this->player->GetMoveServices();
+	if (ms)
+	{
+		ms->m_bDucked(saveloc->ducked);
+		ms->m_flDuckAmount(saveloc->duckAmount);
+		ms->m_vecLadderNormal(cp.onLadder ? cp.ladderNormal : vec3_origin);
+	}
+	if (cp.onLadder)
+	{
+		this->player->SetMoveType(MOVETYPE_LADDER);
+	}
+
+	const KZCourseDescriptor *course = KZ::course::GetCourse(saveloc->courseGUID);
+	if (saveloc->timerRunning && course)
+	{
+		this->player->timerService->ContinueRun(course, saveloc->time);
+	}
+	else
+	{
+		this->player->timerService->TimerStop(false);
+	}
+
+	this->player->languageService->PrintChat(true, false, "Load Saveloc", this->currentSavelocIndex + 1);
+	this->player->checkpointService->PlayTeleportSound();
+}
+
+void KZSavelocService::LoadPrevSaveloc()
+{
+	this->LoadSaveloc(MAX(this->currentSavelocIndex, 1));
+}
+
+void KZSavelocService::LoadNextSaveloc()
+{
+	this->LoadSaveloc(MIN(this->currentSavelocIndex + 2, this->savelocs.Count()));
+}
+
+void KZSavelocService::ShareSaveloc(const char *playerNamePart)
+{
+	if (this->savelocs.Count() == 0)
+	{
+		this->player->languageService->PrintChat(true, false, "Can't Load Saveloc (No Savelocs)");
+		this->player->PlayErrorSound();
+		return;
+	}
+	if (!playerNamePart || !playerNamePart[0])
+	{
+		this->player->languageService->PrintChat(true, false, "Share Saveloc Command Usage");
+		return;
+	}
+
+	for (i32 i = 0; i <= MAXPLAYERS; i++)
+	{
+		KZPlayer *otherPlayer = g_pKZPlayerManager->ToPlayer(i);
+		if (!otherPlayer || !otherPlayer->GetController() || otherPlayer == this->player)
+		{
+			continue;
+		}
+		if (!V_stristr(otherPlayer->GetName(), playerNamePart))
+		{
+			continue;
+		}
+		// The other player only gets a reference, the saveloc stays owned and persisted by its creator.
+		if (otherPlayer->savelocService->AddSaveloc(this->savelocs[this->currentSavelocIndex], false))
+		{
+			this->player->languageService->PrintChat(true, false, "Share Saveloc", otherPlayer->GetName());
+			otherPlayer->languageService->PrintChat(true, false, "Received Saveloc", this->player->GetName(),
+													otherPlayer->savelocService->GetSavelocCount());
+		}
+		return;
+	}
+	this->player->languageService->PrintChat(true, false, "Share Saveloc Player Not Found", playerNamePart);
+}
+
+void KZSavelocService::LoadPersistedSavelocs()
+{
+	if (!persistSavelocs || !KZDatabaseService::IsReady() || KZDatabaseService::GetMapID() <= 0 || !this->player->databaseService->IsSetup())
+	{
+		return;
+	}
+
+	char query[1024];
+	u64 steamID64 = this->player->GetSteamId64();
+	V_snprintf(query, sizeof(query), sql_savelocs_get, steamID64, KZDatabaseService::GetMapID(), maxSavelocsPerPlayer);
+	Transaction txn;
+	txn.queries.push_back(query);
+
+	CPlayerUserId userID = this->player->GetClient()->GetUserID();
+	auto onQuerySuccess = [userID, steamID64](std::vector<ISQLQuery *> queries)
+	{
+		KZPlayer *pl = g_pKZPlayerManager->ToPlayer(userID);
+		ISQLResult *result = queries[0]->GetResultSet();
+		if (!pl || !result || result->GetRowCount() == 0)
+		{
+			return;
+		}
+
+		// Rows come newest first.
+		CUtlVector<Saveloc> loaded;
+		while (result->FetchRow())
+		{
+			Saveloc saveloc = {};
+			KZCheckpointService::Checkpoint &cp = saveloc.checkpoint;
+			cp.origin = Vector(result->GetFloat(0), result->GetFloat(1), result->GetFloat(2));
+			cp.angles = QAngle(result->GetFloat(3), result->GetFloat(4), 0.0f);
+			saveloc.velocity = Vector(result->GetFloat(5), result->GetFloat(6), result->GetFloat(7));
+			cp.ladderNormal = Vector(result->GetFloat(8), result->GetFloat(9), result->GetFloat(10));
+			cp.onLadder = result->GetInt(11);
+			cp.slopeDropOffset = result->GetFloat(12);
+			cp.slopeDropHeight = result->GetFloat(13);
+			saveloc.ducked = result->GetInt(14);
+			saveloc.duckAmount = result->GetFloat(15);
+			const KZCourseDescriptor *course = KZ::course::GetCourseByLocalCourseID(result->GetInt(16));
+			saveloc.courseGUID = course ? course->guid : 0;
+			saveloc.time = result->GetFloat(17);
+			saveloc.timerRunning = course && saveloc.time > 0;
+			saveloc.ownerSteamID64 = steamID64;
+			loaded.AddToTail(saveloc);
+		}
+		for (i32 i = loaded.Count() - 1; i >= 0; i--)
+		{
+			if (!pl->savelocService->AddSaveloc(AllocSaveloc(loaded[i]), false))
+			{
+				break;
+			}
+		}
+		pl->languageService->PrintChat(true, false, "Loaded Persisted Savelocs", pl->savelocService->GetSavelocCount());
+	};
+	KZDatabaseService::GetDatabaseConnection()->ExecuteTransaction(txn, onQuerySuccess, KZDatabaseService::OnGenericTxnFailure);
+}
+
+void KZDatabaseServiceEventListener_Saveloc::OnMapSetup()
+{
+	for (i32 i = 0; i <= MAXPLAYERS; i++)
+	{
+		KZPlayer *player = g_pKZPlayerManager->ToPlayer(i);
+		if (player && player->savelocService && player->savelocService->GetSavelocCount() == 0)
+		{
+			player->savelocService->LoadPersistedSavelocs();
+		}
+	}
+}
+
+void KZDatabaseServiceEventListener_Saveloc::OnClientSetup(Player *player, u64 steamID64, bool isCheater)
+{
+	KZPlayer *kzPlayer = g_pKZPlayerManager->ToKZPlayer(player);
+	kzPlayer->savelocService->LoadPersistedSavelocs();
+}
+
+CON_COMMAND_F(kz_saveloc_stats, "Print saveloc pool usage", FCVAR_NONE)
+{
+	META_CONPRINTF("[KZ::Saveloc] Pool: %d/%d savelocs used (%llu bytes), %d writes pending, persistence %s.\n", pool.usedCount,
+				   pool.slots.Count(), (u64)pool.slots.Count() * sizeof(SavelocSlot), pendingWrites.Count(), persistSavelocs ? "on" : "off");
+}
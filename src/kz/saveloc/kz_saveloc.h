@@ -1,7 +1,62 @@
 #pragma once
 #include "../kz.h"
+#include "../checkpoint/kz_checkpoint.h"
+
+/*
+	Savelocs capture the player's full position and run state, including mid-air velocity.
+
+	All savelocs live in one server-wide pool sized by the "savelocPoolSize" option. Players only keep handles to them,
+	so sharing a saveloc with another player is a reference count increment rather than a copy.
+	With "savelocPersist" enabled, new savelocs are written to the local database in batches and reloaded on the next visit.
+*/
+
+struct Saveloc
+{
+	KZCheckpointService::Checkpoint checkpoint;
+	Vector velocity;
+	bool ducked;
+	f32 duckAmount;
+	bool timerRunning;
+	u32 courseGUID;
+	f64 time;
+	u64 ownerSteamID64;
+};
+
+// Refers to a saveloc in the pool. Resolving fails once the saveloc is freed, even if its slot was reused.
+struct SavelocHandle
+{
+	i32 index = -1;
+	u32 generation {};
+};
 
 class KZSavelocService : public KZBaseService
 {
 	using KZBaseService::KZBaseService;
+
+private:
+	// Handles into the pool, oldest first. Savelocs shared by other players are kept here as well.
+	CUtlVector<SavelocHandle> savelocs;
+	i32 currentSavelocIndex {};
+
+	bool AddSaveloc(SavelocHandle handle, bool persist);
+
+public:
+	static void Init();
+	static void Cleanup();
+	static void OnServerActivate();
+
+	virtual void Reset() override;
+
+	void CreateSaveloc();
+	// Index is 1-based, 0 loads the current saveloc.
+	void LoadSaveloc(i32 index = 0);
+	void LoadPrevSaveloc();
+	void LoadNextSaveloc();
+	void ShareSaveloc(const char *playerNamePart);
+	void LoadPersistedSavelocs();
+
+	i32 GetSavelocCount()
+	{
+		return this->savelocs.Count();
+	}
 };
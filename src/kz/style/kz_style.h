@@ -1,7 +1,7 @@
 #pragma once
 #include "../kz.h"
 
-#define KZ_STYLE_MANAGER_INTERFACE "KZStyleManagerInterface"
+#define KZ_STYLE_MANAGER_INTERFACE "KZStyleManagerInterface002"
 
 // TODO styles: normal, backwards, sw, hsw, w only, lowgrav, autobhop, 250 speed, high gravity, notrigger, alivestrafe
 class KZStyleService : public KZBaseService
@@ -158,6 +158,13 @@ public:
 	{
 		return true;
 	}
+
+	// Movement hooks that this style implements, see MovementHook. Hooks outside of this mask are not forwarded to the style.
+	// Styles should return movement::GetOverriddenHooks<StyleClass, KZStyleService>() unless they need something more specific.
+	virtual u64 GetSubscribedHooks()
+	{
+		return MVHOOK_MASK_ALL;
+	}
 };
 
 typedef KZStyleService *(*StyleServiceFactory)(KZPlayer *player);
@@ -121,11 +121,6 @@ CGameEntitySystem *GameEntitySystem()
 	return g_pKZUtils->GetGameEntitySystem();
 }
 
-void KZAutoBhopStyleService::Init()
-{
-	g_pKZUtils->SendConVarValue(this->player->GetPlayerSlot(), sv_autobunnyhopping, "true");
-}
-
 const CVValue_t *KZAutoBhopStyleService::GetTweakedConvarValue(const char *name)
 {
 	static_persist const CVValue_t sv_autobunnyhopping_desiredValue = true;
@@ -136,11 +131,6 @@ const CVValue_t *KZAutoBhopStyleService::GetTweakedConvarValue(const char *name)
 	return nullptr;
 }
 
-void KZAutoBhopStyleService::Cleanup()
-{
-	g_pKZUtils->SendConVarValue(this->player->GetPlayerSlot(), sv_autobunnyhopping, "false");
-}
-
 void KZAutoBhopStyleService::OnProcessMovement()
 {
 	sv_autobunnyhopping.Set(true);
@@ -37,8 +37,11 @@ public:
 		return "ABH";
 	}
 
+	virtual u64 GetSubscribedHooks() override
+	{
+		return movement::GetOverriddenHooks<KZAutoBhopStyleService, KZStyleService>();
+	}
+
 	virtual const CVValue_t *GetTweakedConvarValue(const char *name) override;
-	virtual void Init() override;
-	virtual void Cleanup() override;
 	virtual void OnProcessMovement() override;
 };
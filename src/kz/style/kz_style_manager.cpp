@@ -1,4 +1,5 @@
 #include "kz_style.h"
+#include "../mode/kz_mode.h"
 
 #include "filesystem.h"
 
@@ -260,10 +261,12 @@ void KZStyleManager::AddStyle(KZPlayer *player, const char *styleName, bool sile
 		}
 	}
 	player->styleServices.AddToTail(info.factory(player));
+	player->OnModeStyleServicesChanged();
 	player->timerService->TimerStop();
 	player->styleServices.Tail()->Init();
+	KZ::mode::ReplicateModeCvars(player);
 
-	player->optionService->SetPreferenceStr("preferredStyles", styleManager.GetStylesString(player));
+	player->optionService->SetPreference(KZ::pref::preferredStyles, styleManager.GetStylesString(player));
 	if (!silent)
 	{
 		player->languageService->PrintChat(true, false, "Style Added", info.longName);
@@ -289,8 +292,10 @@ void KZStyleManager::RemoveStyle(KZPlayer *player, const char *styleName, bool s
 				player->languageService->PrintChat(true, false, "Style Removed", style->GetStyleName());
 			}
 			player->styleServices.Remove(i);
+			player->OnModeStyleServicesChanged();
 			delete style;
-			player->optionService->SetPreferenceStr("preferredStyles", styleManager.GetStylesString(player));
+			KZ::mode::ReplicateModeCvars(player);
+			player->optionService->SetPreference(KZ::pref::preferredStyles, styleManager.GetStylesString(player));
 			return;
 		}
 	}
@@ -322,8 +327,10 @@ void KZStyleManager::ToggleStyle(KZPlayer *player, const char *styleName, bool s
 				player->languageService->PrintChat(true, false, "Style Removed", style->GetStyleName());
 			}
 			player->styleServices.Remove(i);
+			player->OnModeStyleServicesChanged();
 			delete style;
-			player->optionService->SetPreferenceStr("preferredStyles", styleManager.GetStylesString(player));
+			KZ::mode::ReplicateModeCvars(player);
+			player->optionService->SetPreference(KZ::pref::preferredStyles, styleManager.GetStylesString(player));
 			return;
 		}
 	}
@@ -360,9 +367,11 @@ void KZStyleManager::ToggleStyle(KZPlayer *player, const char *styleName, bool s
 		}
 	}
 	player->styleServices.AddToTail(info.factory(player));
+	player->OnModeStyleServicesChanged();
 	player->timerService->TimerStop();
 	player->styleServices.Tail()->Init();
-	player->optionService->SetPreferenceStr("preferredStyles", styleManager.GetStylesString(player));
+	KZ::mode::ReplicateModeCvars(player);
+	player->optionService->SetPreference(KZ::pref::preferredStyles, styleManager.GetStylesString(player));
 	if (!silent)
 	{
 		player->languageService->PrintChat(true, false, "Style Added", info.longName);
@@ -376,7 +385,9 @@ void KZStyleManager::ClearStyles(KZPlayer *player, bool silent)
 		player->styleServices[i]->Cleanup();
 	}
 	player->styleServices.PurgeAndDeleteElements();
-	player->optionService->SetPreferenceStr("preferredStyles", styleManager.GetStylesString(player));
+	player->OnModeStyleServicesChanged();
+	KZ::mode::ReplicateModeCvars(player);
+	player->optionService->SetPreference(KZ::pref::preferredStyles, styleManager.GetStylesString(player));
 	if (!silent)
 	{
 		player->languageService->PrintChat(true, false, "Styles Cleared");
@@ -508,7 +519,7 @@ SCMD(kz_clearstyles, SCFL_MODESTYLE)
 
 void KZOptionServiceEventListener_Styles::OnPlayerPreferencesLoaded(KZPlayer *player)
 {
-	const char *styles = player->optionService->GetPreferenceStr("preferredStyles", KZOptionService::GetOptionStr("defaultStyles"));
+	const char *styles = player->optionService->GetPreference(KZ::pref::preferredStyles, KZOptionService::GetConfig().defaultStyles.Get());
 	// Give up changing styles if the player is already in the server for a while.
 	if (player->telemetryService->GetTimeInServer() < 30.0f && !player->timerService->GetTimerRunning())
 	{
@@ -1,11 +1,269 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "kz_telemetry.h"
 #include "utils/simplecmds.h"
+#include "utils/ctimer.h"
 #include "kz/language/kz_language.h"
+#include "kz/option/kz_option.h"
+#include "kz/profiler/kz_profiler.h"
+#include "kz/timer/kz_timer.h"
 #include "sdk/usercmd.h"
 
+#include "tier0/memdbgon.h"
+
 #define AFK_THRESHOLD 30.0f
+// Larger gaps between command numbers are the player not being simulated (dead, spectating) rather than loss.
+#define MAX_USERCMD_GAP 64
+// Seconds until the snapshot interval is checked again while snapshots are disabled.
+#define SNAPSHOT_DISABLED_RECHECK_INTERVAL 5.0
+
 f64 KZTelemetryService::lastActiveCheckTime = 0.0f;
 
+static_global const u64 usercmdJitterBounds[KZ_TELEMETRY_HISTOGRAM_BUCKETS] = {250, 500, 1000, 2000, 4000, 8000, 16000, 32000, 64000, 128000};
+static_global const u64 usercmdsPerFrameBounds[KZ_TELEMETRY_HISTOGRAM_BUCKETS] = {1, 2, 3, 4, 5, 6, 8, 10, 16, 32};
+
+// Set while a snapshot is being written, a new one is skipped rather than queued if the disk is that slow.
+static_global std::atomic<bool> writingSnapshot;
+static_global std::thread snapshotWriter;
+
+static_global class KZTimerServiceEventListener_Telemetry : public KZTimerServiceEventListener
+{
+	virtual void OnTimerStartPost(KZPlayer *player, u32 courseGUID) override;
+	virtual void OnTimerEndPost(KZPlayer *player, u32 courseGUID, f32 time, u32 teleportsUsed) override;
+} timerEventListener;
+
+void KZTelemetryHistogram::Record(u64 value, const u64 (&bounds)[KZ_TELEMETRY_HISTOGRAM_BUCKETS])
+{
+	u32 bucket = 0;
+	while (bucket < KZ_TELEMETRY_HISTOGRAM_BUCKETS && value > bounds[bucket])
+	{
+		bucket++;
+	}
+	this->buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	this->count.fetch_add(1, std::memory_order_relaxed);
+	this->sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+void KZTelemetryHistogram::Reset()
+{
+	for (u32 i = 0; i < KZ_TELEMETRY_HISTOGRAM_BUCKETS + 1; i++)
+	{
+		this->buckets[i].store(0, std::memory_order_relaxed);
+	}
+	this->count.store(0, std::memory_order_relaxed);
+	this->sum.store(0, std::memory_order_relaxed);
+}
+
+struct HistogramSnapshot
+{
+	u64 buckets[KZ_TELEMETRY_HISTOGRAM_BUCKETS + 1];
+	u64 count;
+	u64 sum;
+};
+
+struct PlayerSnapshot
+{
+	u64 steamID64;
+#define DECLARE_COUNTER_SNAPSHOT(field, metric, help) u64 field;
+	KZ_TELEMETRY_COUNTERS(DECLARE_COUNTER_SNAPSHOT)
+#undef DECLARE_COUNTER_SNAPSHOT
+#define DECLARE_HISTOGRAM_SNAPSHOT(field, metric, help) HistogramSnapshot field;
+	KZ_TELEMETRY_HISTOGRAMS(DECLARE_HISTOGRAM_SNAPSHOT)
+#undef DECLARE_HISTOGRAM_SNAPSHOT
+};
+
+static_function void CopyHistogram(const KZTelemetryHistogram &histogram, HistogramSnapshot &out)
+{
+	for (u32 i = 0; i < KZ_TELEMETRY_HISTOGRAM_BUCKETS + 1; i++)
+	{
+		out.buckets[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+	}
+	out.count = histogram.count.load(std::memory_order_relaxed);
+	out.sum = histogram.sum.load(std::memory_order_relaxed);
+}
+
+static_function void AppendHistogram(std::string &out, const char *metric, u64 steamID64, const HistogramSnapshot &histogram,
+									 const u64 (&bounds)[KZ_TELEMETRY_HISTOGRAM_BUCKETS])
+{
+	char line[256];
+	u64 cumulative = 0;
+	for (u32 i = 0; i < KZ_TELEMETRY_HISTOGRAM_BUCKETS; i++)
+	{
+		cumulative += histogram.buckets[i];
+		V_snprintf(line, sizeof(line), "%s_bucket{steamid=\"%llu\",le=\"%llu\"} %llu\n", metric, steamID64, bounds[i], cumulative);
+		out += line;
+	}
+	cumulative += histogram.buckets[KZ_TELEMETRY_HISTOGRAM_BUCKETS];
+	V_snprintf(line, sizeof(line), "%s_bucket{steamid=\"%llu\",le=\"+Inf\"} %llu\n%s_sum{steamid=\"%llu\"} %llu\n%s_count{steamid=\"%llu\"} %llu\n",
+			   metric, steamID64, cumulative, metric, steamID64, histogram.sum, metric, steamID64, cumulative);
+	out += line;
+}
+
+// Runs on its own thread, only touches its arguments.
+static_function void WriteMetricsFile(std::vector<PlayerSnapshot> players, std::string serviceMetrics, std::string path)
+{
+	std::string out;
+	char line[256];
+
+#define APPEND_COUNTER(field, metric, help) \
+	out += "# HELP " metric " " help "\n# TYPE " metric " counter\n"; \
+	for (const PlayerSnapshot &player : players) \
+	{ \
+		V_snprintf(line, sizeof(line), metric "{steamid=\"%llu\"} %llu\n", player.steamID64, player.field); \
+		out += line; \
+	}
+	KZ_TELEMETRY_COUNTERS(APPEND_COUNTER)
+#undef APPEND_COUNTER
+
+#define APPEND_HISTOGRAM(field, metric, help) \
+	out += "# HELP " metric " " help "\n# TYPE " metric " histogram\n"; \
+	for (const PlayerSnapshot &player : players) \
+	{ \
+		AppendHistogram(out, metric, player.steamID64, player.field, field##Bounds); \
+	}
+	KZ_TELEMETRY_HISTOGRAMS(APPEND_HISTOGRAM)
+#undef APPEND_HISTOGRAM
+
+	out += serviceMetrics;
+
+	// Write to a temporary file first so scrapers never read a partial snapshot.
+	std::string tempPath = path + ".tmp";
+	FILE *file = fopen(tempPath.c_str(), "wb");
+	if (file)
+	{
+		bool written = fwrite(out.data(), 1, out.size(), file) == out.size();
+		fclose(file);
+		if (written)
+		{
+			remove(path.c_str());
+			rename(tempPath.c_str(), path.c_str());
+		}
+	}
+	writingSnapshot.store(false, std::memory_order_release);
+}
+
+static_function f64 SnapshotTimer()
+{
+	f64 interval = KZOptionService::GetConfig().telemetrySnapshotInterval;
+	if (interval <= 0.0)
+	{
+		return SNAPSHOT_DISABLED_RECHECK_INTERVAL;
+	}
+	KZTelemetryService::WriteSnapshot();
+	return MAX(interval, 1.0);
+}
+
+void KZTelemetryService::Init()
+{
+	KZTimerService::RegisterEventListener(&timerEventListener);
+	StartTimer(SnapshotTimer, SNAPSHOT_DISABLED_RECHECK_INTERVAL, true, true);
+}
+
+void KZTelemetryService::WriteSnapshot()
+{
+	if (writingSnapshot.exchange(true, std::memory_order_acquire))
+	{
+		return;
+	}
+	// The previous writer is done, joining it doesn't block.
+	if (snapshotWriter.joinable())
+	{
+		snapshotWriter.join();
+	}
+
+	std::vector<PlayerSnapshot> players;
+	for (u32 i = 0; i < MAXPLAYERS + 1; i++)
+	{
+		KZPlayer *player = g_pKZPlayerManager->ToPlayer(i);
+		if (!player->IsInGame() || player->IsFakeClient() || player->IsCSTV())
+		{
+			continue;
+		}
+		const KZTelemetryMetrics &metrics = player->telemetryService->metrics;
+		PlayerSnapshot &snapshot = players.emplace_back();
+		snapshot.steamID64 = player->GetSteamId64(false);
+#define COPY_COUNTER(field, metric, help) snapshot.field = metrics.field.load(std::memory_order_relaxed);
+		KZ_TELEMETRY_COUNTERS(COPY_COUNTER)
+#undef COPY_COUNTER
+#define COPY_HISTOGRAM(field, metric, help) CopyHistogram(metrics.field, snapshot.field);
+		KZ_TELEMETRY_HISTOGRAMS(COPY_HISTOGRAM)
+#undef COPY_HISTOGRAM
+	}
+
+	std::string serviceMetrics;
+	KZ::profiler::AppendMetrics(serviceMetrics);
+
+	char path[1024];
+	g_SMAPI->PathFormat(path, sizeof(path), "%s/addons/cs2kz/data/metrics.prom", g_SMAPI->GetBaseDir());
+	snapshotWriter = std::thread(WriteMetricsFile, std::move(players), std::move(serviceMetrics), std::string(path));
+}
+
+void KZTelemetryService::Cleanup()
+{
+	if (snapshotWriter.joinable())
+	{
+		snapshotWriter.join();
+	}
+}
+
+void KZTelemetryService::Reset()
+{
+#define RESET_COUNTER(field, metric, help) this->metrics.field.store(0, std::memory_order_relaxed);
+	KZ_TELEMETRY_COUNTERS(RESET_COUNTER)
+#undef RESET_COUNTER
+#define RESET_HISTOGRAM(field, metric, help) this->metrics.field.Reset();
+	KZ_TELEMETRY_HISTOGRAMS(RESET_HISTOGRAM)
+#undef RESET_HISTOGRAM
+	this->lastUsercmdArrival = {};
+	this->lastCommandNumber = -1;
+}
+
+void KZTelemetryService::OnProcessUsercmds(i32 numcmds)
+{
+	auto now = std::chrono::steady_clock::now();
+	if (this->lastUsercmdArrival != std::chrono::steady_clock::time_point {})
+	{
+		i64 interval = std::chrono::duration_cast<std::chrono::microseconds>(now - this->lastUsercmdArrival).count();
+		i64 expected = (i64)(numcmds * ENGINE_FIXED_TICK_INTERVAL * 1000000.0);
+		this->metrics.usercmdJitter.Record(interval > expected ? interval - expected : expected - interval, usercmdJitterBounds);
+	}
+	this->lastUsercmdArrival = now;
+	this->metrics.usercmdsPerFrame.Record(MAX(numcmds, 0), usercmdsPerFrameBounds);
+}
+
+void KZTelemetryService::OnSetupMove(i32 commandNumber)
+{
+	this->metrics.usercmds.fetch_add(1, std::memory_order_relaxed);
+	if (this->lastCommandNumber >= 0 && commandNumber > this->lastCommandNumber + 1 && commandNumber - this->lastCommandNumber <= MAX_USERCMD_GAP)
+	{
+		this->metrics.usercmdsLost.fetch_add(commandNumber - this->lastCommandNumber - 1, std::memory_order_relaxed);
+	}
+	this->lastCommandNumber = commandNumber;
+}
+
+void KZTelemetryService::OnJump()
+{
+	this->metrics.jumps.fetch_add(1, std::memory_order_relaxed);
+}
+
+void KZTelemetryService::OnTeleport()
+{
+	this->metrics.teleports.fetch_add(1, std::memory_order_relaxed);
+}
+
+void KZTimerServiceEventListener_Telemetry::OnTimerStartPost(KZPlayer *player, u32 courseGUID)
+{
+	player->telemetryService->metrics.runsStarted.fetch_add(1, std::memory_order_relaxed);
+}
+
+void KZTimerServiceEventListener_Telemetry::OnTimerEndPost(KZPlayer *player, u32 courseGUID, f32 time, u32 teleportsUsed)
+{
+	player->telemetryService->metrics.runsFinished.fetch_add(1, std::memory_order_relaxed);
+}
+
 void KZTelemetryService::OnPhysicsSimulatePost()
 {
 	// AFK check
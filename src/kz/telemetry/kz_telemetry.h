@@ -1,7 +1,58 @@
 #pragma once
+#include <atomic>
+#include <chrono>
 
 #include "kz/kz.h"
 
+// Bucket count of the telemetry histograms, not counting the implicit +Inf bucket.
+#define KZ_TELEMETRY_HISTOGRAM_BUCKETS 10
+
+/*
+	Per-player metrics, written to addons/cs2kz/data/metrics.prom in the Prometheus text format
+	every "telemetrySnapshotInterval" seconds.
+
+	Metrics only consist of relaxed atomics and histograms use fixed buckets, so recording never locks or allocates.
+	The main thread copies them into a snapshot and a separate thread formats and writes the file.
+*/
+
+// X(field, metric name, help)
+// clang-format off
+#define KZ_TELEMETRY_COUNTERS(X) \
+	X(teleports, "kz_player_teleports_total", "Teleports, including checkpoints, savelocs and respawns.") \
+	X(jumps, "kz_player_jumps_total", "Jumps.") \
+	X(runsStarted, "kz_player_runs_started_total", "Timer starts.") \
+	X(runsFinished, "kz_player_runs_finished_total", "Timer ends.") \
+	X(usercmds, "kz_player_usercmds_total", "Usercmds simulated.") \
+	X(usercmdsLost, "kz_player_usercmds_lost_total", "Usercmds that never arrived, going by gaps in the command numbers.")
+
+// X(field, metric name, help)
+#define KZ_TELEMETRY_HISTOGRAMS(X) \
+	X(usercmdJitter, "kz_player_usercmd_jitter_microseconds", "Difference between the time since the previous usercmd batch and the time the batch covers.") \
+	X(usercmdsPerFrame, "kz_player_usercmds_per_frame", "Usercmds simulated per frame, i.e. ticks processed for the player at once.")
+// clang-format on
+
+struct KZTelemetryHistogram
+{
+	std::atomic<u32> buckets[KZ_TELEMETRY_HISTOGRAM_BUCKETS + 1] {};
+	std::atomic<u64> count {};
+	std::atomic<u64> sum {};
+
+	// Bounds are the inclusive upper bounds of each bucket in increasing order, values above the last one go to +Inf.
+	void Record(u64 value, const u64 (&bounds)[KZ_TELEMETRY_HISTOGRAM_BUCKETS]);
+	void Reset();
+};
+
+struct KZTelemetryMetrics
+{
+#define DECLARE_TELEMETRY_COUNTER(field, metric, help) std::atomic<u64> field {};
+	KZ_TELEMETRY_COUNTERS(DECLARE_TELEMETRY_COUNTER)
+#undef DECLARE_TELEMETRY_COUNTER
+
+#define DECLARE_TELEMETRY_HISTOGRAM(field, metric, help) KZTelemetryHistogram field;
+	KZ_TELEMETRY_HISTOGRAMS(DECLARE_TELEMETRY_HISTOGRAM)
+#undef DECLARE_TELEMETRY_HISTOGRAM
+};
+
 class KZTelemetryService : public KZBaseService
 {
 public:
@@ -18,8 +69,20 @@ private:
 		f64 timeSpentInServer {};
 	} activeStats;
 
+	KZTelemetryMetrics metrics;
+	std::chrono::steady_clock::time_point lastUsercmdArrival {};
+	i32 lastCommandNumber = -1;
+
 public:
+	static void Init();
+	// Waits for a snapshot in progress to be written, called on unload.
+	static void Cleanup();
 	static void ActiveCheck();
+	// Copy every player's metrics and write them to the metrics file on another thread.
+	static void WriteSnapshot();
+
+	// Only clears the metrics, the active stats are kept.
+	virtual void Reset() override;
 
 	f64 GetActiveTime() const
 	{
@@ -41,5 +104,16 @@ public:
 		return activeStats.timeSpentInServer;
 	}
 
+	const KZTelemetryMetrics &GetMetrics() const
+	{
+		return metrics;
+	}
+
 	void OnPhysicsSimulatePost();
+	void OnProcessUsercmds(i32 numcmds);
+	void OnSetupMove(i32 commandNumber);
+	void OnJump();
+	void OnTeleport();
+
+	friend class KZTimerServiceEventListener_Telemetry;
 };
@@ -96,6 +96,10 @@ RecordAnnounce::RecordAnnounce(KZPlayer *player)
 
 	// Metadata
 	this->metadata = player->timerService->GetCurrentRunMetadata().Get();
+	if (global)
+	{
+		this->globalMetadata = player->timerService->GetCurrentRunMetadataJSON().Get();
+	}
 
 	// Previous GPBs
 	if (global)
@@ -152,7 +156,7 @@ void RecordAnnounce::SubmitGlobal()
 
 	// Dirty hack since nested forward declaration isn't possible.
 	KZGlobalService::SubmitRecordResult submissionResult = player->globalService->SubmitRecord(
-		this->globalFilterID, this->time, this->teleports, this->mode.md5, (void *)(&this->styles), this->metadata.c_str(), callback);
+		this->globalFilterID, this->time, this->teleports, this->mode.md5, (void *)(&this->styles), this->globalMetadata.c_str(), callback);
 
 	switch (submissionResult)
 	{
@@ -67,6 +67,7 @@ struct RecordAnnounce
 	u64 styleIDs {};
 
 	std::string metadata;
+	std::string globalMetadata;
 
 	bool global {};
 
@@ -10,6 +10,7 @@
 #include "kz/trigger/kz_trigger.h"
 #include "kz/spec/kz_spec.h"
 #include "announce.h"
+#include "run_metadata.h"
 
 #include "utils/utils.h"
 #include "utils/simplecmds.h"
@@ -73,8 +74,8 @@ static_global class KZOptionServiceEventListener_Timer : public KZOptionServiceE
 	}
 } optionEventListener;
 
-std::unordered_map<PBDataKey, PBData> KZTimerService::srCache;
-std::unordered_map<PBDataKey, PBData> KZTimerService::wrCache;
+PBDataCache KZTimerService::srCache;
+PBDataCache KZTimerService::wrCache;
 
 static_global CUtlVector<KZTimerServiceEventListener *> eventListeners;
 
@@ -122,6 +123,11 @@ void KZTimerService::SplitZoneStartTouch(const KZCourseDescriptor *course, i32 s
 		this->splitZoneTimes[splitNumber - 1] = this->GetTime();
 		this->ShowSplitText(splitNumber);
 		this->lastSplit = splitNumber;
+
+		FOR_EACH_VEC(eventListeners, i)
+		{
+			eventListeners[i]->OnSplitZoneReached(this->player, course->guid, splitNumber);
+		}
 	}
 }
 
@@ -141,6 +147,11 @@ void KZTimerService::CheckpointZoneStartTouch(const KZCourseDescriptor *course,
 		this->ShowCheckpointText(cpNumber);
 		this->lastCheckpoint = cpNumber;
 		this->reachedCheckpoints++;
+
+		FOR_EACH_VEC(eventListeners, i)
+		{
+			eventListeners[i]->OnCheckpointZoneReached(this->player, course->guid, cpNumber);
+		}
 	}
 }
 
@@ -166,6 +177,11 @@ void KZTimerService::StageZoneStartTouch(const KZCourseDescriptor *course, i32 s
 		this->PlayReachedStageSound();
 		this->ShowStageText();
 		this->currentStage++;
+
+		FOR_EACH_VEC(eventListeners, i)
+		{
+			eventListeners[i]->OnStageZoneReached(this->player, course->guid, stageNumber);
+		}
 	}
 }
 
@@ -203,19 +219,7 @@ bool KZTimerService::TimerStart(const KZCourseDescriptor *courseDesc, bool playS
 
 	this->currentTime = 0.0f;
 	this->timerRunning = true;
-	this->currentStage = 0;
-	this->reachedCheckpoints = 0;
-	this->lastCheckpoint = 0;
-	this->lastSplit = 0;
-
-	f64 invalidTime = -1;
-	this->splitZoneTimes.SetSize(courseDesc->splitCount);
-	this->cpZoneTimes.SetSize(courseDesc->checkpointCount);
-	this->stageZoneTimes.SetSize(courseDesc->checkpointCount);
-
-	this->splitZoneTimes.FillWithValue(invalidTime);
-	this->cpZoneTimes.FillWithValue(invalidTime);
-	this->stageZoneTimes.FillWithValue(invalidTime);
+	this->ResetZoneTimes(courseDesc);
 
 	SetCourse(courseDesc->guid);
 	this->validTime = true;
@@ -249,6 +253,38 @@ bool KZTimerService::TimerStart(const KZCourseDescriptor *courseDesc, bool playS
 	return true;
 }
 
+void KZTimerService::ResetZoneTimes(const KZCourseDescriptor *courseDesc)
+{
+	this->currentStage = 0;
+	this->reachedCheckpoints = 0;
+	this->lastCheckpoint = 0;
+	this->lastSplit = 0;
+
+	f64 invalidTime = -1;
+	this->splitZoneTimes.SetSize(courseDesc->splitCount);
+	this->cpZoneTimes.SetSize(courseDesc->checkpointCount);
+	this->stageZoneTimes.SetSize(courseDesc->stageCount);
+
+	this->splitZoneTimes.FillWithValue(invalidTime);
+	this->cpZoneTimes.FillWithValue(invalidTime);
+	this->stageZoneTimes.FillWithValue(invalidTime);
+}
+
+void KZTimerService::ContinueRun(const KZCourseDescriptor *courseDesc, f64 time)
+{
+	if (!this->timerRunning || courseDesc->guid != this->currentCourseGUID)
+	{
+		this->ResetZoneTimes(courseDesc);
+		SetCourse(courseDesc->guid);
+		// Never valid to begin with, no need to notify anyone about the invalidation.
+		this->validTime = false;
+		this->UpdateCurrentCompareType(ToPBDataKey(KZ::mode::GetModeInfo(this->player->modeService).id, courseDesc->guid));
+	}
+	this->currentTime = time;
+	this->timerRunning = true;
+	this->InvalidateRun();
+}
+
 bool KZTimerService::TimerEnd(const KZCourseDescriptor *courseDesc)
 {
 	if (!this->player->IsAlive())
@@ -878,7 +914,7 @@ void KZTimerService::SetCompareTarget(const char *typeString)
 		}
 	}
 	this->preferredCompareType = type;
-	this->player->optionService->SetPreferenceInt("preferredCompareType", this->preferredCompareType);
+	this->player->optionService->SetPreference(KZ::pref::preferredCompareType, this->preferredCompareType);
 	if (this->GetCourse())
 	{
 		this->UpdateCurrentCompareType(ToPBDataKey(KZ::mode::GetModeInfo(this->player->modeService).id, this->GetCourse()->guid));
@@ -889,9 +925,11 @@ void KZTimerService::UpdateCurrentCompareType(PBDataKey key)
 {
 	for (u8 type = this->preferredCompareType; type > COMPARE_NONE; type--)
 	{
-		if (this->GetCompareTargetForType((CompareType)type, key))
+		const PBData *pb = this->GetCompareTargetForType((CompareType)type, key);
+		if (pb)
 		{
 			this->currentCompareType = (CompareType)type;
+			this->compareTarget = *pb;
 			return;
 		}
 	}
@@ -904,75 +942,19 @@ const PBData *KZTimerService::GetCompareTargetForType(CompareType type, PBDataKe
 	{
 		case COMPARE_WR:
 		{
-			if (KZTimerService::wrCache.find(key) != KZTimerService::wrCache.end())
-			{
-				return &KZTimerService::wrCache[key];
-			}
-			break;
-		}
-		case COMPARE_SR:
-		{
-			if (KZTimerService::srCache.find(key) != KZTimerService::srCache.end())
-			{
-				return &KZTimerService::srCache[key];
-			}
-			break;
-		}
-		case COMPARE_GPB:
-		{
-			if (KZTimerService::globalPBCache.find(key) != KZTimerService::globalPBCache.end())
-			{
-				return &this->globalPBCache[key];
-			}
-			break;
-		}
-		case COMPARE_SPB:
-		{
-			if (KZTimerService::localPBCache.find(key) != KZTimerService::localPBCache.end())
-			{
-				return &this->localPBCache[key];
-			}
-			break;
-		}
-	}
-	return nullptr;
-}
-
-const PBData *KZTimerService::GetCompareTarget(PBDataKey key)
-{
-	switch (this->currentCompareType)
-	{
-		case COMPARE_WR:
-		{
-			if (KZTimerService::wrCache.find(key) != KZTimerService::wrCache.end())
-			{
-				return &KZTimerService::wrCache[key];
-			}
-			break;
+			return KZTimerService::wrCache.Find(key);
 		}
 		case COMPARE_SR:
 		{
-			if (KZTimerService::srCache.find(key) != KZTimerService::srCache.end())
-			{
-				return &KZTimerService::srCache[key];
-			}
-			break;
+			return KZTimerService::srCache.Find(key);
 		}
 		case COMPARE_GPB:
 		{
-			if (KZTimerService::globalPBCache.find(key) != KZTimerService::globalPBCache.end())
-			{
-				return &this->globalPBCache[key];
-			}
-			break;
+			return this->globalPBCache.Find(key);
 		}
 		case COMPARE_SPB:
 		{
-			if (KZTimerService::localPBCache.find(key) != KZTimerService::localPBCache.end())
-			{
-				return &this->localPBCache[key];
-			}
-			break;
+			return this->localPBCache.Find(key);
 		}
 	}
 	return nullptr;
@@ -980,8 +962,8 @@ const PBData *KZTimerService::GetCompareTarget(PBDataKey key)
 
 void KZTimerService::ClearRecordCache()
 {
-	KZTimerService::srCache.clear();
-	KZTimerService::wrCache.clear();
+	KZTimerService::srCache.Clear();
+	KZTimerService::wrCache.Clear();
 }
 
 void KZTimerService::UpdateLocalRecordCache()
@@ -1028,151 +1010,49 @@ void KZTimerService::UpdateLocalRecordCache()
 	KZDatabaseService::QueryAllRecords(g_pKZUtils->GetCurrentMapName(), onQuerySuccess, KZDatabaseService::OnGenericTxnFailure);
 }
 
-void KZTimerService::InsertRecordToCache(f64 time, const KZCourseDescriptor *course, PluginId modeID, bool overall, bool global, CUtlString metadata)
+void PBData::RunData::SetZoneTimes(const CUtlString &metadata)
 {
-	PBData &pb = global ? KZTimerService::wrCache[ToPBDataKey(modeID, course->guid)] : KZTimerService::srCache[ToPBDataKey(modeID, course->guid)];
-
-	overall ? pb.overall.pbTime = time : pb.pro.pbTime = time;
-	KeyValues3 kv(KV3_TYPEEX_TABLE, KV3_SUBTYPE_UNSPECIFIED);
-	CUtlString error = "";
 	if (metadata.IsEmpty())
 	{
 		return;
 	}
-	LoadKV3FromJSON(&kv, &error, metadata.Get(), "");
-	if (!error.IsEmpty())
+	if (!KZ::runmetadata::Decode(metadata.Get(), this->zoneTimes, this->splitCount, this->cpCount, this->stageCount))
 	{
-		META_CONPRINTF("[KZ::Timer] Failed to insert PB to cache due to metadata error: %s\n", error.Get());
-		return;
-	}
-
-	KeyValues3 *data = kv.FindMember("splitZoneTimes");
-	if (data && data->GetType() == KV3_TYPE_ARRAY)
-	{
-		for (i32 i = 0; i < course->splitCount; i++)
-		{
-			f64 time = -1.0f;
-			KeyValues3 *element = data->GetArrayElement(i);
-			if (element)
-			{
-				time = element->GetDouble(-1.0);
-			}
-			overall ? pb.overall.pbSplitZoneTimes[i] = time : pb.pro.pbSplitZoneTimes[i] = time;
-		}
+		this->zoneTimes.clear();
+		this->splitCount = this->cpCount = this->stageCount = 0;
 	}
+}
 
-	data = kv.FindMember("cpZoneTimes");
-	if (data && data->GetType() == KV3_TYPE_ARRAY)
-	{
-		for (i32 i = 0; i < course->checkpointCount; i++)
-		{
-			f64 time = -1.0f;
-			KeyValues3 *element = data->GetArrayElement(i);
-			if (element)
-			{
-				time = element->GetDouble(-1.0);
-			}
-			overall ? pb.overall.pbCpZoneTimes[i] = time : pb.pro.pbCpZoneTimes[i] = time;
-		}
-	}
+void KZTimerService::InsertRecordToCache(f64 time, const KZCourseDescriptor *course, PluginId modeID, bool overall, bool global, CUtlString metadata)
+{
+	PBDataCache &cache = global ? KZTimerService::wrCache : KZTimerService::srCache;
+	PBData &pb = cache.FindOrInsert(ToPBDataKey(modeID, course->guid));
+	PBData::RunData &run = overall ? pb.overall : pb.pro;
 
-	data = kv.FindMember("stageZoneTimes");
-	if (data && data->GetType() == KV3_TYPE_ARRAY)
-	{
-		for (i32 i = 0; i < course->stageCount; i++)
-		{
-			f64 time = -1.0f;
-			KeyValues3 *element = data->GetArrayElement(i);
-			if (element)
-			{
-				time = element->GetDouble(-1.0);
-			}
-			overall ? pb.overall.pbStageZoneTimes[i] = time : pb.pro.pbStageZoneTimes[i] = time;
-		}
-	}
+	run.pbTime = time;
+	run.SetZoneTimes(metadata);
 }
 
 void KZTimerService::ClearPBCache()
 {
-	this->localPBCache.clear();
+	this->localPBCache.Clear();
 }
 
 const PBData *KZTimerService::GetGlobalCachedPB(const KZCourseDescriptor *course, PluginId modeID)
 {
-	PBDataKey key = ToPBDataKey(modeID, course->guid);
-
-	if (this->globalPBCache.find(key) == this->globalPBCache.end())
-	{
-		return nullptr;
-	}
-
-	return &this->globalPBCache[key];
+	return this->globalPBCache.Find(ToPBDataKey(modeID, course->guid));
 }
 
 void KZTimerService::InsertPBToCache(f64 time, const KZCourseDescriptor *course, PluginId modeID, bool overall, bool global, CUtlString metadata,
 									 f64 points)
 {
-	PBData &pb = global ? this->globalPBCache[ToPBDataKey(modeID, course->guid)] : this->localPBCache[ToPBDataKey(modeID, course->guid)];
-
-	overall ? pb.overall.points = points : pb.pro.points = points;
-	overall ? pb.overall.pbTime = time : pb.pro.pbTime = time;
-	KeyValues3 kv(KV3_TYPEEX_TABLE, KV3_SUBTYPE_UNSPECIFIED);
-	CUtlString error = "";
-	if (metadata.IsEmpty())
-	{
-		return;
-	}
-	LoadKV3FromJSON(&kv, &error, metadata.Get(), "");
-	if (!error.IsEmpty())
-	{
-		META_CONPRINTF("[KZ::Timer] Failed to insert server record to cache due to metadata error: %s\n", error.Get());
-		return;
-	}
-
-	KeyValues3 *data = kv.FindMember("splitZoneTimes");
-	if (data && data->GetType() == KV3_TYPE_ARRAY)
-	{
-		for (i32 i = 0; i < course->splitCount; i++)
-		{
-			f64 time = -1.0f;
-			KeyValues3 *element = data->GetArrayElement(i);
-			if (element)
-			{
-				time = element->GetDouble(-1.0);
-			}
-			overall ? pb.overall.pbSplitZoneTimes[i] = time : pb.pro.pbSplitZoneTimes[i] = time;
-		}
-	}
+	PBDataCache &cache = global ? this->globalPBCache : this->localPBCache;
+	PBData &pb = cache.FindOrInsert(ToPBDataKey(modeID, course->guid));
+	PBData::RunData &run = overall ? pb.overall : pb.pro;
 
-	data = kv.FindMember("cpZoneTimes");
-	if (data && data->GetType() == KV3_TYPE_ARRAY)
-	{
-		for (i32 i = 0; i < course->checkpointCount; i++)
-		{
-			f64 time = -1.0f;
-			KeyValues3 *element = data->GetArrayElement(i);
-			if (element)
-			{
-				time = element->GetDouble(-1.0);
-			}
-			overall ? pb.overall.pbCpZoneTimes[i] = time : pb.pro.pbCpZoneTimes[i] = time;
-		}
-	}
-
-	data = kv.FindMember("stageZoneTimes");
-	if (data && data->GetType() == KV3_TYPE_ARRAY)
-	{
-		for (i32 i = 0; i < course->stageCount; i++)
-		{
-			f64 time = -1.0f;
-			KeyValues3 *element = data->GetArrayElement(i);
-			if (element)
-			{
-				time = element->GetDouble(-1.0);
-			}
-			overall ? pb.overall.pbStageZoneTimes[i] = time : pb.pro.pbStageZoneTimes[i] = time;
-		}
-	}
+	run.points = points;
+	run.pbTime = time;
+	run.SetZoneTimes(metadata);
 }
 
 void KZTimerService::CheckMissedTime()
@@ -1192,12 +1072,8 @@ void KZTimerService::CheckMissedTime()
 	{
 		this->shouldAnnounceMissedProTime = false;
 	}
-	auto modeInfo = KZ::mode::GetModeInfo(this->player->modeService->GetModeName());
-
-	PBDataKey key = ToPBDataKey(modeInfo.id, course->guid);
-
 	// Check if there is personal best data for this mode and course.
-	auto pb = this->GetCompareTarget(key);
+	auto pb = this->GetCompareTarget();
 	if (!pb)
 	{
 		return;
@@ -1255,24 +1131,20 @@ void KZTimerService::ShowSplitText(u32 currentSplit)
 		time.Append(splitTime.Get());
 	}
 
-	auto modeInfo = KZ::mode::GetModeInfo(this->player->modeService->GetModeName());
-	PBDataKey key = ToPBDataKey(modeInfo.id, course->guid);
-
 	// Check if there is personal best data for this mode and course.
-	const PBData *pb = this->GetCompareTarget(key);
+	const PBData *pb = this->GetCompareTarget();
 	if (pb)
 	{
-		if (pb->overall.pbSplitZoneTimes[currentSplit - 1] > 0)
+		if (pb->overall.GetSplitZoneTime(currentSplit - 1) > 0)
 		{
-			META_CONPRINTF("pb->overall.pbSplitZoneTimes[currentSplit - 1] = %lf\n", pb->overall.pbSplitZoneTimes[currentSplit - 1]);
-			f64 diff = this->splitZoneTimes[currentSplit - 1] - pb->overall.pbSplitZoneTimes[currentSplit - 1];
+			f64 diff = this->splitZoneTimes[currentSplit - 1] - pb->overall.GetSplitZoneTime(currentSplit - 1);
 			CUtlString diffText = KZTimerService::FormatDiffTime(diff);
 			diffText.Format("{grey}%s%s{grey}", diff < 0 ? "{green}" : "{lightred}", diffText.Get());
 			pbDiff = this->player->languageService->PrepareMessage(diffTextKeys[this->currentCompareType], diffText.Get());
 		}
-		if (this->player->checkpointService->GetTeleportCount() == 0 && pb->pro.pbTime > 0 && pb->pro.pbSplitZoneTimes[currentSplit - 1] > 0)
+		if (this->player->checkpointService->GetTeleportCount() == 0 && pb->pro.pbTime > 0 && pb->pro.GetSplitZoneTime(currentSplit - 1) > 0)
 		{
-			f64 diff = this->splitZoneTimes[currentSplit - 1] - pb->pro.pbSplitZoneTimes[currentSplit - 1];
+			f64 diff = this->splitZoneTimes[currentSplit - 1] - pb->pro.GetSplitZoneTime(currentSplit - 1);
 			CUtlString diffText = KZTimerService::FormatDiffTime(diff);
 			diffText.Format("{grey}%s%s{grey}", diff < 0 ? "{green}" : "{lightred}", diffText.Get());
 			pbDiffPro = this->player->languageService->PrepareMessage(diffTextKeysPro[this->currentCompareType], diffText.Get());
@@ -1308,23 +1180,20 @@ void KZTimerService::ShowCheckpointText(u32 currentCheckpoint)
 		time.Append(splitTime.Get());
 	}
 
-	auto modeInfo = KZ::mode::GetModeInfo(this->player->modeService->GetModeName());
-	PBDataKey key = ToPBDataKey(modeInfo.id, course->guid);
-
 	// Check if there is personal best data for this mode and course.
-	const PBData *pb = this->GetCompareTarget(key);
+	const PBData *pb = this->GetCompareTarget();
 	if (pb)
 	{
-		if (pb->overall.pbCpZoneTimes[currentCheckpoint - 1] > 0)
+		if (pb->overall.GetCpZoneTime(currentCheckpoint - 1) > 0)
 		{
-			f64 diff = this->cpZoneTimes[currentCheckpoint - 1] - pb->overall.pbCpZoneTimes[currentCheckpoint - 1];
+			f64 diff = this->cpZoneTimes[currentCheckpoint - 1] - pb->overall.GetCpZoneTime(currentCheckpoint - 1);
 			CUtlString diffText = KZTimerService::FormatDiffTime(diff);
 			diffText.Format("{grey}%s%s{grey}", diff < 0 ? "{green}" : "{lightred}", diffText.Get());
 			pbDiff = this->player->languageService->PrepareMessage(diffTextKeys[this->currentCompareType], diffText.Get());
 		}
-		if (this->player->checkpointService->GetTeleportCount() == 0 && pb->pro.pbTime > 0 && pb->pro.pbCpZoneTimes[currentCheckpoint - 1] > 0)
+		if (this->player->checkpointService->GetTeleportCount() == 0 && pb->pro.pbTime > 0 && pb->pro.GetCpZoneTime(currentCheckpoint - 1) > 0)
 		{
-			f64 diff = this->cpZoneTimes[currentCheckpoint - 1] - pb->pro.pbCpZoneTimes[currentCheckpoint - 1];
+			f64 diff = this->cpZoneTimes[currentCheckpoint - 1] - pb->pro.GetCpZoneTime(currentCheckpoint - 1);
 			CUtlString diffText = KZTimerService::FormatDiffTime(diff);
 			diffText.Format("{grey}%s%s{grey}", diff < 0 ? "{green}" : "{lightred}", diffText.Get());
 			pbDiffPro = this->player->languageService->PrepareMessage(diffTextKeysPro[this->currentCompareType], diffText.Get());
@@ -1361,23 +1230,20 @@ void KZTimerService::ShowStageText()
 		time.Append(splitTime.Get());
 	}
 
-	auto modeInfo = KZ::mode::GetModeInfo(this->player->modeService->GetModeName());
-	PBDataKey key = ToPBDataKey(modeInfo.id, course->guid);
-
 	// Check if there is personal best data for this mode and course.
-	const PBData *pb = this->GetCompareTarget(key);
+	const PBData *pb = this->GetCompareTarget();
 	if (pb)
 	{
-		if (pb->overall.pbStageZoneTimes[this->currentStage] > 0)
+		if (pb->overall.GetStageZoneTime(this->currentStage) > 0)
 		{
-			f64 diff = this->stageZoneTimes[this->currentStage] - pb->overall.pbStageZoneTimes[this->currentStage];
+			f64 diff = this->stageZoneTimes[this->currentStage] - pb->overall.GetStageZoneTime(this->currentStage);
 			CUtlString diffText = KZTimerService::FormatDiffTime(diff);
 			diffText.Format("{grey}%s%s{grey}", diff < 0 ? "{green}" : "{lightred}", diffText.Get());
 			pbDiff = this->player->languageService->PrepareMessage(diffTextKeys[this->currentCompareType], diffText.Get());
 		}
-		if (this->player->checkpointService->GetTeleportCount() == 0 && pb->pro.pbTime > 0 && pb->pro.pbStageZoneTimes[this->currentStage] > 0)
+		if (this->player->checkpointService->GetTeleportCount() == 0 && pb->pro.pbTime > 0 && pb->pro.GetStageZoneTime(this->currentStage) > 0)
 		{
-			f64 diff = this->stageZoneTimes[this->currentStage] - pb->pro.pbStageZoneTimes[this->currentStage];
+			f64 diff = this->stageZoneTimes[this->currentStage] - pb->pro.GetStageZoneTime(this->currentStage);
 			CUtlString diffText = KZTimerService::FormatDiffTime(diff);
 			diffText.Format("{grey}%s%s{grey}", diff < 0 ? "{green}" : "{lightred}", diffText.Get());
 			pbDiffPro = this->player->languageService->PrepareMessage(diffTextKeysPro[this->currentCompareType], diffText.Get());
@@ -1389,6 +1255,13 @@ void KZTimerService::ShowStageText()
 }
 
 CUtlString KZTimerService::GetCurrentRunMetadata()
+{
+	return KZ::runmetadata::Encode(this->splitZoneTimes.Base(), this->splitZoneTimes.Count(), this->cpZoneTimes.Base(), this->cpZoneTimes.Count(),
+								   this->stageZoneTimes.Base(), this->stageZoneTimes.Count())
+		.c_str();
+}
+
+CUtlString KZTimerService::GetCurrentRunMetadataJSON()
 {
 	KeyValues3 kv(KV3_TYPEEX_TABLE, KV3_SUBTYPE_UNSPECIFIED);
 
@@ -1486,12 +1359,12 @@ void KZTimerService::Init()
 
 void KZTimerService::OnPlayerPreferencesLoaded()
 {
-	if (this->player->optionService->GetPreferenceInt("preferredCompareType", COMPARE_GPB) > COMPARETYPE_COUNT)
+	if (this->player->optionService->GetPreference(KZ::pref::preferredCompareType, COMPARE_GPB) > COMPARETYPE_COUNT)
 	{
 		this->preferredCompareType = COMPARE_GPB;
 		return;
 	}
-	this->preferredCompareType = (CompareType)this->player->optionService->GetPreferenceInt("preferredCompareType", COMPARE_GPB);
+	this->preferredCompareType = (CompareType)this->player->optionService->GetPreference(KZ::pref::preferredCompareType, COMPARE_GPB);
 }
 
 void KZDatabaseServiceEventListener_Timer::OnMapSetup()
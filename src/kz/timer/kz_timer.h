@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <vector>
 
 #include "../kz.h"
 #include "../checkpoint/kz_checkpoint.h"
@@ -23,30 +25,33 @@
 
 struct PBData
 {
-	PBData()
-	{
-		Reset();
-	}
-
-	void Reset()
-	{
-		overall.pbTime = {};
-		overall.pbSplitZoneTimes.FillWithValue(-1.0);
-		overall.pbCpZoneTimes.FillWithValue(-1.0);
-		overall.pbStageZoneTimes.FillWithValue(-1.0);
-		pro.pbTime = {};
-		pro.pbSplitZoneTimes.FillWithValue(-1.0);
-		pro.pbCpZoneTimes.FillWithValue(-1.0);
-		pro.pbStageZoneTimes.FillWithValue(-1.0);
-	}
-
-	struct
+	struct RunData
 	{
 		f64 pbTime {};
 		f64 points {};
-		CUtlVectorFixed<f64, KZ_MAX_SPLIT_ZONES> pbSplitZoneTimes;
-		CUtlVectorFixed<f64, KZ_MAX_CHECKPOINT_ZONES> pbCpZoneTimes;
-		CUtlVectorFixed<f64, KZ_MAX_STAGE_ZONES> pbStageZoneTimes;
+		// Split, checkpoint then stage zone times, only as many as the course has zones. Negative if the zone wasn't reached.
+		std::vector<f64> zoneTimes;
+		u8 splitCount {};
+		u8 cpCount {};
+		u8 stageCount {};
+
+		f64 GetSplitZoneTime(u32 index) const
+		{
+			return index < splitCount ? zoneTimes[index] : -1.0;
+		}
+
+		f64 GetCpZoneTime(u32 index) const
+		{
+			return index < cpCount ? zoneTimes[splitCount + index] : -1.0;
+		}
+
+		f64 GetStageZoneTime(u32 index) const
+		{
+			return index < stageCount ? zoneTimes[splitCount + cpCount + index] : -1.0;
+		}
+
+		// Decodes the zone times out of a run's metadata, see run_metadata.h.
+		void SetZoneTimes(const CUtlString &metadata);
 	} overall, pro;
 };
 
@@ -70,6 +75,52 @@ inline void ConvertFromPBDataKey(PBDataKey key, uint32_t *modeID, uint32_t *cour
 	}
 }
 
+// PB data per mode and course, kept sorted by key in one contiguous array.
+class PBDataCache
+{
+public:
+	const PBData *Find(PBDataKey key) const
+	{
+		auto it = LowerBound(key);
+		return it != entries.end() && it->key == key ? &it->data : nullptr;
+	}
+
+	// The returned reference is only valid until the next insertion.
+	PBData &FindOrInsert(PBDataKey key)
+	{
+		auto it = LowerBound(key);
+		if (it == entries.end() || it->key != key)
+		{
+			it = entries.insert(it, {key, {}});
+		}
+		return it->data;
+	}
+
+	void Clear()
+	{
+		entries.clear();
+	}
+
+private:
+	struct Entry
+	{
+		PBDataKey key;
+		PBData data;
+	};
+
+	std::vector<Entry> entries;
+
+	std::vector<Entry>::iterator LowerBound(PBDataKey key)
+	{
+		return std::lower_bound(entries.begin(), entries.end(), key, [](const Entry &entry, PBDataKey key) { return entry.key < key; });
+	}
+
+	std::vector<Entry>::const_iterator LowerBound(PBDataKey key) const
+	{
+		return std::lower_bound(entries.begin(), entries.end(), key, [](const Entry &entry, PBDataKey key) { return entry.key < key; });
+	}
+};
+
 class KZTimerServiceEventListener
 {
 public:
@@ -80,6 +131,13 @@ public:
 
 	virtual void OnTimerStartPost(KZPlayer *player, u32 courseGUID) {}
 
+	// Only called the first time a zone is reached during a run.
+	virtual void OnSplitZoneReached(KZPlayer *player, u32 courseGUID, i32 splitNumber) {}
+
+	virtual void OnCheckpointZoneReached(KZPlayer *player, u32 courseGUID, i32 cpNumber) {}
+
+	virtual void OnStageZoneReached(KZPlayer *player, u32 courseGUID, i32 stageNumber) {}
+
 	virtual bool OnTimerEnd(KZPlayer *player, u32 courseGUID, f32 time, u32 teleportsUsed)
 	{
 		return true;
@@ -131,13 +189,13 @@ private:
 	CUtlVectorFixed<f64, KZ_MAX_STAGE_ZONES> stageZoneTimes {};
 
 	// PB cache per mode and per course.
-	std::unordered_map<PBDataKey, PBData> localPBCache;
-	std::unordered_map<PBDataKey, PBData> globalPBCache;
+	PBDataCache localPBCache;
+	PBDataCache globalPBCache;
 
 	// SR cache should be loaded upon map start, every time !wr is queried and every time a run beats the server record.
-	static std::unordered_map<PBDataKey, PBData> srCache;
+	static PBDataCache srCache;
 
-	static std::unordered_map<PBDataKey, PBData> wrCache;
+	static PBDataCache wrCache;
 
 public:
 	enum CompareType : u8
@@ -159,10 +217,16 @@ private:
 	// What we are currently comparing our run against in this current run.
 	// This stays the same from the start of the run (unless preferredCompareType changes) to have a consistent comparison across the run.
 	CompareType currentCompareType = COMPARE_GPB;
+	// Copy of the compare target's data taken along with currentCompareType, so splits don't need any lookup.
+	PBData compareTarget;
 
 	void UpdateCurrentCompareType(PBDataKey key);
 	const PBData *GetCompareTargetForType(CompareType type, PBDataKey key);
-	const PBData *GetCompareTarget(PBDataKey key);
+
+	const PBData *GetCompareTarget()
+	{
+		return this->currentCompareType != COMPARE_NONE ? &this->compareTarget : nullptr;
+	}
 
 	bool shouldAnnounceMissedTime = true;
 	bool shouldAnnounceMissedProTime = true;
@@ -186,7 +250,10 @@ public:
 	void ShowCheckpointText(u32 currentCheckpoint);
 	void ShowStageText();
 
+	// Compact encoding stored in the local database.
 	CUtlString GetCurrentRunMetadata();
+	// JSON encoding sent to the global API.
+	CUtlString GetCurrentRunMetadataJSON();
 
 private:
 	bool validJump {};
@@ -290,8 +357,11 @@ public:
 
 	// To be used for saveloc.
 	void InvalidateRun();
+	// Resume a run on the course at the given time, the run is invalidated.
+	void ContinueRun(const KZCourseDescriptor *course, f64 time);
 
 private:
+	void ResetZoneTimes(const KZCourseDescriptor *course);
 	bool HasValidMoveType();
 
 	static bool IsValidMoveType(MoveType_t moveType)
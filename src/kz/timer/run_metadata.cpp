@@ -0,0 +1,177 @@
+#include "run_metadata.h"
+#include "keyvalues3.h"
+
+#include "tier0/memdbgon.h"
+
+#define RUN_METADATA_VERSION     1
+#define RUN_METADATA_HEADER_SIZE 4
+
+static_global const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static_function i32 Base64Value(char c)
+{
+	if (c >= 'A' && c <= 'Z')
+	{
+		return c - 'A';
+	}
+	if (c >= 'a' && c <= 'z')
+	{
+		return c - 'a' + 26;
+	}
+	if (c >= '0' && c <= '9')
+	{
+		return c - '0' + 52;
+	}
+	if (c == '+')
+	{
+		return 62;
+	}
+	if (c == '/')
+	{
+		return 63;
+	}
+	return -1;
+}
+
+static_function void Base64Encode(const u8 *data, size_t length, std::string &out)
+{
+	out.reserve(out.size() + (length + 2) / 3 * 4);
+	size_t i = 0;
+	for (; i + 2 < length; i += 3)
+	{
+		u32 triple = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+		out += base64Chars[(triple >> 18) & 63];
+		out += base64Chars[(triple >> 12) & 63];
+		out += base64Chars[(triple >> 6) & 63];
+		out += base64Chars[triple & 63];
+	}
+	if (i < length)
+	{
+		u32 triple = data[i] << 16;
+		if (i + 1 < length)
+		{
+			triple |= data[i + 1] << 8;
+		}
+		out += base64Chars[(triple >> 18) & 63];
+		out += base64Chars[(triple >> 12) & 63];
+		out += i + 1 < length ? base64Chars[(triple >> 6) & 63] : '=';
+		out += '=';
+	}
+}
+
+static_function bool Base64Decode(const char *text, std::vector<u8> &out)
+{
+	out.clear();
+	u32 buffer = 0;
+	i32 bits = 0;
+	for (const char *c = text; *c && *c != '='; c++)
+	{
+		i32 value = Base64Value(*c);
+		if (value < 0)
+		{
+			return false;
+		}
+		buffer = (buffer << 6) | value;
+		bits += 6;
+		if (bits >= 8)
+		{
+			bits -= 8;
+			out.push_back((buffer >> bits) & 0xFF);
+		}
+	}
+	return true;
+}
+
+std::string KZ::runmetadata::Encode(const f64 *splitTimes, u32 splitCount, const f64 *cpTimes, u32 cpCount, const f64 *stageTimes,
+									u32 stageCount)
+{
+	splitCount = MIN(splitCount, UINT8_MAX);
+	cpCount = MIN(cpCount, UINT8_MAX);
+	stageCount = MIN(stageCount, UINT8_MAX);
+
+	// x86 is little endian, so the times can be copied as is.
+	std::vector<u8> data(RUN_METADATA_HEADER_SIZE + (splitCount + cpCount + stageCount) * sizeof(f64));
+	data[0] = RUN_METADATA_VERSION;
+	data[1] = splitCount;
+	data[2] = cpCount;
+	data[3] = stageCount;
+	u8 *cursor = data.data() + RUN_METADATA_HEADER_SIZE;
+	for (auto [times, count] : {std::pair {splitTimes, splitCount}, {cpTimes, cpCount}, {stageTimes, stageCount}})
+	{
+		if (count > 0)
+		{
+			memcpy(cursor, times, count * sizeof(f64));
+			cursor += count * sizeof(f64);
+		}
+	}
+
+	std::string result;
+	Base64Encode(data.data(), data.size(), result);
+	return result;
+}
+
+static_function bool DecodeLegacy(const char *metadata, std::vector<f64> &times, u8 &splitCount, u8 &cpCount, u8 &stageCount)
+{
+	KeyValues3 kv(KV3_TYPEEX_TABLE, KV3_SUBTYPE_UNSPECIFIED);
+	CUtlString error = "";
+	LoadKV3FromJSON(&kv, &error, metadata, "");
+	if (!error.IsEmpty())
+	{
+		META_CONPRINTF("[KZ::Timer] Failed to decode run metadata: %s\n", error.Get());
+		return false;
+	}
+
+	times.clear();
+	u8 *counts[] = {&splitCount, &cpCount, &stageCount};
+	const char *members[] = {"splitZoneTimes", "cpZoneTimes", "stageZoneTimes"};
+	for (u32 i = 0; i < 3; i++)
+	{
+		*counts[i] = 0;
+		KeyValues3 *data = kv.FindMember(members[i]);
+		if (!data || data->GetType() != KV3_TYPE_ARRAY)
+		{
+			continue;
+		}
+		*counts[i] = MIN(data->GetArrayElementCount(), UINT8_MAX);
+		for (u32 j = 0; j < *counts[i]; j++)
+		{
+			KeyValues3 *element = data->GetArrayElement(j);
+			times.push_back(element ? element->GetDouble(-1.0) : -1.0);
+		}
+	}
+	return true;
+}
+
+bool KZ::runmetadata::Decode(const char *metadata, std::vector<f64> &times, u8 &splitCount, u8 &cpCount, u8 &stageCount)
+{
+	if (!metadata || !metadata[0])
+	{
+		return false;
+	}
+	if (IsLegacy(metadata))
+	{
+		return DecodeLegacy(metadata, times, splitCount, cpCount, stageCount);
+	}
+
+	static_persist std::vector<u8> data;
+	if (!Base64Decode(metadata, data) || data.size() < RUN_METADATA_HEADER_SIZE || data[0] != RUN_METADATA_VERSION)
+	{
+		META_CONPRINTF("[KZ::Timer] Failed to decode run metadata: invalid or unsupported format.\n");
+		return false;
+	}
+	u32 count = data[1] + data[2] + data[3];
+	if (data.size() != RUN_METADATA_HEADER_SIZE + count * sizeof(f64))
+	{
+		META_CONPRINTF("[KZ::Timer] Failed to decode run metadata: expected %u zone times.\n", count);
+		return false;
+	}
+	splitCount = data[1];
+	cpCount = data[2];
+	stageCount = data[3];
+	times.resize(count);
+	if (count > 0)
+	{
+		memcpy(times.data(), data.data() + RUN_METADATA_HEADER_SIZE, count * sizeof(f64));
+	}
+	return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+/*
+	Encoding of a run's zone times, stored in Times.Metadata.
+
+	Runs are stored as base64 of a small binary blob:
+	u8 version, u8 split count, u8 checkpoint count, u8 stage count, then every zone time as a little endian f64,
+	splits first, then checkpoints, then stages. Negative times mean the zone wasn't reached.
+	Older rows and the global API use a JSON object with splitZoneTimes, cpZoneTimes and stageZoneTimes arrays instead.
+*/
+
+namespace KZ::runmetadata
+{
+	std::string Encode(const f64 *splitTimes, u32 splitCount, const f64 *cpTimes, u32 cpCount, const f64 *stageTimes, u32 stageCount);
+
+	inline bool IsLegacy(const char *metadata)
+	{
+		return metadata && metadata[0] == '{';
+	}
+
+	// Accepts both the binary and the legacy JSON format. times is laid out like the binary format.
+	bool Decode(const char *metadata, std::vector<f64> &times, u8 &splitCount, u8 &cpCount, u8 &stageCount);
+} // namespace KZ::runmetadata
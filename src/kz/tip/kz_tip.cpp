@@ -1,6 +1,7 @@
 #include "kz_tip.h"
 #include "kz/timer/kz_timer.h"
 #include "kz/language/kz_language.h"
+#include "kz/watchdog/kz_watchdog.h"
 
 #include <vendor/MultiAddonManager/public/imultiaddonmanager.h>
 #include <vendor/ClientCvarValue/public/iclientcvarvalue.h>
@@ -84,7 +85,7 @@ void KZTipService::LoadTips()
 		tipNames.AddToTail(it->GetName());
 	}
 
-	tipInterval = KZOptionService::GetOptionFloat("tipInterval", KZ_DEFAULT_TIP_INTERVAL);
+	tipInterval = KZOptionService::GetConfig().tipInterval;
 }
 
 void KZTipService::ShuffleTips()
@@ -105,6 +106,10 @@ SCMD(kz_tips, SCFL_MISC)
 
 f64 KZTipService::PrintTips()
 {
+	if (KZ::watchdog::IsDegraded(KZ::watchdog::DEGRADE_TELEMETRY))
+	{
+		return tipInterval;
+	}
 	for (int i = 0; i <= MAXPLAYERS; i++)
 	{
 		KZPlayer *player = g_pKZPlayerManager->ToPlayer(i);
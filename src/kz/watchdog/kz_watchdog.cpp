@@ -0,0 +1,114 @@
+#include "kz_watchdog.h"
+#include "kz/kz.h"
+#include "kz/option/kz_option.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace KZ::watchdog;
+
+// Consecutive frames over budget before stepping down a level.
+#define WATCHDOG_DEGRADE_FRAMES 16
+// Consecutive frames under the recovery threshold before stepping back up a level.
+#define WATCHDOG_RECOVER_FRAMES 256
+// Fraction of the budget a frame needs to stay under to count towards recovery.
+#define WATCHDOG_RECOVER_RATIO 0.75
+
+static_global struct
+{
+	// 0 means the watchdog is disabled.
+	i64 budgetMicroseconds = 4000;
+	u32 framesOverBudget;
+	u32 framesUnderThreshold;
+	i64 lastFrameMicroseconds;
+	i64 maxFrameMicroseconds;
+	u64 levelChanges;
+} watchdogState;
+
+static_function const char *GetLevelName(DegradationLevel degradationLevel)
+{
+	switch (degradationLevel)
+	{
+		case DEGRADE_NONE:
+			return "none";
+		case DEGRADE_HUD:
+			return "hud";
+		case DEGRADE_BEAMS:
+			return "beams";
+		case DEGRADE_TELEMETRY:
+			return "telemetry";
+		default:
+			return "unknown";
+	}
+}
+
+static_function void SetLevel(DegradationLevel newLevel)
+{
+	META_CONPRINTF("[KZ::Watchdog] Degradation level %s -> %s (last frame %lldus, budget %lldus)\n", GetLevelName(level), GetLevelName(newLevel),
+				   watchdogState.lastFrameMicroseconds, watchdogState.budgetMicroseconds);
+	level = newLevel;
+	watchdogState.framesOverBudget = 0;
+	watchdogState.framesUnderThreshold = 0;
+	watchdogState.levelChanges++;
+}
+
+void KZ::watchdog::Init()
+{
+	watchdogState.budgetMicroseconds = MAX(KZOptionService::GetConfig().tickBudget, 0);
+}
+
+void KZ::watchdog::OnGameFrame()
+{
+	i64 elapsed = std::chrono::duration_cast<std::chrono::microseconds>(frameTime).count();
+	frameTime = {};
+	watchdogState.lastFrameMicroseconds = elapsed;
+	watchdogState.maxFrameMicroseconds = MAX(watchdogState.maxFrameMicroseconds, elapsed);
+
+	if (watchdogState.budgetMicroseconds == 0)
+	{
+		if (level != DEGRADE_NONE)
+		{
+			SetLevel(DEGRADE_NONE);
+		}
+		return;
+	}
+
+	if (elapsed > watchdogState.budgetMicroseconds)
+	{
+		watchdogState.framesUnderThreshold = 0;
+		if (++watchdogState.framesOverBudget >= WATCHDOG_DEGRADE_FRAMES && level < DEGRADE_COUNT - 1)
+		{
+			SetLevel((DegradationLevel)(level + 1));
+		}
+	}
+	else if (elapsed < watchdogState.budgetMicroseconds * WATCHDOG_RECOVER_RATIO)
+	{
+		watchdogState.framesOverBudget = 0;
+		if (++watchdogState.framesUnderThreshold >= WATCHDOG_RECOVER_FRAMES && level > DEGRADE_NONE)
+		{
+			SetLevel((DegradationLevel)(level - 1));
+		}
+	}
+	else
+	{
+		// In between, keep the current level without building up towards either direction.
+		watchdogState.framesOverBudget = 0;
+		watchdogState.framesUnderThreshold = 0;
+	}
+}
+
+bool KZ::watchdog::ShouldRun(DegradationLevel minLevel, i32 interval)
+{
+	if (level < minLevel)
+	{
+		return true;
+	}
+	return g_pKZUtils->GetServerGlobals()->tickcount % interval == 0;
+}
+
+CON_COMMAND_F(kz_watchdog, "Print tick budget watchdog status", FCVAR_NONE)
+{
+	META_CONPRINTF("[KZ::Watchdog] Level: %s, budget: %lldus%s\n", GetLevelName(level), watchdogState.budgetMicroseconds,
+				   watchdogState.budgetMicroseconds == 0 ? " (disabled)" : "");
+	META_CONPRINTF("[KZ::Watchdog] Last frame: %lldus, max frame: %lldus, level changes: %llu\n", watchdogState.lastFrameMicroseconds,
+				   watchdogState.maxFrameMicroseconds, watchdogState.levelChanges);
+}
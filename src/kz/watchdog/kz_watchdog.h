@@ -0,0 +1,60 @@
+#pragma once
+#include <chrono>
+
+#include "common.h"
+
+/*
+	Tick budget watchdog.
+
+	Measures how much time the plugin spends per GameFrame and steps cosmetic features down when it keeps going over the budget,
+	then back up once it has stayed comfortably under it for a while.
+	Timer, triggers and movement are never degraded.
+*/
+
+namespace KZ::watchdog
+{
+	enum DegradationLevel : u8
+	{
+		// Everything runs at full rate.
+		DEGRADE_NONE = 0,
+		// HUD is only drawn every other tick.
+		DEGRADE_HUD,
+		// Beams are only updated every other tick.
+		DEGRADE_BEAMS,
+		// Telemetry is sampled every few ticks and tips are skipped.
+		DEGRADE_TELEMETRY,
+		DEGRADE_COUNT
+	};
+
+	inline DegradationLevel level = DEGRADE_NONE;
+	// Time spent in the plugin since the start of the current frame.
+	inline std::chrono::steady_clock::duration frameTime {};
+
+	class Scope
+	{
+	public:
+		Scope() : start(std::chrono::steady_clock::now()) {}
+
+		~Scope()
+		{
+			frameTime += std::chrono::steady_clock::now() - this->start;
+		}
+
+	private:
+		std::chrono::steady_clock::time_point start;
+	};
+
+	void Init();
+	// Evaluates the previous frame against the budget. Called at the start of every GameFrame.
+	void OnGameFrame();
+
+	inline bool IsDegraded(DegradationLevel minLevel)
+	{
+		return level >= minLevel;
+	}
+
+	// Whether a feature degraded at minLevel should run this tick, given it only runs once every `interval` ticks while degraded.
+	bool ShouldRun(DegradationLevel minLevel, i32 interval = 2);
+} // namespace KZ::watchdog
+
+#define KZ_WATCHDOG_SCOPE() KZ::watchdog::Scope kzWatchdogScope
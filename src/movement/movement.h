@@ -4,6 +4,7 @@
 #include "steam/steam_api_common.h"
 #include "steam/steamclientpublic.h"
 #include "steam/isteamuser.h"
+#include <type_traits>
 
 class CCSPlayer_MovementServices;
 
@@ -17,30 +18,141 @@ class MovementPlayer;
 class CCSPlayerPawnBase;
 class PlayerCommand;
 
-#ifdef DEBUG_TPM
-struct TraceHistory
+// Flight recorder for the traces done during TryPlayerMove, toggled at runtime with kz_trace_recorder.
+// Keeps the last TRACE_RECORDER_SIZE traces in a lock-free ring that can be dumped to a binary file.
+namespace movement::tracerecorder
 {
-	Vector start;
-	Vector end;
-	Ray_t ray;
-	bool didHit;
-	Vector m_vStartPos;  // start position
-	Vector m_vEndPos;    // final position
-	Vector m_vHitNormal; // surface normal at impact
-	Vector m_vHitPoint;  // exact hit point if m_bExactHitPoint is true, otherwise equal to m_vEndPos
-
-	float m_flHitOffset; // surface normal hit offset
-	float m_flFraction;  // time completed, 1.0 = didn't hit anything
-
-	f32 error;
-	Vector velocity;
+	struct TraceRecord
+	{
+		i32 tickcount;
+		i32 playerSlot;
+		u8 rayType;
+		bool didHit;
+		Vector start;
+		Vector end;
+		// Only set for hull traces.
+		Vector rayMins;
+		Vector rayMaxs;
+		Vector endPos;
+		Vector hitNormal;
+		Vector hitPoint;
+		f32 fraction;
+		f32 hitOffset;
+		// Player state at the time of the trace.
+		f32 error;
+		Vector velocity;
+	};
+
+	bool IsEnabled();
+	void SetEnabled(bool enabled);
+	// Traces are only recorded while a player is set.
+	void SetCurrentPlayer(MovementPlayer *player);
+	void Record(const Ray_t &ray, const Vector &start, const Vector &end, const trace_t *pm);
+
+	// Index the next trace will be written to, increases forever.
+	u64 GetWriteIndex();
+	// Returns false if the record was already overwritten or is being written.
+	bool GetRecord(u64 index, TraceRecord &out);
+
+	// Writes every trace still in the ring to addons/cs2kz/data, the file is written on a separate thread.
+	// Skipped while the previous dump is still being written.
+	void Dump(const char *reason);
+	// Dumps the ring if automatic dumps are enabled, at most once every few seconds.
+	void OnJumpInvalidated(const char *reason);
+	// Waits for a dump in progress to finish, called on unload.
+	void Cleanup();
+} // namespace movement::tracerecorder
+
+// Every movement hook and event that can be forwarded to a player, as X(ENUM_SUFFIX, callbackName).
+// Pre and post callbacks of the same function have separate bits so either one can be skipped on its own.
+#define MVHOOK_LIST(X) \
+	X(PHYSICSSIMULATE, OnPhysicsSimulate) \
+	X(PHYSICSSIMULATE_POST, OnPhysicsSimulatePost) \
+	X(PROCESSUSERCMDS, OnProcessUsercmds) \
+	X(PROCESSUSERCMDS_POST, OnProcessUsercmdsPost) \
+	X(SETUPMOVE, OnSetupMove) \
+	X(SETUPMOVE_POST, OnSetupMovePost) \
+	X(PROCESSMOVEMENT, OnProcessMovement) \
+	X(PROCESSMOVEMENT_POST, OnProcessMovementPost) \
+	X(PLAYERMOVE, OnPlayerMove) \
+	X(PLAYERMOVE_POST, OnPlayerMovePost) \
+	X(CHECKPARAMETERS, OnCheckParameters) \
+	X(CHECKPARAMETERS_POST, OnCheckParametersPost) \
+	X(CANMOVE, OnCanMove) \
+	X(CANMOVE_POST, OnCanMovePost) \
+	X(FULLWALKMOVE, OnFullWalkMove) \
+	X(FULLWALKMOVE_POST, OnFullWalkMovePost) \
+	X(MOVEINIT, OnMoveInit) \
+	X(MOVEINIT_POST, OnMoveInitPost) \
+	X(CHECKWATER, OnCheckWater) \
+	X(CHECKWATER_POST, OnCheckWaterPost) \
+	X(WATERMOVE, OnWaterMove) \
+	X(WATERMOVE_POST, OnWaterMovePost) \
+	X(CHECKVELOCITY, OnCheckVelocity) \
+	X(CHECKVELOCITY_POST, OnCheckVelocityPost) \
+	X(DUCK, OnDuck) \
+	X(DUCK_POST, OnDuckPost) \
+	X(CANUNDUCK, OnCanUnduck) \
+	X(CANUNDUCK_POST, OnCanUnduckPost) \
+	X(LADDERMOVE, OnLadderMove) \
+	X(LADDERMOVE_POST, OnLadderMovePost) \
+	X(CHECKJUMPBUTTON, OnCheckJumpButton) \
+	X(CHECKJUMPBUTTON_POST, OnCheckJumpButtonPost) \
+	X(JUMP, OnJump) \
+	X(JUMP_POST, OnJumpPost) \
+	X(AIRMOVE, OnAirMove) \
+	X(AIRMOVE_POST, OnAirMovePost) \
+	X(FRICTION, OnFriction) \
+	X(FRICTION_POST, OnFrictionPost) \
+	X(WALKMOVE, OnWalkMove) \
+	X(WALKMOVE_POST, OnWalkMovePost) \
+	X(TRYPLAYERMOVE, OnTryPlayerMove) \
+	X(TRYPLAYERMOVE_POST, OnTryPlayerMovePost) \
+	X(CATEGORIZEPOSITION, OnCategorizePosition) \
+	X(CATEGORIZEPOSITION_POST, OnCategorizePositionPost) \
+	X(FINISHGRAVITY, OnFinishGravity) \
+	X(FINISHGRAVITY_POST, OnFinishGravityPost) \
+	X(CHECKFALLING, OnCheckFalling) \
+	X(CHECKFALLING_POST, OnCheckFallingPost) \
+	X(POSTPLAYERMOVE, OnPostPlayerMove) \
+	X(POSTPLAYERMOVE_POST, OnPostPlayerMovePost) \
+	X(POSTTHINK, OnPostThink) \
+	X(POSTTHINK_POST, OnPostThinkPost) \
+	X(STARTTOUCHGROUND, OnStartTouchGround) \
+	X(STOPTOUCHGROUND, OnStopTouchGround) \
+	X(CHANGEMOVETYPE, OnChangeMoveType)
+
+enum MovementHook
+{
+#define MVHOOK_ENUM(hook, func) MVHOOK_##hook,
+	MVHOOK_LIST(MVHOOK_ENUM)
+#undef MVHOOK_ENUM
+	MVHOOK_COUNT
 };
 
-extern CUtlVector<TraceHistory> traceHistory;
-#endif
+static_assert(MVHOOK_COUNT <= 64, "Movement hooks no longer fit in a u64 mask!");
+
+#define MVHOOK_BIT(hook) (1ull << (hook))
+#define MVHOOK_MASK_ALL  (~0ull)
 
 namespace movement
 {
+	// Returns the mask of movement hooks that T overrides from Base.
+	// Taking the address of a member that T does not override yields a pointer of type Base::*, so this is resolved at compile time.
+	template<typename T, typename Base>
+	constexpr u64 GetOverriddenHooks()
+	{
+		u64 mask = 0;
+#define MVHOOK_DETECT(hook, func) \
+	if constexpr (!std::is_same_v<decltype(&T::func), decltype(&Base::func)>) \
+	{ \
+		mask |= MVHOOK_BIT(MVHOOK_##hook); \
+	}
+		MVHOOK_LIST(MVHOOK_DETECT)
+#undef MVHOOK_DETECT
+		return mask;
+	}
+
 	void InitDetours();
 
 	void FASTCALL Detour_PhysicsSimulate(CCSPlayerController *);
@@ -265,6 +377,12 @@ public:
 		return this->currentMoveData->m_TouchList.Count() > 0 || this->collidingWithWorld;
 	}
 
+	// Detours skip the pre/post callbacks of hooks that are not in this mask.
+	bool IsHookSubscribed(MovementHook hook)
+	{
+		return this->subscribedHooks & MVHOOK_BIT(hook);
+	}
+
 public:
 	// General
 	bool processingMovement {};
@@ -304,6 +422,8 @@ public:
 	bool enableWaterFix {};
 	bool ignoreNextCategorizePosition {};
 
+	u64 subscribedHooks = MVHOOK_MASK_ALL;
+
 private:
 	bool collidingWithWorld {};
 	// Movetype changes that occur outside of movement processing
@@ -8,8 +8,6 @@
 #include "vprof.h"
 #ifdef DEBUG_TPM
 #include "fmtstr.h"
-
-CUtlVector<TraceHistory> traceHistory;
 #endif
 extern CGameConfig *g_pGameConfig;
 
@@ -54,9 +52,15 @@ void FASTCALL movement::Detour_PhysicsSimulate(CCSPlayerController *controller)
 	}
 	g_KZPlugin.simulatingPhysics = true;
 	MovementPlayer *player = playerManager->ToPlayer(controller);
-	player->OnPhysicsSimulate();
+	if (player->IsHookSubscribed(MVHOOK_PHYSICSSIMULATE))
+	{
+		player->OnPhysicsSimulate();
+	}
 	PhysicsSimulate(controller);
-	player->OnPhysicsSimulatePost();
+	if (player->IsHookSubscribed(MVHOOK_PHYSICSSIMULATE_POST))
+	{
+		player->OnPhysicsSimulatePost();
+	}
 	g_KZPlugin.simulatingPhysics = false;
 }
 
@@ -78,9 +82,15 @@ i32 FASTCALL movement::Detour_ProcessUsercmds(CCSPlayerController *controller, v
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(controller);
-	player->OnProcessUsercmds(cmds, numcmds);
+	if (player->IsHookSubscribed(MVHOOK_PROCESSUSERCMDS))
+	{
+		player->OnProcessUsercmds(cmds, numcmds);
+	}
 	auto retValue = ProcessUsercmds(controller, cmds, numcmds, paused, margin);
-	player->OnProcessUsercmdsPost(cmds, numcmds);
+	if (player->IsHookSubscribed(MVHOOK_PROCESSUSERCMDS_POST))
+	{
+		player->OnProcessUsercmdsPost(cmds, numcmds);
+	}
 	VPROF_EXIT_SCOPE();
 	return retValue;
 }
@@ -92,9 +102,15 @@ void FASTCALL movement::Detour_SetupMove(CCSPlayer_MovementServices *ms, PlayerC
 	CBasePlayerController *controller = player->GetController();
 	player->currentMoveData = mv;
 	player->moveDataPre = CMoveData(*mv);
-	player->OnSetupMove(pc);
+	if (player->IsHookSubscribed(MVHOOK_SETUPMOVE))
+	{
+		player->OnSetupMove(pc);
+	}
 	SetupMove(ms, pc, mv);
-	player->OnSetupMovePost(pc);
+	if (player->IsHookSubscribed(MVHOOK_SETUPMOVE_POST))
+	{
+		player->OnSetupMovePost(pc);
+	}
 }
 
 void FASTCALL movement::Detour_ProcessMovement(CCSPlayer_MovementServices *ms, CMoveData *mv)
@@ -103,19 +119,31 @@ void FASTCALL movement::Detour_ProcessMovement(CCSPlayer_MovementServices *ms, C
 	MovementPlayer *player = playerManager->ToPlayer(ms);
 	player->currentMoveData = mv;
 	player->moveDataPre = CMoveData(*mv);
-	player->OnProcessMovement();
+	if (player->IsHookSubscribed(MVHOOK_PROCESSMOVEMENT))
+	{
+		player->OnProcessMovement();
+	}
 	ProcessMovement(ms, mv);
 	player->moveDataPost = CMoveData(*mv);
-	player->OnProcessMovementPost();
+	if (player->IsHookSubscribed(MVHOOK_PROCESSMOVEMENT_POST))
+	{
+		player->OnProcessMovementPost();
+	}
 }
 
 bool FASTCALL movement::Detour_PlayerMove(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnPlayerMove();
+	if (player->IsHookSubscribed(MVHOOK_PLAYERMOVE))
+	{
+		player->OnPlayerMove();
+	}
 	auto retValue = PlayerMove(ms, mv);
-	player->OnPlayerMovePost();
+	if (player->IsHookSubscribed(MVHOOK_PLAYERMOVE_POST))
+	{
+		player->OnPlayerMovePost();
+	}
 	return retValue;
 }
 
@@ -123,18 +151,30 @@ void FASTCALL movement::Detour_CheckParameters(CCSPlayer_MovementServices *ms, C
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnCheckParameters();
+	if (player->IsHookSubscribed(MVHOOK_CHECKPARAMETERS))
+	{
+		player->OnCheckParameters();
+	}
 	CheckParameters(ms, mv);
-	player->OnCheckParametersPost();
+	if (player->IsHookSubscribed(MVHOOK_CHECKPARAMETERS_POST))
+	{
+		player->OnCheckParametersPost();
+	}
 }
 
 bool FASTCALL movement::Detour_CanMove(CCSPlayerPawnBase *pawn)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(pawn);
-	player->OnCanMove();
+	if (player->IsHookSubscribed(MVHOOK_CANMOVE))
+	{
+		player->OnCanMove();
+	}
 	auto retValue = CanMove(pawn);
-	player->OnCanMovePost();
+	if (player->IsHookSubscribed(MVHOOK_CANMOVE_POST))
+	{
+		player->OnCanMovePost();
+	}
 	return retValue;
 }
 
@@ -142,18 +182,30 @@ void FASTCALL movement::Detour_FullWalkMove(CCSPlayer_MovementServices *ms, CMov
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnFullWalkMove(ground);
+	if (player->IsHookSubscribed(MVHOOK_FULLWALKMOVE))
+	{
+		player->OnFullWalkMove(ground);
+	}
 	FullWalkMove(ms, mv, ground);
-	player->OnFullWalkMovePost(ground);
+	if (player->IsHookSubscribed(MVHOOK_FULLWALKMOVE_POST))
+	{
+		player->OnFullWalkMovePost(ground);
+	}
 }
 
 bool FASTCALL movement::Detour_MoveInit(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnMoveInit();
+	if (player->IsHookSubscribed(MVHOOK_MOVEINIT))
+	{
+		player->OnMoveInit();
+	}
 	auto retValue = MoveInit(ms, mv);
-	player->OnMoveInitPost();
+	if (player->IsHookSubscribed(MVHOOK_MOVEINIT_POST))
+	{
+		player->OnMoveInitPost();
+	}
 	return retValue;
 }
 
@@ -161,9 +213,15 @@ bool FASTCALL movement::Detour_CheckWater(CCSPlayer_MovementServices *ms, CMoveD
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnCheckWater();
+	if (player->IsHookSubscribed(MVHOOK_CHECKWATER))
+	{
+		player->OnCheckWater();
+	}
 	auto retValue = CheckWater(ms, mv);
-	player->OnCheckWaterPost();
+	if (player->IsHookSubscribed(MVHOOK_CHECKWATER_POST))
+	{
+		player->OnCheckWaterPost();
+	}
 
 	return retValue;
 }
@@ -172,7 +230,10 @@ void FASTCALL movement::Detour_WaterMove(CCSPlayer_MovementServices *ms, CMoveDa
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnWaterMove();
+	if (player->IsHookSubscribed(MVHOOK_WATERMOVE))
+	{
+		player->OnWaterMove();
+	}
 #ifdef WATER_FIX
 	if (player->enableWaterFix)
 	{
@@ -180,36 +241,57 @@ void FASTCALL movement::Detour_WaterMove(CCSPlayer_MovementServices *ms, CMoveDa
 	}
 #endif
 	WaterMove(ms, mv);
-	player->OnWaterMovePost();
+	if (player->IsHookSubscribed(MVHOOK_WATERMOVE_POST))
+	{
+		player->OnWaterMovePost();
+	}
 }
 
 void FASTCALL movement::Detour_CheckVelocity(CCSPlayer_MovementServices *ms, CMoveData *mv, const char *a3)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnCheckVelocity(a3);
+	if (player->IsHookSubscribed(MVHOOK_CHECKVELOCITY))
+	{
+		player->OnCheckVelocity(a3);
+	}
 	CheckVelocity(ms, mv, a3);
-	player->OnCheckVelocityPost(a3);
+	if (player->IsHookSubscribed(MVHOOK_CHECKVELOCITY_POST))
+	{
+		player->OnCheckVelocityPost(a3);
+	}
 }
 
 void FASTCALL movement::Detour_Duck(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnDuck();
+	if (player->IsHookSubscribed(MVHOOK_DUCK))
+	{
+		player->OnDuck();
+	}
 	player->processingDuck = true;
 	Duck(ms, mv);
 	player->processingDuck = false;
-	player->OnDuckPost();
+	if (player->IsHookSubscribed(MVHOOK_DUCK_POST))
+	{
+		player->OnDuckPost();
+	}
 }
 
 bool FASTCALL movement::Detour_CanUnduck(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnCanUnduck();
+	if (player->IsHookSubscribed(MVHOOK_CANUNDUCK))
+	{
+		player->OnCanUnduck();
+	}
 	bool canUnduck = CanUnduck(ms, mv);
-	player->OnCanUnduckPost(canUnduck);
+	if (player->IsHookSubscribed(MVHOOK_CANUNDUCK_POST))
+	{
+		player->OnCanUnduckPost(canUnduck);
+	}
 	return canUnduck;
 }
 
@@ -217,7 +299,10 @@ bool FASTCALL movement::Detour_LadderMove(CCSPlayer_MovementServices *ms, CMoveD
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnLadderMove();
+	if (player->IsHookSubscribed(MVHOOK_LADDERMOVE))
+	{
+		player->OnLadderMove();
+	}
 	Vector oldVelocity = mv->m_vecVelocity;
 	MoveType_t oldMoveType = player->GetPlayerPawn()->m_MoveType();
 	bool result = LadderMove(ms, mv);
@@ -252,7 +337,10 @@ bool FASTCALL movement::Detour_LadderMove(CCSPlayer_MovementServices *ms, CMoveD
 	{
 		player->GetOrigin(&player->lastValidLadderOrigin);
 	}
-	player->OnLadderMovePost();
+	if (player->IsHookSubscribed(MVHOOK_LADDERMOVE_POST))
+	{
+		player->OnLadderMovePost();
+	}
 	return result;
 }
 
@@ -269,16 +357,25 @@ void FASTCALL movement::Detour_CheckJumpButton(CCSPlayer_MovementServices *ms, C
 		}
 	}
 #endif
-	player->OnCheckJumpButton();
+	if (player->IsHookSubscribed(MVHOOK_CHECKJUMPBUTTON))
+	{
+		player->OnCheckJumpButton();
+	}
 	CheckJumpButton(ms, mv);
-	player->OnCheckJumpButtonPost();
+	if (player->IsHookSubscribed(MVHOOK_CHECKJUMPBUTTON_POST))
+	{
+		player->OnCheckJumpButtonPost();
+	}
 }
 
 void FASTCALL movement::Detour_OnJump(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnJump();
+	if (player->IsHookSubscribed(MVHOOK_JUMP))
+	{
+		player->OnJump();
+	}
 	Vector oldOutWishVel = mv->m_outWishVel;
 	MoveType_t oldMoveType = player->GetPlayerPawn()->m_MoveType();
 	OnJump(ms, mv);
@@ -288,94 +385,120 @@ void FASTCALL movement::Detour_OnJump(CCSPlayer_MovementServices *ms, CMoveData
 		player->RegisterTakeoff(true);
 		player->OnStopTouchGround();
 	}
-	player->OnJumpPost();
+	if (player->IsHookSubscribed(MVHOOK_JUMP_POST))
+	{
+		player->OnJumpPost();
+	}
 }
 
 void FASTCALL movement::Detour_AirMove(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnAirMove();
+	if (player->IsHookSubscribed(MVHOOK_AIRMOVE))
+	{
+		player->OnAirMove();
+	}
 	AirMove(ms, mv);
-	player->OnAirMovePost();
+	if (player->IsHookSubscribed(MVHOOK_AIRMOVE_POST))
+	{
+		player->OnAirMovePost();
+	}
 }
 
 void FASTCALL movement::Detour_Friction(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnFriction();
+	if (player->IsHookSubscribed(MVHOOK_FRICTION))
+	{
+		player->OnFriction();
+	}
 	Friction(ms, mv);
-	player->OnFrictionPost();
+	if (player->IsHookSubscribed(MVHOOK_FRICTION_POST))
+	{
+		player->OnFrictionPost();
+	}
 }
 
 void FASTCALL movement::Detour_WalkMove(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnWalkMove();
+	if (player->IsHookSubscribed(MVHOOK_WALKMOVE))
+	{
+		player->OnWalkMove();
+	}
 	WalkMove(ms, mv);
 	player->walkMoved = true;
-	player->OnWalkMovePost();
+	if (player->IsHookSubscribed(MVHOOK_WALKMOVE_POST))
+	{
+		player->OnWalkMovePost();
+	}
 }
 
 void FASTCALL movement::Detour_TryPlayerMove(CCSPlayer_MovementServices *ms, CMoveData *mv, Vector *pFirstDest, trace_t *pFirstTrace)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
+	movement::tracerecorder::SetCurrentPlayer(player);
 #ifdef DEBUG_TPM
-	traceHistory.RemoveAll();
 	f32 initialError = ms->m_flAccumulatedJumpError();
 	Vector initialVelocity = mv->m_vecVelocity;
-	f32 &liveError = ms->m_flAccumulatedJumpError();
-	Vector &liveVelocity = mv->m_vecVelocity;
-	TraceShape.EnableDetour();
-	player->OnTryPlayerMove(pFirstDest, pFirstTrace);
+	u64 predictedStart = movement::tracerecorder::GetWriteIndex();
+	if (player->IsHookSubscribed(MVHOOK_TRYPLAYERMOVE))
+	{
+		player->OnTryPlayerMove(pFirstDest, pFirstTrace);
+	}
 	Vector oldVelocity = mv->m_vecVelocity;
-	i32 count = traceHistory.Count();
+	u64 realStart = movement::tracerecorder::GetWriteIndex();
 	TryPlayerMove(ms, mv, pFirstDest, pFirstTrace);
-	if (traceHistory.Count() != count)
+	u64 realEnd = movement::tracerecorder::GetWriteIndex();
+	if (realStart != predictedStart)
 	{
-		for (i32 i = 0; i + count < traceHistory.Count(); i++)
+		// Compare the traces predicted by the mode against the ones TryPlayerMove actually did.
+		movement::tracerecorder::TraceRecord pred, real;
+		for (u64 i = 0; predictedStart + i < realStart && realStart + i < realEnd; i++)
 		{
-			if (traceHistory[i].end != traceHistory[i + count].end)
+			if (!movement::tracerecorder::GetRecord(predictedStart + i, pred) || !movement::tracerecorder::GetRecord(realStart + i, real))
 			{
-				META_CONPRINTF("Trace not matching! Previous traces (initial error %f, initial velocity %s):\n", initialError,
-							   VecToString(initialVelocity));
-				for (i32 j = 0; j <= i; j++)
+				break;
+			}
+			if (pred.end == real.end)
+			{
+				continue;
+			}
+			META_CONPRINTF("Trace not matching! Previous traces (initial error %f, initial velocity %s):\n", initialError,
+						   VecToString(initialVelocity));
+			for (u64 j = 0; j <= i; j++)
+			{
+				if (!movement::tracerecorder::GetRecord(predictedStart + j, pred) || !movement::tracerecorder::GetRecord(realStart + j, real))
 				{
-					META_CONPRINTF("Pred %f %f %f -> %f %f %f, error %f, velocity %s ", traceHistory[j].start.x, traceHistory[j].start.y,
-								   traceHistory[j].start.z, traceHistory[j].end.x, traceHistory[j].end.y, traceHistory[j].end.z,
-								   traceHistory[j].error, VecToString(traceHistory[j].velocity));
-					if (traceHistory[j].didHit)
-					{
-						META_CONPRINTF("hit %s (normal %s, hitpoint %s)\n", VecToString(traceHistory[j].m_vEndPos),
-									   VecToString(traceHistory[j].m_vHitNormal), VecToString(traceHistory[j].m_vHitPoint));
-					}
-					else
-					{
-						META_CONPRINTF("missed\n");
-					}
-					META_CONPRINTF("Real %f %f %f -> %f %f %f, error %f, velocity %s ", traceHistory[j + count].start.x,
-								   traceHistory[j + count].start.y, traceHistory[j + count].start.z, traceHistory[j + count].end.x,
-								   traceHistory[j + count].end.y, traceHistory[j + count].end.z, traceHistory[j + count].error,
-								   VecToString(traceHistory[j + count].velocity));
-					if (traceHistory[j + count].didHit)
+					break;
+				}
+				for (auto record : {&pred, &real})
+				{
+					META_CONPRINTF("%s %s -> %s, error %f, velocity %s ", record == &pred ? "Pred" : "Real", VecToString(record->start),
+								   VecToString(record->end), record->error, VecToString(record->velocity));
+					if (record->didHit)
 					{
-						META_CONPRINTF("hit %s (normal %s, hitpoint %s)\n", VecToString(traceHistory[j + count].m_vEndPos),
-									   VecToString(traceHistory[j + count].m_vHitNormal), VecToString(traceHistory[j + count].m_vHitPoint));
+						META_CONPRINTF("hit %s (normal %s, hitpoint %s)\n", VecToString(record->endPos), VecToString(record->hitNormal),
+									   VecToString(record->hitPoint));
 					}
 					else
 					{
 						META_CONPRINTF("missed\n");
 					}
 				}
-				break;
 			}
+			break;
 		}
 	}
 #else
-	player->OnTryPlayerMove(pFirstDest, pFirstTrace);
+	if (player->IsHookSubscribed(MVHOOK_TRYPLAYERMOVE))
+	{
+		player->OnTryPlayerMove(pFirstDest, pFirstTrace);
+	}
 	Vector oldVelocity = mv->m_vecVelocity;
 	TryPlayerMove(ms, mv, pFirstDest, pFirstTrace);
 #endif
@@ -386,11 +509,12 @@ void FASTCALL movement::Detour_TryPlayerMove(CCSPlayer_MovementServices *ms, CMo
 		// but for now this doesn't matter.
 		player->SetCollidingWithWorld();
 	}
-	player->OnTryPlayerMovePost(pFirstDest, pFirstTrace);
+	if (player->IsHookSubscribed(MVHOOK_TRYPLAYERMOVE_POST))
+	{
+		player->OnTryPlayerMovePost(pFirstDest, pFirstTrace);
+	}
 
-#ifdef DEBUG_TPM
-	TraceShape.DisableDetour();
-#endif
+	movement::tracerecorder::SetCurrentPlayer(nullptr);
 }
 
 void FASTCALL movement::Detour_CategorizePosition(CCSPlayer_MovementServices *ms, CMoveData *mv, bool bStayOnGround)
@@ -404,7 +528,10 @@ void FASTCALL movement::Detour_CategorizePosition(CCSPlayer_MovementServices *ms
 		return;
 	}
 #endif
-	player->OnCategorizePosition(bStayOnGround);
+	if (player->IsHookSubscribed(MVHOOK_CATEGORIZEPOSITION))
+	{
+		player->OnCategorizePosition(bStayOnGround);
+	}
 	Vector oldVelocity = mv->m_vecVelocity;
 	bool oldOnGround = !!(player->GetPlayerPawn()->m_fFlags() & FL_ONGROUND);
 
@@ -425,32 +552,53 @@ void FASTCALL movement::Detour_CategorizePosition(CCSPlayer_MovementServices *ms
 			player->OnStopTouchGround();
 		}
 	}
-	player->OnCategorizePositionPost(bStayOnGround);
+	if (player->IsHookSubscribed(MVHOOK_CATEGORIZEPOSITION_POST))
+	{
+		player->OnCategorizePositionPost(bStayOnGround);
+	}
 }
 
 void FASTCALL movement::Detour_CheckFalling(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnCheckFalling();
+	if (player->IsHookSubscribed(MVHOOK_CHECKFALLING))
+	{
+		player->OnCheckFalling();
+	}
 	CheckFalling(ms, mv);
-	player->OnCheckFallingPost();
+	if (player->IsHookSubscribed(MVHOOK_CHECKFALLING_POST))
+	{
+		player->OnCheckFallingPost();
+	}
 }
 
 void FASTCALL movement::Detour_PostPlayerMove(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(ms);
-	player->OnPostPlayerMove();
+	if (player->IsHookSubscribed(MVHOOK_POSTPLAYERMOVE))
+	{
+		player->OnPostPlayerMove();
+	}
 	PostPlayerMove(ms, mv);
-	player->OnPostPlayerMovePost();
+	if (player->IsHookSubscribed(MVHOOK_POSTPLAYERMOVE_POST))
+	{
+		player->OnPostPlayerMovePost();
+	}
 }
 
 void FASTCALL movement::Detour_PostThink(CCSPlayerPawnBase *pawn)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
 	MovementPlayer *player = playerManager->ToPlayer(pawn);
-	player->OnPostThink();
+	if (player->IsHookSubscribed(MVHOOK_POSTTHINK))
+	{
+		player->OnPostThink();
+	}
 	PostThink(pawn);
-	player->OnPostThinkPost();
+	if (player->IsHookSubscribed(MVHOOK_POSTTHINK_POST))
+	{
+		player->OnPostThinkPost();
+	}
 }
@@ -0,0 +1,244 @@
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include "movement.h"
+#include "utils/utils.h"
+#include "utils/detours.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace movement::tracerecorder;
+
+// Must be a power of two.
+#define TRACE_RECORDER_SIZE          8192
+#define TRACE_RECORDER_MAGIC         "KZTR"
+#define TRACE_RECORDER_VERSION       1
+// Minimum time between two automatic dumps, in seconds.
+#define TRACE_RECORDER_AUTODUMP_RATE 10
+
+static_assert((TRACE_RECORDER_SIZE & (TRACE_RECORDER_SIZE - 1)) == 0, "TRACE_RECORDER_SIZE must be a power of two");
+
+struct TraceFileHeader
+{
+	char magic[4];
+	u32 version;
+	u32 recordSize;
+	u32 recordCount;
+	i64 time;
+	char reason[64];
+};
+
+struct TraceSlot
+{
+	// Odd while the slot is being written, 2 * (index + 1) once the record at that index is complete.
+	std::atomic<u64> sequence;
+	TraceRecord record;
+};
+
+static_global struct
+{
+	TraceSlot slots[TRACE_RECORDER_SIZE];
+	std::atomic<u64> writeIndex;
+#ifdef DEBUG_TPM
+	bool enabled = true;
+#else
+	bool enabled;
+#endif
+	bool autoDump;
+	time_t lastAutoDump;
+	MovementPlayer *currentPlayer;
+	std::thread writer;
+	std::atomic<bool> writing;
+	// Appended to the file name so dumps within the same second don't overwrite each other.
+	u32 dumpCount;
+} recorder;
+
+bool movement::tracerecorder::IsEnabled()
+{
+	return recorder.enabled;
+}
+
+void movement::tracerecorder::SetEnabled(bool enabled)
+{
+	recorder.enabled = enabled;
+	if (enabled)
+	{
+		TraceShape.EnableDetour();
+	}
+	else
+	{
+		TraceShape.DisableDetour();
+	}
+}
+
+void movement::tracerecorder::SetCurrentPlayer(MovementPlayer *player)
+{
+	recorder.currentPlayer = player;
+}
+
+void movement::tracerecorder::Record(const Ray_t &ray, const Vector &start, const Vector &end, const trace_t *pm)
+{
+	MovementPlayer *player = recorder.currentPlayer;
+	if (!recorder.enabled || !player)
+	{
+		return;
+	}
+
+	u64 index = recorder.writeIndex.fetch_add(1, std::memory_order_relaxed);
+	TraceSlot &slot = recorder.slots[index & (TRACE_RECORDER_SIZE - 1)];
+	slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	TraceRecord &record = slot.record;
+	record.tickcount = g_pKZUtils->GetServerGlobals()->tickcount;
+	record.playerSlot = player->GetPlayerSlot().Get();
+	record.rayType = ray.m_eType;
+	record.didHit = pm->DidHit();
+	record.start = start;
+	record.end = end;
+	record.rayMins = ray.m_eType == RAY_TYPE_HULL ? ray.m_Hull.m_vMins : vec3_origin;
+	record.rayMaxs = ray.m_eType == RAY_TYPE_HULL ? ray.m_Hull.m_vMaxs : vec3_origin;
+	record.endPos = pm->m_vEndPos;
+	record.hitNormal = pm->m_vHitNormal;
+	record.hitPoint = pm->m_vHitPoint;
+	record.fraction = pm->m_flFraction;
+	record.hitOffset = pm->m_flHitOffset;
+	CCSPlayer_MovementServices *ms = player->GetMoveServices();
+	record.error = ms ? ms->m_flAccumulatedJumpError() : 0.0f;
+	record.velocity = player->currentMoveData ? player->currentMoveData->m_vecVelocity : vec3_origin;
+
+	slot.sequence.store(2 * (index + 1), std::memory_order_release);
+}
+
+u64 movement::tracerecorder::GetWriteIndex()
+{
+	return recorder.writeIndex.load(std::memory_order_acquire);
+}
+
+bool movement::tracerecorder::GetRecord(u64 index, TraceRecord &out)
+{
+	const TraceSlot &slot = recorder.slots[index & (TRACE_RECORDER_SIZE - 1)];
+	u64 expected = 2 * (index + 1);
+	if (slot.sequence.load(std::memory_order_acquire) != expected)
+	{
+		return false;
+	}
+	out = slot.record;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.sequence.load(std::memory_order_relaxed) == expected;
+}
+
+static_function void WriteDump(std::vector<TraceRecord> records, TraceFileHeader header, u32 dumpNumber)
+{
+	char path[MAX_PATH];
+	g_SMAPI->PathFormat(path, sizeof(path), "%s/addons/cs2kz/data/trace_%lld_%u.kztrace", g_SMAPI->GetBaseDir(), header.time, dumpNumber);
+	FILE *file = fopen(path, "wb");
+	if (!file)
+	{
+		META_CONPRINTF("[KZ::TraceRecorder] Failed to open %s for writing.\n", path);
+		recorder.writing.store(false, std::memory_order_release);
+		return;
+	}
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	if (ok && !records.empty())
+	{
+		ok = fwrite(records.data(), sizeof(TraceRecord), records.size(), file) == records.size();
+	}
+	fclose(file);
+	META_CONPRINTF("[KZ::TraceRecorder] %s %u traces to %s.\n", ok ? "Wrote" : "Failed to write", header.recordCount, path);
+	recorder.writing.store(false, std::memory_order_release);
+}
+
+void movement::tracerecorder::Dump(const char *reason)
+{
+	if (recorder.writing.load(std::memory_order_acquire))
+	{
+		META_CONPRINTF("[KZ::TraceRecorder] Previous dump is still being written, skipping.\n");
+		return;
+	}
+	// The previous writer is done, joining it doesn't block.
+	if (recorder.writer.joinable())
+	{
+		recorder.writer.join();
+	}
+
+	u64 end = GetWriteIndex();
+	u64 start = end > TRACE_RECORDER_SIZE ? end - TRACE_RECORDER_SIZE : 0;
+
+	// Copy the ring here so the writer thread never touches it.
+	std::vector<TraceRecord> records;
+	records.reserve(end - start);
+	TraceRecord record;
+	for (u64 i = start; i < end; i++)
+	{
+		if (GetRecord(i, record))
+		{
+			records.push_back(record);
+		}
+	}
+
+	TraceFileHeader header {};
+	memcpy(header.magic, TRACE_RECORDER_MAGIC, sizeof(header.magic));
+	header.version = TRACE_RECORDER_VERSION;
+	header.recordSize = sizeof(TraceRecord);
+	header.recordCount = records.size();
+	header.time = std::time(nullptr);
+	V_strncpy(header.reason, reason, sizeof(header.reason));
+
+	recorder.writing.store(true, std::memory_order_release);
+	recorder.writer = std::thread(WriteDump, std::move(records), header, recorder.dumpCount++);
+}
+
+void movement::tracerecorder::Cleanup()
+{
+	if (recorder.writer.joinable())
+	{
+		recorder.writer.join();
+	}
+}
+
+void movement::tracerecorder::OnJumpInvalidated(const char *reason)
+{
+	if (!recorder.enabled || !recorder.autoDump)
+	{
+		return;
+	}
+	time_t now = std::time(nullptr);
+	if (now - recorder.lastAutoDump < TRACE_RECORDER_AUTODUMP_RATE)
+	{
+		return;
+	}
+	recorder.lastAutoDump = now;
+	Dump(reason);
+}
+
+CON_COMMAND_F(kz_trace_recorder, "Control the movement trace recorder: on, off, autodump or dump", FCVAR_NONE)
+{
+	if (args.ArgC() < 2)
+	{
+		META_CONPRINTF("[KZ::TraceRecorder] %s, automatic dumps %s, %llu traces recorded.\n", recorder.enabled ? "Enabled" : "Disabled",
+					   recorder.autoDump ? "on" : "off", GetWriteIndex());
+		META_CONPRINTF("Usage: kz_trace_recorder <on|off|autodump|dump>\n");
+		return;
+	}
+	if (KZ_STREQI(args[1], "on"))
+	{
+		SetEnabled(true);
+	}
+	else if (KZ_STREQI(args[1], "off"))
+	{
+		SetEnabled(false);
+	}
+	else if (KZ_STREQI(args[1], "autodump"))
+	{
+		recorder.autoDump = !recorder.autoDump;
+		META_CONPRINTF("[KZ::TraceRecorder] Automatic dumps on invalidated jumps %s.\n", recorder.autoDump ? "enabled" : "disabled");
+	}
+	else if (KZ_STREQI(args[1], "dump"))
+	{
+		Dump("manual");
+	}
+}
@@ -12,7 +12,7 @@ CUtlVector<CDetourBase *> g_vecDetours;
 extern CGameConfig *g_pGameConfig;
 
 DECLARE_DETOUR(RecvServerBrowserPacket, Detour_RecvServerBrowserPacket);
-// Unused
+// Only enabled while the trace recorder is on.
 DECLARE_DETOUR(TraceShape, Detour_TraceShape);
 
 DECLARE_MOVEMENT_DETOUR(PhysicsSimulate);
@@ -46,10 +46,11 @@ void InitDetours()
 {
 	g_vecDetours.RemoveAll();
 	INIT_DETOUR(g_pGameConfig, RecvServerBrowserPacket);
-#ifdef DEBUG_TPM
 	INIT_DETOUR(g_pGameConfig, TraceShape);
-	TraceShape.DisableDetour();
-#endif
+	if (!movement::tracerecorder::IsEnabled())
+	{
+		TraceShape.DisableDetour();
+	}
 }
 
 void FlushAllDetours()
@@ -75,61 +76,6 @@ bool Detour_TraceShape(const void *physicsQuery, const Ray_t &ray, const Vector
 					   trace_t *pm)
 {
 	bool ret = TraceShape(physicsQuery, ray, start, end, pTraceFilter, pm);
-#ifdef DEBUG_TPM
-	f32 error;
-	Vector velocity;
-	for (u32 i = 0; i < 2; i++)
-	{
-		if (g_pKZPlayerManager->ToPlayer(i) && g_pKZPlayerManager->ToPlayer(i)->GetMoveServices())
-		{
-			error = g_pKZPlayerManager->ToPlayer(i)->GetMoveServices()->m_flAccumulatedJumpError();
-			velocity = g_pKZPlayerManager->ToPlayer(i)->currentMoveData->m_vecVelocity;
-			break;
-		}
-	}
-	traceHistory.AddToTail({start, end, ray, pm->DidHit(), pm->m_vStartPos, pm->m_vEndPos, pm->m_vHitNormal, pm->m_vHitPoint, pm->m_flHitOffset,
-							pm->m_flFraction, error, velocity});
-	return ret;
-	META_CONPRINTF("Trace %s -> %s, ", VecToString(start), VecToString(end));
-	switch (ray.m_eType)
-	{
-		case RAY_TYPE_LINE:
-		{
-			META_CONPRINTF("RAY_TYPE_LINE offset %s radius %f, ", VecToString(ray.m_Line.m_vStartOffset), ray.m_Line.m_flRadius);
-			break;
-		}
-		case RAY_TYPE_SPHERE:
-		{
-			META_CONPRINTF("RAY_TYPE_SPHERE radius %f, center %s, ", ray.m_Sphere.m_flRadius, VecToString(ray.m_Sphere.m_vCenter));
-			break;
-		}
-		case RAY_TYPE_HULL:
-		{
-			META_CONPRINTF("RAY_TYPE_HULL mins = %s, maxs = %s, ", VecToString(ray.m_Hull.m_vMins), VecToString(ray.m_Hull.m_vMaxs));
-			break;
-		}
-		case RAY_TYPE_CAPSULE:
-		{
-			META_CONPRINTF("RAY_TYPE_CAPSULE radius %f, center %s %s, ", ray.m_Capsule.m_flRadius, VecToString(ray.m_Capsule.m_vCenter[0]),
-						   VecToString(ray.m_Capsule.m_vCenter[1]));
-			break;
-		}
-		case RAY_TYPE_MESH:
-		{
-			META_CONPRINTF("RAY_TYPE_MESH mins = %s, maxs = %s, numVertice = %i, pVertices = %p, ", VecToString(ray.m_Mesh.m_vMins),
-						   VecToString(ray.m_Mesh.m_vMaxs), ray.m_Mesh.m_nNumVertices, ray.m_Mesh.m_pVertices);
-			break;
-		}
-	}
-	if (pm->DidHit())
-	{
-		META_CONPRINTF("hit %s (normal %s, triangle %i, body %p, shape %p)\n", VecToString(pm->m_vEndPos), VecToString(pm->m_vHitNormal),
-					   pm->m_nTriangle, pm->m_hBody, pm->m_hShape);
-	}
-	else
-	{
-		META_CONPRINT("missed\n");
-	}
-#endif
+	movement::tracerecorder::Record(ray, start, end, pm);
 	return ret;
 }
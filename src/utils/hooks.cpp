@@ -12,10 +12,16 @@
 #include "cs2kz.h"
 #include "ctimer.h"
 #include "kz/kz.h"
+#include "kz/anticheat/kz_anticheat.h"
+#include "kz/anticheat/strafe_analysis.h"
 #include "kz/beam/kz_beam.h"
 #include "kz/jumpstats/kz_jumpstats.h"
 #include "kz/option/kz_option.h"
+#include "kz/profiler/kz_profiler.h"
+#include "kz/watchdog/kz_watchdog.h"
 #include "kz/quiet/kz_quiet.h"
+#include "kz/racing/kz_racing.h"
+#include "kz/saveloc/kz_saveloc.h"
 #include "kz/timer/kz_timer.h"
 #include "kz/timer/announce.h"
 #include "kz/timer/queries/base_request.h"
@@ -464,7 +470,11 @@ static_function void Hook_OnChangeTeamPost(i32 team)
 static_function void Hook_CheckTransmit(CCheckTransmitInfo **pInfo, int infoCount, CBitVec<16384> &, const Entity2Networkable_t **pNetworkables,
 										const uint16 *pEntityIndicies, int nEntities, bool bEnablePVSBits)
 {
-	KZ::quiet::OnCheckTransmit(pInfo, infoCount);
+	{
+		KZ_WATCHDOG_SCOPE();
+		KZ_PROFILE(PROFILE_QUIET);
+		KZ::quiet::OnCheckTransmit(pInfo, infoCount);
+	}
 	RETURN_META(MRES_IGNORED);
 }
 
@@ -472,11 +482,24 @@ static_function void Hook_CheckTransmit(CCheckTransmitInfo **pInfo, int infoCoun
 static_function void Hook_GameFrame(bool simulating, bool bFirstTick, bool bLastTick)
 {
 	VPROF_BUDGET(__func__, "CS2KZ");
+	KZ::profiler::OnGameFrame();
+	KZ::watchdog::OnGameFrame();
+	KZ_WATCHDOG_SCOPE();
 	g_KZPlugin.serverGlobals = *(g_pKZUtils->GetGlobals());
 	RecordAnnounce::Check();
 	BaseRequest::CheckRequests();
-	KZTelemetryService::ActiveCheck();
-	KZBeamService::UpdateBeams();
+	KZRacingService::OnGameFrame();
+	KZAnticheatService::OnGameFrame();
+	KZ::strafeanalysis::OnGameFrame();
+	if (KZ::watchdog::ShouldRun(KZ::watchdog::DEGRADE_TELEMETRY, 64))
+	{
+		KZ_PROFILE(PROFILE_TELEMETRY);
+		KZTelemetryService::ActiveCheck();
+	}
+	{
+		KZ_PROFILE(PROFILE_BEAM);
+		KZBeamService::UpdateBeams();
+	}
 	RETURN_META(MRES_IGNORED);
 }
 
@@ -638,7 +661,7 @@ static_function void Hook_DispatchConCommand(ConCommandRef cmd, const CCommandCo
 	{
 		RETURN_META(result);
 	}
-	if (KZOptionService::GetOptionInt("overridePlayerChat", true))
+	if (KZOptionService::GetConfig().overridePlayerChat)
 	{
 		KZ::misc::ProcessConCommand(cmd, ctx, args);
 	}
@@ -676,6 +699,8 @@ static_function bool Hook_ActivateServer()
 	META_CONPRINTF("[KZ] Loading map %s, workshop ID %llu, size %llu, md5 %s\n", g_pKZUtils->GetCurrentMapVPK().Get(), id, size, md5);
 
 	KZJumpstatsService::OnServerActivate();
+	KZSavelocService::OnServerActivate();
+	KZRacingService::OnServerActivate();
 	RecordAnnounce::Clear();
 	KZ::misc::OnServerActivate();
 	KZDatabaseService::SetupMap();
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+	Move-only type erased callable with a small inline buffer, similar to std::function.
+
+	Callables that fit in `Capacity` bytes are stored inline, larger ones fall back to a heap allocation.
+	This makes it suitable for storage in fixed size containers that are shared between threads,
+	as the common case of a small lambda does not touch the allocator at all.
+*/
+
+template<typename Signature, size_t Capacity = 64>
+class InplaceFunction;
+
+template<typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity>
+{
+public:
+	InplaceFunction() = default;
+
+	template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InplaceFunction>>>
+	InplaceFunction(F &&f)
+	{
+		this->Emplace(std::forward<F>(f));
+	}
+
+	InplaceFunction(InplaceFunction &&other) noexcept
+	{
+		this->MoveFrom(other);
+	}
+
+	InplaceFunction &operator=(InplaceFunction &&other) noexcept
+	{
+		if (this != &other)
+		{
+			this->Reset();
+			this->MoveFrom(other);
+		}
+		return *this;
+	}
+
+	InplaceFunction(const InplaceFunction &) = delete;
+	InplaceFunction &operator=(const InplaceFunction &) = delete;
+
+	~InplaceFunction()
+	{
+		this->Reset();
+	}
+
+	explicit operator bool() const
+	{
+		return this->ops != nullptr;
+	}
+
+	R operator()(Args... args)
+	{
+		return this->ops->invoke(this->storage, std::forward<Args>(args)...);
+	}
+
+	void Reset()
+	{
+		if (this->ops)
+		{
+			this->ops->destroy(this->storage);
+			this->ops = nullptr;
+		}
+	}
+
+	// Whether a callable of type F would be stored without a heap allocation.
+	template<typename F>
+	static constexpr bool FitsInline()
+	{
+		return sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+	}
+
+private:
+	struct Ops
+	{
+		R (*invoke)(void *storage, Args &&...args);
+		// Move constructs the callable into dst and destroys the one in src.
+		void (*relocate)(void *dst, void *src);
+		void (*destroy)(void *storage);
+	};
+
+	template<typename F>
+	struct InlineOps
+	{
+		static R Invoke(void *storage, Args &&...args)
+		{
+			return (*static_cast<F *>(storage))(std::forward<Args>(args)...);
+		}
+
+		static void Relocate(void *dst, void *src)
+		{
+			new (dst) F(std::move(*static_cast<F *>(src)));
+			static_cast<F *>(src)->~F();
+		}
+
+		static void Destroy(void *storage)
+		{
+			static_cast<F *>(storage)->~F();
+		}
+
+		static constexpr Ops ops = {Invoke, Relocate, Destroy};
+	};
+
+	template<typename F>
+	struct HeapOps
+	{
+		static R Invoke(void *storage, Args &&...args)
+		{
+			return (**static_cast<F **>(storage))(std::forward<Args>(args)...);
+		}
+
+		static void Relocate(void *dst, void *src)
+		{
+			*static_cast<F **>(dst) = *static_cast<F **>(src);
+		}
+
+		static void Destroy(void *storage)
+		{
+			delete *static_cast<F **>(storage);
+		}
+
+		static constexpr Ops ops = {Invoke, Relocate, Destroy};
+	};
+
+	template<typename F>
+	void Emplace(F &&f)
+	{
+		using Fn = std::decay_t<F>;
+		if constexpr (FitsInline<Fn>())
+		{
+			new (this->storage) Fn(std::forward<F>(f));
+			this->ops = &InlineOps<Fn>::ops;
+		}
+		else
+		{
+			*reinterpret_cast<Fn **>(this->storage) = new Fn(std::forward<F>(f));
+			this->ops = &HeapOps<Fn>::ops;
+		}
+	}
+
+	void MoveFrom(InplaceFunction &other)
+	{
+		if (other.ops)
+		{
+			other.ops->relocate(this->storage, other.storage);
+			this->ops = other.ops;
+			other.ops = nullptr;
+		}
+	}
+
+	static_assert(Capacity >= sizeof(void *), "InplaceFunction needs to be able to store at least a pointer!");
+
+	alignas(std::max_align_t) unsigned char storage[Capacity];
+	const Ops *ops {};
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+#include "common.h"
+
+/*
+	Bounded lock-free multi-producer single-consumer queue.
+
+	Every cell carries a sequence number that tells producers and the consumer whether it is free or filled,
+	so producers only contend on a single atomic increment and never block each other or the consumer.
+	TryPush fails instead of blocking when the queue is full, callers are expected to have a fallback.
+	TryPop and Size must only be called from the consumer thread.
+*/
+
+template<typename T, u32 Capacity>
+class MPSCQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MPSCQueue capacity must be a power of two!");
+
+public:
+	MPSCQueue()
+	{
+		for (u32 i = 0; i < Capacity; i++)
+		{
+			this->cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MPSCQueue(const MPSCQueue &) = delete;
+	MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+	template<typename U>
+	bool TryPush(U &&value)
+	{
+		u64 pos = this->enqueuePos.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Cell &cell = this->cells[pos & (Capacity - 1)];
+			u64 sequence = cell.sequence.load(std::memory_order_acquire);
+			i64 diff = (i64)sequence - (i64)pos;
+			if (diff == 0)
+			{
+				if (this->enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					cell.data = std::forward<U>(value);
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				// The consumer hasn't freed this cell yet, queue is full.
+				return false;
+			}
+			else
+			{
+				pos = this->enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	bool TryPop(T &out)
+	{
+		Cell &cell = this->cells[this->dequeuePos & (Capacity - 1)];
+		u64 sequence = cell.sequence.load(std::memory_order_acquire);
+		if ((i64)sequence - (i64)(this->dequeuePos + 1) < 0)
+		{
+			return false;
+		}
+		out = std::move(cell.data);
+		cell.data = T();
+		cell.sequence.store(this->dequeuePos + Capacity, std::memory_order_release);
+		this->dequeuePos++;
+		return true;
+	}
+
+	// Number of elements that have been claimed by producers but not popped yet.
+	u32 Size() const
+	{
+		return (u32)(this->enqueuePos.load(std::memory_order_relaxed) - this->dequeuePos);
+	}
+
+	static constexpr u32 GetCapacity()
+	{
+		return Capacity;
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<u64> sequence;
+		T data;
+	};
+
+	Cell cells[Capacity];
+	// Keep the producer and consumer positions on separate cache lines.
+	alignas(64) std::atomic<u64> enqueuePos {};
+	alignas(64) u64 dequeuePos {};
+};
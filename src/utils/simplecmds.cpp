@@ -49,14 +49,125 @@ static_global const char *columnKeys[] = {
 
 // clang-format on
 
+// Open-addressed lookup table over g_cmdManager.cmds, keyed by the case-insensitive full command name.
+// Twice the command capacity so the load factor stays at or below 0.5.
+#define SCMD_HASH_SIZE  (SCMD_MAX_CMDS * 2)
+#define SCMD_HASH_EMPTY -1
+
 struct ScmdManager
 {
 	i32 cmdCount;
 	Scmd cmds[SCMD_MAX_CMDS];
+	i16 hashTable[SCMD_HASH_SIZE];
 };
 
 static_global ScmdManager g_cmdManager = {};
 
+static_function u32 HashCmdName(const char *name, i32 length)
+{
+	// FNV-1a over the lowercased name.
+	u32 hash = 2166136261u;
+	for (i32 i = 0; i < length; i++)
+	{
+		u8 c = (u8)name[i];
+		if (c >= 'A' && c <= 'Z')
+		{
+			c += 'a' - 'A';
+		}
+		hash ^= c;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static_function void InsertCmdHash(i32 cmdIndex)
+{
+	const Scmd &cmd = g_cmdManager.cmds[cmdIndex];
+	u32 slot = HashCmdName(cmd.name, cmd.nameLength) & (SCMD_HASH_SIZE - 1);
+	while (g_cmdManager.hashTable[slot] != SCMD_HASH_EMPTY)
+	{
+		slot = (slot + 1) & (SCMD_HASH_SIZE - 1);
+	}
+	g_cmdManager.hashTable[slot] = (i16)cmdIndex;
+}
+
+static_function void RebuildCmdHash()
+{
+	for (i32 i = 0; i < SCMD_HASH_SIZE; i++)
+	{
+		g_cmdManager.hashTable[i] = SCMD_HASH_EMPTY;
+	}
+	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	{
+		InsertCmdHash(i);
+	}
+}
+
+// Returns the index of the command with this exact (case-insensitive) name, or -1 if it doesn't exist.
+// The name does not need to be null terminated at nameLength.
+static_function i32 FindCmdIndex(const char *name, i32 nameLength)
+{
+	if (nameLength <= 0 || nameLength >= SCMD_MAX_NAME_LEN)
+	{
+		return -1;
+	}
+	if (g_cmdManager.cmdCount == 0)
+	{
+		return -1;
+	}
+	u32 slot = HashCmdName(name, nameLength) & (SCMD_HASH_SIZE - 1);
+	while (g_cmdManager.hashTable[slot] != SCMD_HASH_EMPTY)
+	{
+		const Scmd &cmd = g_cmdManager.cmds[g_cmdManager.hashTable[slot]];
+		if (cmd.nameLength == nameLength && KZ_STREQILEN(cmd.name, name, nameLength))
+		{
+			return g_cmdManager.hashTable[slot];
+		}
+		slot = (slot + 1) & (SCMD_HASH_SIZE - 1);
+	}
+	return -1;
+}
+
+static_function i32 FindCmdIndex(const char *name)
+{
+	return FindCmdIndex(name, (i32)strlen(name));
+}
+
+// Chat commands and console command overrides are matched against the name without the console prefix,
+// so "foo" matches both "foo" and "kz_foo". Returns the candidates in registration order.
+static_function i32 FindCmdIndicesByShortName(const char *shortName, i32 outIndices[2])
+{
+	i32 count = 0;
+	i32 shortLength = strlen(shortName);
+	i32 conPrefixLen = strlen(SCMD_CONSOLE_PREFIX);
+
+	// A command whose own name begins with the console prefix is only reachable through its stripped name.
+	if (shortLength < conPrefixLen || !KZ_STREQILEN(shortName, SCMD_CONSOLE_PREFIX, conPrefixLen))
+	{
+		i32 index = FindCmdIndex(shortName, shortLength);
+		if (index != -1)
+		{
+			outIndices[count++] = index;
+		}
+	}
+
+	char prefixedName[SCMD_MAX_NAME_LEN];
+	i32 prefixedLength = V_snprintf(prefixedName, sizeof(prefixedName), SCMD_CONSOLE_PREFIX "%s", shortName);
+	i32 index = FindCmdIndex(prefixedName, prefixedLength);
+	if (index != -1)
+	{
+		outIndices[count++] = index;
+	}
+
+	if (count == 2 && outIndices[0] > outIndices[1])
+	{
+		i32 temp = outIndices[0];
+		outIndices[0] = outIndices[1];
+		outIndices[1] = temp;
+	}
+	return count;
+}
+
 static_global void PrintCategoryCommands(KZPlayer *player, i32 category, bool printEmpty)
 {
 	char tableName[64];
@@ -174,22 +285,22 @@ bool scmd::RegisterCmd(const char *name, scmd::Callback_t *callback, const char
 		hasConPrefix = true;
 	}
 
-	// Check if command with this name already exists
-	Scmd *cmds = g_cmdManager.cmds;
-	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	// Names that don't fit are truncated, like they are when copied into the command below.
+	nameLength = MIN(nameLength, SCMD_MAX_NAME_LEN - 1);
+
+	// Static registration can run before the table is cleared, so make sure it is initialized.
+	if (g_cmdManager.cmdCount == 0)
 	{
-		if (nameLength != g_cmdManager.cmds[i].nameLength)
-		{
-			continue;
-		}
+		RebuildCmdHash();
+	}
 
-		if (!V_stricmp(g_cmdManager.cmds[i].name, name))
-		{
-			// TODO: print warning? error? segfault?
-			// Command already exists
-			// Assert(0);
-			return false;
-		}
+	// Check if command with this name already exists
+	if (FindCmdIndex(name, nameLength) != -1)
+	{
+		// TODO: print warning? error? segfault?
+		// Command already exists
+		// Assert(0);
+		return false;
 	}
 
 	// Command name is unique!
@@ -206,41 +317,37 @@ bool scmd::RegisterCmd(const char *name, scmd::Callback_t *callback, const char
 		V_snprintf(cmd.descKey, SCMD_MAX_NAME_LEN, "%s", descKey);
 	}
 
-	g_cmdManager.cmds[g_cmdManager.cmdCount++] = cmd;
+	g_cmdManager.cmds[g_cmdManager.cmdCount] = cmd;
+	InsertCmdHash(g_cmdManager.cmdCount);
+	g_cmdManager.cmdCount++;
 
 	return true;
 }
 
 bool scmd::LinkCmd(const char *name, const char *linkedName)
 {
-	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	i32 index = FindCmdIndex(linkedName);
+	if (index == -1)
 	{
-		if (!V_stricmp(g_cmdManager.cmds[i].name, linkedName))
-		{
-			return scmd::RegisterCmd(name, g_cmdManager.cmds[i].callback, g_cmdManager.cmds[i].descKey, g_cmdManager.cmds[i].flags);
-		}
+		return false;
 	}
-	return false;
+	// Copy the description out, RegisterCmd writes into the same array.
+	Scmd linkedCmd = g_cmdManager.cmds[index];
+	return scmd::RegisterCmd(name, linkedCmd.callback, linkedCmd.descKey, linkedCmd.flags);
 }
 
 bool scmd::UnregisterCmd(const char *name)
 {
-	i32 indexToDelete = -1;
-	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
-	{
-		if (!V_stricmp(g_cmdManager.cmds[i].name, name))
-		{
-			indexToDelete = i;
-			break;
-		}
-	}
+	i32 indexToDelete = FindCmdIndex(name);
 	if (indexToDelete != -1)
 	{
-		for (i32 i = indexToDelete; i < g_cmdManager.cmdCount; i++)
+		for (i32 i = indexToDelete; i < g_cmdManager.cmdCount - 1; i++)
 		{
 			g_cmdManager.cmds[i] = g_cmdManager.cmds[i + 1];
 		}
 		g_cmdManager.cmdCount--;
+		// Indices past the removed command have shifted, the table has to be rebuilt.
+		RebuildCmdHash();
 		return true;
 	}
 	return false;
@@ -261,24 +368,20 @@ META_RES scmd::OnClientCommand(CPlayerSlot &slot, const CCommand &args)
 		return MRES_IGNORED;
 	}
 
-	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	i32 index = FindCmdIndex(args[0]);
+	if (index == -1)
 	{
-		if (!g_cmdManager.cmds[i].callback)
-		{
-			// TODO: error?
-			Assert(g_cmdManager.cmds[i].callback);
-			continue;
-		}
+		return result;
+	}
 
-		if (!V_stricmp(g_cmdManager.cmds[i].name, args[0]))
-		{
-			result = g_cmdManager.cmds[i].callback(controller, &args);
-			if (result == MRES_SUPERCEDE)
-			{
-				return result;
-			}
-		}
+	if (!g_cmdManager.cmds[index].callback)
+	{
+		// TODO: error?
+		Assert(g_cmdManager.cmds[index].callback);
+		return result;
 	}
+
+	result = g_cmdManager.cmds[index].callback(controller, &args);
 	return result;
 }
 
@@ -324,48 +427,45 @@ META_RES scmd::OnDispatchConCommand(ConCommandRef cmd, const CCommandContext &ct
 		CCommand cmdArgs;
 		cmdArgs.Tokenize(args[1]);
 
-		for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+		const char *arg = cmdArgs[0] + 1; // skip chat trigger
+		i32 indices[2];
+		i32 matchCount = FindCmdIndicesByShortName(arg, indices);
+		for (i32 i = 0; i < matchCount; i++)
 		{
-			if (!cmds[i].callback)
+			Scmd &cmd = cmds[indices[i]];
+			if (!cmd.callback)
 			{
 				// TODO: error?
-				Assert(cmds[i].callback);
+				Assert(cmd.callback);
 				continue;
 			}
 
-			const char *arg = cmdArgs[0] + 1; // skip chat trigger
-			const char *cmdName = cmds[i].hasConsolePrefix ? cmds[i].name + strlen(SCMD_CONSOLE_PREFIX) : cmds[i].name;
-			if (!V_stricmp(arg, cmdName))
+			META_RES result = cmd.callback(controller, &cmdArgs);
+			if (args[1][0] == SCMD_CHAT_SILENT_TRIGGER || result == MRES_SUPERCEDE)
 			{
-				META_RES result = cmds[i].callback(controller, &cmdArgs);
-				if (args[1][0] == SCMD_CHAT_SILENT_TRIGGER || result == MRES_SUPERCEDE)
-				{
-					// don't send chat message
-					return MRES_SUPERCEDE;
-				}
+				// don't send chat message
+				return MRES_SUPERCEDE;
 			}
 		}
 	}
 	else // Are we overriding a console command?
 	{
-		for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+		i32 indices[2];
+		i32 matchCount = FindCmdIndicesByShortName(commandName, indices);
+		for (i32 i = 0; i < matchCount; i++)
 		{
-			Scmd *cmds = g_cmdManager.cmds;
-			if (!cmds[i].callback)
+			Scmd &cmd = g_cmdManager.cmds[indices[i]];
+			if (!cmd.callback)
 			{
 				// TODO: error?
-				Assert(cmds[i].callback);
+				Assert(cmd.callback);
 				continue;
 			}
 
-			const char *cmdName = cmds[i].hasConsolePrefix ? cmds[i].name + strlen(SCMD_CONSOLE_PREFIX) : cmds[i].name;
-			if (!V_stricmp(commandName, cmdName))
+			META_RES result = cmd.callback(controller, &args);
+			if (result == MRES_SUPERCEDE)
 			{
-				META_RES result = g_cmdManager.cmds[i].callback(controller, &args);
-				if (result == MRES_SUPERCEDE)
-				{
-					return result;
-				}
+				return result;
 			}
 		}
 	}